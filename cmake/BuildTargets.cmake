@@ -147,6 +147,8 @@ configure_file(${RDF_SOURCE_DIR}/ReadFramework.cmake.in ${CMAKE_BINARY_DIR}/Read
 # add_test(NAME TableTest COMMAND ${RDF_TEST_NAME} "--table")
 # add_test(NAME PreProcessing COMMAND ${RDF_TEST_NAME} "--pre-processing")
 # add_test(NAME SuperPixel COMMAND ${RDF_TEST_NAME} "--super-pixel")
+add_test(NAME CoreTest COMMAND ${RDF_TEST_NAME} "--core")		# synthetic data only
+add_test(NAME ModuleTest COMMAND ${RDF_TEST_NAME} "--module")	# synthetic data only
 
 #package 
 if (UNIX)
@@ -137,6 +137,8 @@ GCoptimization::GCoptimization(SiteID nSites, LabelID nLabels)
 , m_activeLabelCounts(new SiteID[m_num_labels])
 , m_stepsThisCycle(0)
 , m_stepsThisCycleTotal(0)
+, m_energyArena(0)
+, m_energyOwned(0)
 {
 	if ( nLabels <= 1 ) handleError("Number of labels must be >= 2");
 	if ( nSites <= 0 )  handleError("Number of sites must be >= 1");
@@ -166,6 +168,7 @@ GCoptimization::~GCoptimization()
 	delete [] m_labelingDataCosts;
 	delete [] m_labelCounts;
 	delete [] m_activeLabelCounts;
+	delete m_energyOwned;
 
 	if (m_datacostFnDelete) m_datacostFnDelete(m_datacostFn);
 	if (m_smoothcostFnDelete) m_smoothcostFnDelete(m_smoothcostFn);
@@ -410,7 +413,8 @@ void GCoptimization::setupSmoothCostsSwap(SiteID size, LabelID alpha_label,Label
 		for ( n = 0; n < nNum; n++ )
 		{
 			nSite = nPointer[n];
-			if ( m_lookupSiteVar[nSite] == -1 )
+			// diem: check the label (not m_lookupSiteVar) so that concurrent moves on other labels do not interfere
+			if ( m_labeling[nSite] != alpha_label && m_labeling[nSite] != beta_label )
 				addterm1_checked(e,i,sc->compute(site,nSite,alpha_label,m_labeling[nSite]),
 				                     sc->compute(site,nSite,beta_label, m_labeling[nSite]),weights[n]);
 			else if ( nSite < site )
@@ -1247,9 +1251,8 @@ bool GCoptimization::alpha_expansion(LabelID alpha_label)
 
 		// Create binary variables for each remaining site, add the data costs,
 		// and compute the smooth costs between variables.
-		EnergyT e(size+m_labelcostCount, // poor guess at number of pairwise terms needed :(
-				 m_numNeighborsTotal+(m_labelcostCount?size+m_labelcostCount : 0),
-				 handleError);
+		EnergyT& e = *resetEnergy(size+m_labelcostCount, // poor guess at number of pairwise terms needed :(
+				 m_numNeighborsTotal+(m_labelcostCount?size+m_labelcostCount : 0));
 		e.add_variable(size);
 		m_beforeExpansionEnergy = 0;
 		if ( m_setupDataCostsExpansion   ) (this->*m_setupDataCostsExpansion  )(size,alpha_label,&e,activeSites);
@@ -1278,6 +1281,43 @@ bool GCoptimization::alpha_expansion(LabelID alpha_label)
 
 //-------------------------------------------------------------------
 
+void GCoptimization::setEnergyArena(EnergyT* arena)
+{
+	m_energyArena = arena;
+}
+
+//-------------------------------------------------------------------
+
+GCoptimization::EnergyT* GCoptimization::energyArena() const
+{
+	return m_energyArena;
+}
+
+//-------------------------------------------------------------------
+
+int GCoptimization::arenaAllocations() const
+{
+	return m_energyArena ? m_energyArena->get_alloc_num() : 0;
+}
+
+//-------------------------------------------------------------------
+
+GCoptimization::EnergyT* GCoptimization::resetEnergy(SiteID numVars, SiteID numEdges)
+{
+	if ( !m_energyArena )
+	{
+		if ( !m_energyOwned )
+			m_energyOwned = new EnergyT(numVars,numEdges,handleError);
+		m_energyArena = m_energyOwned;
+	}
+
+	m_energyArena->reset();
+	m_energyArena->reserve(numVars,numEdges);
+	return m_energyArena;
+}
+
+//-------------------------------------------------------------------
+
 GCoptimization::EnergyType GCoptimization::oneExpansionIteration()
 {
 	permuteLabelTable();
@@ -1383,7 +1423,7 @@ void GCoptimization::alpha_beta_swap(LabelID alpha_label, LabelID beta_label)
 
 		// Create binary variables for each remaining site, add the data costs,
 		// and compute the smooth costs between variables.
-		EnergyT e(size,m_numNeighborsTotal,handleError);
+		EnergyT& e = *resetEnergy(size,m_numNeighborsTotal);
 		e.add_variable(size);
 		if ( m_setupDataCostsSwap   ) (this->*m_setupDataCostsSwap  )(size,alpha_label,beta_label,&e,activeSites);
 		if ( m_setupSmoothCostsSwap ) (this->*m_setupSmoothCostsSwap)(size,alpha_label,beta_label,&e,activeSites);
@@ -1410,6 +1450,77 @@ void GCoptimization::alpha_beta_swap(LabelID alpha_label, LabelID beta_label)
 }
 
 
+//---------------------------------------------------------------------------------
+
+void GCoptimization::prepare_deferred_swap()
+{
+	if ( m_labelcostsAll )
+		handleError("Label costs only implemented for alpha-expansion.");
+
+	// must not be called lazily by concurrent moves
+	finalizeNeighbors();
+}
+
+//---------------------------------------------------------------------------------
+
+void GCoptimization::alpha_beta_swap_deferred(LabelID alpha_label, LabelID beta_label, EnergyT* arena, LabelID* newLabeling)
+{
+	assert( alpha_label >= 0 && alpha_label < m_num_labels && beta_label >= 0 && beta_label < m_num_labels);
+	assert( arena && newLabeling );
+
+	// Determine the list of active sites for this swap move
+	// m_lookupSiteVar is only written for the move's own sites
+	SiteID size = 0;
+	SiteID *activeSites = new SiteID[m_num_sites];
+	try
+	{
+		for ( SiteID i = 0; i < m_num_sites; i++ )
+		{
+			if ( m_labeling[i] == alpha_label || m_labeling[i] == beta_label )
+			{
+				activeSites[size] = i;
+				m_lookupSiteVar[i] = size;
+				size++;
+			}
+		}
+		if ( size == 0 )
+		{
+			delete [] activeSites;
+			return;
+		}
+
+		EnergyT& e = *arena;
+		e.reset();
+		e.reserve(size,m_numNeighborsTotal);
+		e.add_variable(size);
+		if ( m_setupDataCostsSwap   ) (this->*m_setupDataCostsSwap  )(size,alpha_label,beta_label,&e,activeSites);
+		if ( m_setupSmoothCostsSwap ) (this->*m_setupSmoothCostsSwap)(size,alpha_label,beta_label,&e,activeSites);
+		e.minimize();
+
+		for ( SiteID i = 0; i < size; i++ )
+		{
+			newLabeling[activeSites[i]] = (e.get_var(i) == 0) ? alpha_label : beta_label;
+			m_lookupSiteVar[activeSites[i]] = -1;
+		}
+	}
+	catch (...)
+	{
+		for ( SiteID i = 0; i < size; i++ )
+			m_lookupSiteVar[activeSites[i]] = -1;
+		delete [] activeSites;
+		throw;
+	}
+	delete [] activeSites;
+}
+
+//---------------------------------------------------------------------------------
+
+void GCoptimization::setLabeling(const LabelID* labeling)
+{
+	memcpy(m_labeling, labeling, m_num_sites*sizeof(LabelID));
+	m_labelingInfoDirty = true;
+}
+
 //////////////////////////////////////////////////////////////////////////////////////////////////
 // Functions for the GCoptimizationGridGraph, derived from GCoptimization
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -211,6 +211,28 @@ public:
 	void alpha_beta_swap(LabelID alpha_label, LabelID beta_label, SiteID *alphaSites, 
 		                 SiteID alpha_size, SiteID *betaSites, SiteID beta_size);
 
+	// diem: all moves build their binary energy in one arena which is reset (not freed)
+	// between moves. If an external arena is set, it is used instead of the internal one
+	// and it is not deleted. An external arena can be shared between GCoptimization objects
+	// that run one after another (e.g. subsequent pages) - but never concurrently.
+	void     setEnergyArena(EnergyT* arena);
+	EnergyT* energyArena() const;
+
+	// diem: returns the number of heap allocations of the current energy arena
+	int arenaAllocations() const;
+
+	// Error handler that throws a GCException (e.g. for external energy arenas)
+	static void handleError(const char *message);
+
+	// diem: swap moves on label pairs that do not share a label work on disjoint sites.
+	// alpha_beta_swap_deferred() solves such a move without changing the labeling - the
+	// new labels of its sites are written to newLabeling (numSites() elements).
+	// Concurrent calls are safe if their label pairs are disjoint, each call has its own
+	// arena, the data cost functor is thread-safe and the labeling is not changed meanwhile.
+	// Call prepare_deferred_swap() before and setLabeling() after such a round of moves.
+	void prepare_deferred_swap();
+	void alpha_beta_swap_deferred(LabelID alpha_label, LabelID beta_label, EnergyT* arena, LabelID* newLabeling);
+
 	struct DataCostFunctor;      // use this class to pass a functor to setDataCost 
 	struct SmoothCostFunctor;    // use this class to pass a functor to setSmoothCost 
 
@@ -254,6 +276,7 @@ public:
 
 	// This function can be used to change the label of any site at any time      
 	void setLabel(SiteID site, LabelID label);
+	void setLabeling(const LabelID* labeling);	// diem: sets the labels of all sites
 
 	// setLabelOrder(false) sets the order to be not random; setLabelOrder(true) 
 	//	sets the order to random. By default, the labels are visited in non-random order 
@@ -321,6 +344,12 @@ protected:
 	void*   m_smoothcostFn;
 	EnergyType m_beforeExpansionEnergy;
 
+	EnergyT* m_energyArena;              // arena used for all moves (external or m_energyOwned)
+	EnergyT* m_energyOwned;              // internal arena, created with the first move
+
+	// returns the (reset) arena with room for numVars variables and numEdges pairwise terms
+	EnergyT* resetEnergy(SiteID numVars, SiteID numEdges);
+
 	SiteID *m_numNeighbors;              // holds num of neighbors for each site
 	SiteID  m_numNeighborsTotal;         // holds total num of neighbor relationships
 
@@ -474,7 +503,6 @@ protected:
 	template <typename SmoothCostT> EnergyType giveSmoothEnergyInternal();
 	template <typename Functor> static void deleteFunctor(void* f) { delete reinterpret_cast<Functor*>(f); }
 
-	static void handleError(const char *message);
 	static void checkInterrupt();
 
 private:
@@ -206,7 +206,7 @@ public:
 	   (optionally) the pointer to the function which
 	   will be called if allocation failed; the message
 	   passed to this function is "Not enough memory!" */
-	DBlock(int size, void (*err_function)(const char *) = NULL) { first = NULL; first_free = NULL; block_size = size; error_function = err_function; }
+	DBlock(int size, void (*err_function)(const char *) = NULL) { first = NULL; first_free = NULL; block_size = size; block_num = 0; error_function = err_function; }
 
 	/* Destructor. Deallocates all items added so far */
 	~DBlock() { while (first) { block *next = first -> next; delete first; first = next; } }
@@ -221,6 +221,7 @@ public:
 			block *next = first;
 			first = (block *) new char [sizeof(block) + (block_size-1)*sizeof(block_item)];
 			if (!first) { if (error_function) (*error_function)("Not enough memory!"); exit(1); }
+			block_num ++;
 			first_free = & (first -> data[0] );
 			for (item=first_free; item<first_free+block_size-1; item++)
 				item -> next_free = item + 1;
@@ -240,6 +241,26 @@ public:
 		first_free = (block_item *) t;
 	}
 
+	/* diem: returns all items to the free list without
+	   deallocating the blocks (they are reused by New()) */
+	void Reset()
+	{
+		block *b;
+		block_item *item;
+
+		first_free = NULL;
+		for (b=first; b; b=b->next)
+		{
+			for (item=&(b->data[0]); item<&(b->data[0])+block_size-1; item++)
+				item -> next_free = item + 1;
+			item -> next_free = first_free;
+			first_free = &(b->data[0]);
+		}
+	}
+
+	/* diem: returns the number of blocks allocated so far */
+	int BlockNum() const { return block_num; }
+
 /***********************************************************************/
 
 private:
@@ -257,6 +278,7 @@ private:
 	} block;
 
 	int			block_size;
+	int			block_num;
 	block		*first;
 	block_item	*first_free;
 
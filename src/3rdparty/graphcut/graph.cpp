@@ -10,6 +10,7 @@
 template <typename captype, typename tcaptype, typename flowtype> 
 	Graph<captype, tcaptype, flowtype>::Graph(int node_num_max, int edge_num_max, void (*err_function)(const char *))
 	: node_num(0),
+	  alloc_num(2),
 	  nodeptr_block(NULL),
 	  error_function(err_function)
 {
@@ -48,16 +49,46 @@ template <typename captype, typename tcaptype, typename flowtype>
 	arc_last = arcs;
 	node_num = 0;
 
+	// diem: keep the nodeptr blocks for the next maxflow
 	if (nodeptr_block) 
-	{ 
-		delete nodeptr_block; 
-		nodeptr_block = NULL; 
-	}
+		nodeptr_block->Reset();
 
 	maxflow_iteration = 0;
 	flow = 0;
 }
 
+template <typename captype, typename tcaptype, typename flowtype> 
+	void Graph<captype,tcaptype,flowtype>::reserve(int node_num_max, int edge_num_max)
+{
+	assert(node_last == nodes && arc_last == arcs);
+
+	if (node_num_max > (int)(node_max - nodes))
+	{
+		free(nodes);
+		nodes = (node*) malloc(node_num_max*sizeof(node));
+		if (!nodes) { if (error_function) (*error_function)("Not enough memory!"); exit(1); }
+		node_last = nodes;
+		node_max = nodes + node_num_max;
+		alloc_num ++;
+	}
+
+	if (2*edge_num_max > (int)(arc_max - arcs))
+	{
+		free(arcs);
+		arcs = (arc*) malloc(2*edge_num_max*sizeof(arc));
+		if (!arcs) { if (error_function) (*error_function)("Not enough memory!"); exit(1); }
+		arc_last = arcs;
+		arc_max = arcs + 2*edge_num_max;
+		alloc_num ++;
+	}
+}
+
+template <typename captype, typename tcaptype, typename flowtype> 
+	int Graph<captype,tcaptype,flowtype>::get_alloc_num() const
+{
+	return alloc_num + (nodeptr_block ? nodeptr_block->BlockNum() : 0);
+}
+
 template <typename captype, typename tcaptype, typename flowtype> 
 	void Graph<captype,tcaptype,flowtype>::reallocate_nodes(int num)
 {
@@ -68,6 +99,7 @@ template <typename captype, typename tcaptype, typename flowtype>
 	if (node_num_max < node_num + num) node_num_max = node_num + num;
 	nodes = (node*) realloc(nodes_old, node_num_max*sizeof(node));
 	if (!nodes) { if (error_function) (*error_function)("Not enough memory!"); exit(1); }
+	alloc_num ++;
 
 	node_last = nodes + node_num;
 	node_max = nodes + node_num_max;
@@ -92,6 +124,7 @@ template <typename captype, typename tcaptype, typename flowtype>
 	arc_num_max += arc_num_max / 2; if (arc_num_max & 1) arc_num_max ++;
 	arcs = (arc*) realloc(arcs_old, arc_num_max*sizeof(arc));
 	if (!arcs) { if (error_function) (*error_function)("Not enough memory!"); exit(1); }
+	alloc_num ++;
 
 	arc_last = arcs + arc_num;
 	arc_max = arcs + arc_num_max;
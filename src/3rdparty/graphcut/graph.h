@@ -142,6 +142,17 @@ public:
 	// (see functions below).
 	void reset();
 
+	// diem: makes sure that at least node_num_max nodes and edge_num_max edges
+	// fit into the graph without reallocation. Memory is only ever grown, so
+	// calling reset() + reserve() before each construction turns the graph
+	// into an arena that is allocated once and reused afterwards.
+	// Must be called on an empty graph (i.e. directly after reset()).
+	void reserve(int node_num_max, int edge_num_max);
+
+	// diem: returns the number of heap allocations done by this graph so far
+	// (node/arc arrays, their reallocations and nodeptr blocks)
+	int get_alloc_num() const;
+
 	////////////////////////////////////////////////////////////////////////////////
 	// 2. Functions for getting pointers to arcs and for reading graph structure. //
 	//    NOTE: adding new arcs may invalidate these pointers (if reallocation    //
@@ -297,6 +308,7 @@ private:
 	arc					*arcs, *arc_last, *arc_max; // arc_last = arcs+2*edge_num, arc_max = arcs+2*edge_num_max;
 
 	int					node_num;
+	int					alloc_num;			// diem: number of node/arc (re)allocations
 
 	DBlock<nodeptr>		*nodeptr_block;
 
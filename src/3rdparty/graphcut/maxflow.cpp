@@ -596,11 +596,9 @@ template <typename captype, typename tcaptype, typename flowtype>
 	}
 	// test_consistency();
 
+	// diem: all orphans are processed at this point - recycle the blocks instead of freeing them
 	if (!reuse_trees || (maxflow_iteration % 64) == 0)
-	{
-		delete nodeptr_block; 
-		nodeptr_block = NULL; 
-	}
+		nodeptr_block->Reset();
 
 	maxflow_iteration ++;
 	return flow;
@@ -26,6 +26,8 @@ No license for thw files are specified at the repository.
 #include <sstream>
 #include <iostream>
 #include <iterator>
+#include <thread>
+#include <functional>
 
 #include "Image.h"
 
@@ -205,10 +207,43 @@ public:
 		}
 	}
 
-	void train() {
+	// diem: the sentences are sharded across numThreads threads (0 = all cores).
+	// The threads update the shared embeddings without locks (Hogwild) and each
+	// thread has its own random engine and learning-rate schedule.
+	void train(int numThreads = 1) {
 		printInfo(1, "training begin...");
-		for (auto& x : sentences_) {
-			trainSentence(x);
+
+		if (numThreads <= 0) {
+			numThreads = std::max(1, (int)std::thread::hardware_concurrency());
+		}
+		numThreads = std::max(1, std::min(numThreads, (int)sentences_.size()));
+
+		uint32_t seed = uint32_t(::time(NULL));
+		std::vector<TrainState> states;
+		states.reserve(numThreads);
+		for (int t = 0; t < numThreads; ++t) {
+			states.emplace_back(seed + t, starting_alpha_, numThreads, layer1_size_, t == 0);
+		}
+
+		if (numThreads == 1) {
+			trainShard(0, sentences_.size(), states[0]);
+		}
+		else {
+			printInfo(1, "    using " + std::to_string(numThreads) + " threads...");
+			std::vector<std::thread> threads;
+			for (int t = 0; t < numThreads; ++t) {
+				size_t first = sentences_.size() * t / numThreads;
+				size_t last = sentences_.size() * (t + 1) / numThreads;
+				threads.emplace_back(&Word2Vec::trainShard, this, first, last, std::ref(states[t]));
+			}
+			for (auto& th : threads) {
+				th.join();
+			}
+		}
+
+		for (const auto& st : states) {
+			trained_words_count_ += st.trained_words_count_;
+			alpha_ = std::min(alpha_, st.alpha_);
 		}
 	}
 
@@ -350,6 +385,38 @@ private:
 	std::vector<real> exp_table_;
 	std::vector<Sentence> sentences_;
 
+	// diem: training state of one thread
+	struct TrainState
+	{
+		std::default_random_engine eng_;
+		std::uniform_int_distribution<int> distribution_; // for reduce window size & negative sampling
+		real alpha_; // learning rate of this thread
+		uint64_t trained_words_count_;
+		uint64_t last_trained_words_count_;
+		int num_shards_; // number of threads - each thread trains 1/num_shards_ of the words
+		bool report_;
+
+		// hidden layer buffers
+		Vector cbow_input_sum_neu1_;
+		Vector cbow_update_of_input_;
+		Vector skip_gram_update_of_input_;
+
+		TrainState(uint32_t seed, real alpha, int numShards, int layerSize, bool report)
+			: eng_(seed), distribution_(0), alpha_(alpha), trained_words_count_(0), last_trained_words_count_(0), num_shards_(numShards), report_(report),
+			cbow_input_sum_neu1_(layerSize, 0), cbow_update_of_input_(layerSize, 0), skip_gram_update_of_input_(layerSize, 0) {}
+	};
+
+	void trainShard(size_t first, size_t last, TrainState& state) {
+		for (size_t i = first; i < last; ++i) {
+			trainSentence(sentences_[i], state);
+		}
+	}
+
+	// read-only lookup (words_index_[] would insert missing words)
+	size_t wordIndex(const std::string& word) const {
+		return words_index_.find(word)->second;
+	}
+
 	void createHuffmanTree() {
 		printInfo(1, "    create huffman Tree...");
 		std::priority_queue<Word*, std::vector<Word*>, Word::cmp> word_heap;
@@ -449,22 +516,26 @@ private:
 		}
 	}
 
-	void trainSentence(const Sentence& sentence) {
-		// init net parmas of hidden layer
-		Vector cbow_input_sum_neu1(layer1_size_, 0);
-		Vector cbow_update_of_input(layer1_size_, 0);
-		Vector skip_gram_update_of_input(layer1_size_, 0);
-		// update learning rate
-		trained_words_count_ += sentence.size();
-		if (trained_words_count_ - last_trained_words_count_ > 10000) {
-			alpha_ = std::max(min_alpha_, real(starting_alpha_ * (1.0 - 1.0 * trained_words_count_ / total_words_count_)));
-			printInfo(2, std::to_string(trained_words_count_) + " words has been trained...");
+	void trainSentence(const Sentence& sentence, TrainState& state) {
+		// net parmas of hidden layer
+		Vector& cbow_input_sum_neu1 = state.cbow_input_sum_neu1_;
+		Vector& cbow_update_of_input = state.cbow_update_of_input_;
+		Vector& skip_gram_update_of_input = state.skip_gram_update_of_input_;
+		// update learning rate (each thread sees 1/num_shards_ of the words)
+		state.trained_words_count_ += sentence.size();
+		if (state.trained_words_count_ - state.last_trained_words_count_ > 10000) {
+			state.alpha_ = std::max(min_alpha_, real(starting_alpha_ * (1.0 - 1.0 * state.num_shards_ * state.trained_words_count_ / total_words_count_)));
+			state.last_trained_words_count_ = state.trained_words_count_;
+			if (state.report_) {
+				printInfo(2, std::to_string(state.num_shards_ * state.trained_words_count_) + " words has been trained...");
+			}
 		}
-		std::default_random_engine eng(uint32_t(::time(NULL)));
-		std::uniform_int_distribution<int> distribution(0); // for reduce window size 
+		real alpha = state.alpha_;
+		std::default_random_engine& eng = state.eng_;
+		std::uniform_int_distribution<int>& distribution = state.distribution_;
 		int sentenc_len = (int)sentence.size();
 		for (int word_pos = 0; word_pos < sentenc_len; ++word_pos) {
-			size_t curr_word_index = words_index_[sentence[word_pos]];
+			size_t curr_word_index = wordIndex(sentence[word_pos]);
 			const Word* curr_word = words_[curr_word_index];
 			//Vector& curr_word_vector = net0_[curr_word_index];
 			// window for context
@@ -480,7 +551,7 @@ private:
 					if (pos == word_pos) {
 						continue;
 					}
-					Vector& context_word = net0_[words_index_[sentence[pos]]];
+					Vector& context_word = net0_[wordIndex(sentence[pos])];
 					addVector(cbow_input_sum_neu1, context_word);
 					//std::transform(cbow_input_sum_neu1.begin(), cbow_input_sum_neu1.end(), context_word.begin(), cbow_input_sum_neu1.begin(), std::plus<real>());
 				}
@@ -497,7 +568,7 @@ private:
 							f = exp_table_[int((f + MAX_EXP) * (EXP_TABLE_SIZE / MAX_EXP / 2.0))];
 						}
 						// g is predict error by the learning rate
-						real g = (1 - curr_word->codes_[level] - f) * alpha_;
+						real g = (1 - curr_word->codes_[level] - f) * alpha;
 						// Propagate errors output -> hidden
 						updateVector(cbow_update_of_input, curr_level_predictor, g);
 						// Learn predictor weights 
@@ -532,7 +603,7 @@ private:
 							f = exp_table_[int((f + MAX_EXP) * (EXP_TABLE_SIZE / MAX_EXP / 2.0))];
 						}
 						// g is predict error by the learning rate
-						real g = (label - f) * alpha_;
+						real g = (label - f) * alpha;
 						// Propagate errors output -> hidden
 						updateVector(cbow_update_of_input, curr_negative_sample_predictor, g);
 						// Learn predictor weights 
@@ -544,7 +615,7 @@ private:
 					if (pos == word_pos) {
 						continue;
 					}
-					Vector& context_word = net0_[words_index_[sentence[pos]]];
+					Vector& context_word = net0_[wordIndex(sentence[pos])];
 					addVector(context_word, cbow_update_of_input);
 				}
 
@@ -555,7 +626,7 @@ private:
 					if (pos == word_pos) {
 						continue;
 					}
-					Vector& context_word = net0_[words_index_[sentence[pos]]];
+					Vector& context_word = net0_[wordIndex(sentence[pos])];
 					std::fill(skip_gram_update_of_input.begin(), skip_gram_update_of_input.end(), (real)0);
 					// hierarchical softmax
 					if (hs_) {
@@ -574,7 +645,7 @@ private:
 								f = exp_table_[int((f + MAX_EXP) * (EXP_TABLE_SIZE / MAX_EXP / 2.0))];
 							}
 							// g is predict error by the learning rate
-							real g = (1 - curr_word->codes_[level] - f) * alpha_;
+							real g = (1 - curr_word->codes_[level] - f) * alpha;
 							// Propagate errors output -> hidden
 							updateVector(skip_gram_update_of_input, curr_level_predictor, g);
 							// Learn predictor weights 
@@ -609,7 +680,7 @@ private:
 								f = exp_table_[int((f + MAX_EXP) * (EXP_TABLE_SIZE / MAX_EXP / 2.0))];
 							}
 							// g is predict error by the learning rate
-							real g = (label - f) * alpha_;
+							real g = (label - f) * alpha;
 							// Propagate errors output -> hidden
 							updateVector(skip_gram_update_of_input, curr_negative_sample_predictor, g);
 							// Learn predictor weights 
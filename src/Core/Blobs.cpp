@@ -385,24 +385,35 @@ QVector<Blob> BlobManager::filterMar(float maxAspectRatio, int minWidth, const B
 
 	for (const Blob& blob : blobs.blobs()) {
 
-		cv::RotatedRect rotRect = cv::minAreaRect(cv::Mat(blob.outerContour().toStdVector()));
+		if (checkMar(blob.outerContour().toStdVector(), maxAspectRatio, minWidth))
+			filtered.append(blob);
+	}
 
-	
-		float currWidth = rotRect.size.height > rotRect.size.width ? rotRect.size.height : rotRect.size.width;
-		float currRatio = 0.0f;
+	return filtered;
+}
 
-		if ((rotRect.size.width != 0) && (rotRect.size.height != 0))
-			currRatio = rotRect.size.height > rotRect.size.width ? rotRect.size.width / rotRect.size.height : rotRect.size.height / rotRect.size.width;
+/// <summary>
+/// Returns true if the minimum area rectangle of the points
+/// is at least minWidth long and its aspect ratio does not exceed maxAspectRatio.
+/// </summary>
+/// <param name="pts">The points (e.g. a blob's outer contour).</param>
+/// <param name="maxAspectRatio">The maximum aspect ratio.</param>
+/// <param name="minWidth">The minimum width.</param>
+/// <returns>true if the points pass the filter.</returns>
+bool BlobManager::checkMar(const std::vector<cv::Point>& pts, float maxAspectRatio, int minWidth) const {
 
-		//if (currWidth >= minWidth)
-		//	qDebug() << "currWidth: " << currWidth << " currRatio " << currRatio;
+	cv::RotatedRect rotRect = cv::minAreaRect(cv::Mat(pts));
 
-		if ((currWidth >= minWidth) && (currRatio <= maxAspectRatio))
-			filtered.append(blob);
+	float currWidth = rotRect.size.height > rotRect.size.width ? rotRect.size.height : rotRect.size.width;
+	float currRatio = 0.0f;
 
-	}
+	if ((rotRect.size.width != 0) && (rotRect.size.height != 0))
+		currRatio = rotRect.size.height > rotRect.size.width ? rotRect.size.width / rotRect.size.height : rotRect.size.height / rotRect.size.width;
 
-	return filtered;
+	//if (currWidth >= minWidth)
+	//	qDebug() << "currWidth: " << currWidth << " currRatio " << currRatio;
+
+	return (currWidth >= minWidth) && (currRatio <= maxAspectRatio);
 }
 
 
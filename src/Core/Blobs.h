@@ -132,6 +132,7 @@ public:
 	static BlobManager& instance();
 	QVector<Blob> filterArea(int area, const Blobs& blobs) const;
 	QVector<Blob> filterMar(float maxAspectRatio, int minWidth, const Blobs& blobs) const;
+	bool checkMar(const std::vector<cv::Point>& pts, float maxAspectRatio, int minWidth) const;
 	QVector<Blob> filterAngle(double angle, double maxAngleDiff, const Blobs& blobs) const;
 	cv::Mat drawBlobs(const Blobs& blobs, cv::Scalar color = cv::Scalar(255, 255, 255)) const;
 	QVector<Line> lines(const Blobs& blobs) const;
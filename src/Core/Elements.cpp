@@ -148,9 +148,12 @@ void Region::setPolygon(const Polygon & polygon) {
 
 /// <summary>
 /// The Region's polygon.
+/// Lazy polygons (see PageXmlParser::setLazyPolygons) are parsed
+/// into the Region's own polygon on first access.
 /// </summary>
 /// <returns></returns>
 Polygon Region::polygon() const {
+	mPoly.materialize();
 	return mPoly;
 }
 
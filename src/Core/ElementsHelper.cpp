@@ -165,9 +165,8 @@ RegionXmlHelper::RegionXmlHelper() {
 
 RegionXmlHelper& RegionXmlHelper::instance() {
 
-	static QSharedPointer<RegionXmlHelper> inst;
-	if (!inst)
-		inst = QSharedPointer<RegionXmlHelper>(new RegionXmlHelper());
+	// initialized once (thread-safe) - the page writer is used by concurrent workers
+	static QSharedPointer<RegionXmlHelper> inst(new RegionXmlHelper());
 	return *inst;
 }
 
@@ -221,9 +220,7 @@ RegionManager::RegionManager() {
 
 RegionManager& RegionManager::instance() {
 
-	static QSharedPointer<RegionManager> inst;
-	if (!inst)
-		inst = QSharedPointer<RegionManager>(new RegionManager());
+	static QSharedPointer<RegionManager> inst(new RegionManager());
 	return *inst;
 }
 
@@ -40,6 +40,7 @@
 #include <QDebug>
 #include <QBuffer>
 #include <QImageWriter>
+#include <QFile>
 #include <QFileInfo>
 #include <QPainter>
 #include <QUrl>
@@ -47,6 +48,8 @@
 
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgproc/imgproc_c.h>
+
+#include <algorithm>
 #pragma warning(pop)
 
 namespace rdf {
@@ -397,6 +400,133 @@ bool Image::writeMat(const cv::Mat & img, const QString & filePath, bool compres
 	return nb != -1;
 }
 
+/// <summary>
+/// Header of binary cv::Mat files (see writeMatBinary).
+/// The raw data follows the header.
+/// </summary>
+struct MatBinaryHeader {
+	char magic[4];
+	qint32 version;
+	qint32 rows;
+	qint32 cols;
+	qint32 type;
+	qint32 reserved[3];
+};
+
+static const char matBinaryMagic[4] = { 'R', 'D', 'F', 'M' };
+
+/// <summary>
+/// Creates the Json object for a cv::Mat which is stored in a binary file.
+/// </summary>
+/// <param name="img">The matrix.</param>
+/// <param name="fileName">Name of the binary file (see writeMatBinary).</param>
+/// <returns>The Json object referencing the binary file.</returns>
+QJsonObject Image::matToJsonBinary(const cv::Mat & img, const QString & fileName) {
+
+	QJsonObject jo = matToJsonExtern(img, fileName, false);
+	jo.insert("binary", true);
+
+	return jo;
+}
+
+/// <summary>
+/// Writes the raw data of a cv::Mat to a binary file.
+/// In contrast to writeMat, the data is neither compressed
+/// nor base64 encoded. NOTE: the data is written in the
+/// host's byte order.
+/// </summary>
+/// <param name="img">The matrix to write.</param>
+/// <param name="filePath">The file path.</param>
+/// <returns>true if the file was written.</returns>
+bool Image::writeMatBinary(const cv::Mat & img, const QString & filePath) {
+
+	if (filePath.isEmpty()) {
+		qCritical() << "cannot write mat, file path is empty...";
+		return false;
+	}
+
+	QFile file(filePath);
+	if (!file.open(QIODevice::WriteOnly)) {
+		qCritical() << "cannot open or write to" << filePath;
+		return false;
+	}
+
+	MatBinaryHeader header = {};
+	std::copy(matBinaryMagic, matBinaryMagic + 4, header.magic);
+	header.version = 1;
+	header.rows = img.rows;
+	header.cols = img.cols;
+	header.type = img.type();
+
+	cv::Mat data = img.isContinuous() ? img : img.clone();
+	qint64 numBytes = (qint64)data.total() * (qint64)data.elemSize();
+
+	bool ok = file.write((const char*)&header, sizeof(header)) == (qint64)sizeof(header);
+	
+	if (ok && numBytes > 0)
+		ok = file.write((const char*)data.data, numBytes) == numBytes;
+
+	if (!ok)
+		qCritical() << "could not write data to" << filePath;
+
+	return ok;
+}
+
+/// <summary>
+/// Returns true if type is a valid cv::Mat type.
+/// Use it to check types that are read from files.
+/// </summary>
+/// <param name="type">The cv::Mat type (e.g. CV_32FC3).</param>
+bool Image::isValidMatType(int type) {
+	return type >= 0 && (type & ~CV_MAT_TYPE_MASK) == 0 && CV_MAT_DEPTH(type) <= CV_64F;
+}
+
+/// <summary>
+/// Reads a cv::Mat from a binary file (see writeMatBinary).
+/// The data is read directly into the matrix buffer.
+/// </summary>
+/// <param name="filePath">The file path.</param>
+/// <returns>The matrix or an empty matrix if the file could not be read.</returns>
+cv::Mat Image::readMatBinary(const QString & filePath) {
+
+	QFile file(filePath);
+
+	if (!file.open(QIODevice::ReadOnly)) {
+		qCritical() << "could not read data from" << filePath;
+		return cv::Mat();
+	}
+
+	MatBinaryHeader header;
+	if (file.read((char*)&header, sizeof(header)) != (qint64)sizeof(header) ||
+		!std::equal(matBinaryMagic, matBinaryMagic + 4, header.magic) ||
+		header.version != 1) {
+		qCritical() << filePath << "is not a binary mat file";
+		return cv::Mat();
+	}
+
+	if (header.rows < 0 || header.cols < 0 || !isValidMatType(header.type)) {
+		qCritical() << "illegal mat size or type in" << filePath;
+		return cv::Mat();
+	}
+
+	// check the size before allocating (the header might be corrupt)
+	qint64 numBytes = (qint64)header.rows * (qint64)header.cols * (qint64)CV_ELEM_SIZE(header.type);
+
+	if (file.size() - file.pos() != numBytes) {
+		qCritical() << "illegal buffer length when reading cv::Mat from" << filePath;
+		return cv::Mat();
+	}
+
+	cv::Mat img(header.rows, header.cols, header.type);
+
+	if (numBytes > 0 && file.read((char*)img.data, numBytes) != numBytes) {
+		qCritical() << "could not read cv::Mat data from" << filePath;
+		return cv::Mat();
+	}
+
+	return img;
+}
+
 cv::Mat Image::jsonToMat(const QJsonObject & jo, const QString& filePath) {
 
 	int rows = jo.value("rows").toInt(-1);
@@ -412,6 +542,19 @@ cv::Mat Image::jsonToMat(const QJsonObject & jo, const QString& filePath) {
 	QByteArray ba;
 	QString fileName = jo.value("fileName").toString("");
 
+	// raw binary file - no decoding needed
+	if (!fileName.isEmpty() && jo.value("binary").toBool(false)) {
+
+		cv::Mat img = readMatBinary(QFileInfo(filePath, fileName).absoluteFilePath());
+
+		if (!img.empty() && (img.rows != rows || img.cols != cols || img.type() != type)) {
+			qCritical() << "binary cv::Mat does not match its Json description";
+			return cv::Mat();
+		}
+
+		return img;
+	}
+
 	// is the data embedded? (NOTE: only up to 40 MB)
 	if (fileName.isEmpty()) {
 		// decode data
@@ -144,6 +144,11 @@ namespace Image {
 	DllCoreExport QJsonObject matToJsonExtern(const cv::Mat& img, const QString& fileName, bool compress = true);
 	DllCoreExport bool writeMat(const cv::Mat& img, const QString& filePath, bool compress = true);
 
+	DllCoreExport QJsonObject matToJsonBinary(const cv::Mat& img, const QString& fileName);
+	DllCoreExport bool writeMatBinary(const cv::Mat& img, const QString& filePath);
+	DllCoreExport cv::Mat readMatBinary(const QString& filePath);
+	DllCoreExport bool isValidMatType(int type);
+
 
 	/// <summary>
 	/// Prints the values of a cv::Mat to copy it to Matlab.
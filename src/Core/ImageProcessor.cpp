@@ -33,12 +33,17 @@
 #include "ImageProcessor.h"
 #include "Algorithms.h"
 #include "Image.h"
+#include "Utils.h"
 
 #include "Blobs.h"	// needed for estimate mask
+#include "RunLengthImage.h"
 
 #pragma warning(push, 0)	// no warnings from includes
 #include <QColor>
 #include <QDebug>
+
+#include <algorithm>
+#include <cstring>
 #pragma warning(pop)
 
 namespace cv {
@@ -139,21 +144,97 @@ void IP::draw(const std::vector<cv::Point>& pts, cv::Mat & img, unsigned char va
 	}
 }
 
+/// <summary>
+/// Fills a polygon using a scanline rasterizer (nonzero winding rule).
+/// A pixel is filled if its center lies inside the polygon.
+/// The winding rule matches Polygon::contains and Qt::WindingFill,
+/// so self-intersecting polygons are filled as by QPainter.
+/// Only rows [rowStart rowEnd) are written, so that disjoint
+/// bands of an image can be rasterized concurrently.
+/// </summary>
+/// <param name="poly">The polygon in pixel coordinates.</param>
+/// <param name="img">The image CV_8UC1, CV_16UC1 or CV_32SC1.</param>
+/// <param name="val">The fill value.</param>
+/// <param name="rowStart">The first row.</param>
+/// <param name="rowEnd">The row after the last row (-1 = all rows).</param>
+void IP::fillPolygon(const QPolygonF & poly, cv::Mat & img, int val, int rowStart, int rowEnd) {
+
+	assert(img.type() == CV_8UC1 || img.type() == CV_16UC1 || img.type() == CV_32SC1);
+
+	if (rowEnd < 0 || rowEnd > img.rows)
+		rowEnd = img.rows;
+
+	QRectF br = poly.boundingRect();
+	int y0 = qMax(qMax(rowStart, 0), cvCeil(br.top() - 0.5));
+	int y1 = qMin(rowEnd, cvCeil(br.bottom() - 0.5));
+
+	if (poly.size() < 3 || y0 >= y1)
+		return;
+
+	int n = poly.size();
+	std::vector<std::pair<double, int> > xs;	// intersection, edge direction
+
+	for (int y = y0; y < y1; y++) {
+
+		double sy = y + 0.5;
+		xs.clear();
+
+		// intersect all edges with the scanline (half-open -> vertices are counted once)
+		for (int idx = 0; idx < n; idx++) {
+
+			const QPointF& a = poly[idx];
+			const QPointF& b = poly[(idx + 1) % n];
+
+			if ((a.y() <= sy) != (b.y() <= sy)) {
+				double x = a.x() + (sy - a.y()) * (b.x() - a.x()) / (b.y() - a.y());
+				xs.push_back(std::make_pair(x, a.y() < b.y() ? 1 : -1));
+			}
+		}
+
+		std::sort(xs.begin(), xs.end());
+
+		// fill the spans with a nonzero winding number
+		int winding = 0;
+		for (size_t idx = 0; idx + 1 < xs.size(); idx++) {
+
+			winding += xs[idx].second;
+
+			if (winding == 0)
+				continue;
+
+			int xb = qMax(0, cvCeil(xs[idx].first - 0.5));
+			int xe = qMin(img.cols, cvCeil(xs[idx + 1].first - 0.5));
+
+			if (xb >= xe)
+				continue;
+
+			switch (img.depth()) {
+			case CV_8U:		std::fill(img.ptr<unsigned char>(y) + xb, img.ptr<unsigned char>(y) + xe, cv::saturate_cast<unsigned char>(val));	break;
+			case CV_16U:	std::fill(img.ptr<unsigned short>(y) + xb, img.ptr<unsigned short>(y) + xe, cv::saturate_cast<unsigned short>(val));	break;
+			default:		std::fill(img.ptr<int>(y) + xb, img.ptr<int>(y) + xe, val);	break;
+			}
+		}
+	}
+}
+
 /// <summary>
 /// Computes robust statistical moments of an image.
 /// The quantiles of an image (or median) are computed.
+/// The quantile is exact: CV_8UC1 images are processed using a histogram,
+/// CV_32FC1 images with a radix selection (see selectRank).
+/// No samples are stored or sorted.
 /// </summary>
-/// <param name="src">The source image CV_32FC1.</param>
+/// <param name="src">The source image CV_32FC1 or CV_8UC1.</param>
 /// <param name="mask">The mask CV_32FC1 or CV_8UC1.</param>
 /// <param name="momentValue">The moment (e.g. 0.5 for median, 0.25 or 0.75 for quartiles).</param>
-/// <param name="maxSamples">The maximum number of samples (speed up).</param>
+/// <param name="maxSamples">Not used anymore - all pixels are considered.</param>
 /// <param name="area">The mask's area (speed up).</param>
 /// <returns>The statistical moment.</returns>
-double IP::statMomentMat(const cv::Mat& src, const cv::Mat& mask, double momentValue, int maxSamples, int area) {
+double IP::statMomentMat(const cv::Mat& src, const cv::Mat& mask, double momentValue, int, int area) {
 
 	// check input
-	if (src.type() != CV_32FC1) {
-		qWarning() << "Mat must be CV_32FC1";
+	if (src.type() != CV_32FC1 && src.type() != CV_8UC1) {
+		qWarning() << "Mat must be CV_32FC1 or CV_8UC1";
 		return -1;
 	}
 
@@ -169,87 +250,219 @@ double IP::statMomentMat(const cv::Mat& src, const cv::Mat& mask, double momentV
 		}
 	}
 
-	// init output list
-	QList<float> samples = QList<float>();
-
-	// assign the step size
-	if (mask.empty()) {
-		int step = cvRound((src.cols*src.rows) / (float)maxSamples);
-		if (step <= 0) step = 1;
+	if (src.depth() == CV_8U) {
 
-		for (int rIdx = 0; rIdx < src.rows; rIdx += step) {
+		int hist[256] = { 0 };
+		int n = 0;
 
-			const float* srcPtr = src.ptr<float>(rIdx);
+		forEachMasked<unsigned char>(src, mask, [&](const unsigned char* v) {
+			hist[*v]++;
+			n++;
+		});
 
-			for (int cIdx = 0; cIdx < src.cols; cIdx += step) {
-				samples.push_back(srcPtr[cIdx]);
-			}
-		}
+		return histMoment(hist, 256, n, momentValue);
 	}
-	else {
-
-		if (area == -1)
-			area = countNonZero(mask);
 
-		int step = cvRound((float)area / (float)maxSamples);
-		int cStep = 0;
+	if (mask.empty())
+		area = src.rows * src.cols;
+	else if (area == -1)
+		area = countNonZero(mask);
 
-		const void *maskPtr;
-
-		if (step <= 0) step = 1;
+	if (area <= 0)
+		return -1;
 
-		for (int rIdx = 0; rIdx < src.rows; rIdx++) {
+	int rank = momentRank(area, momentValue);
 
-			const float* srcPtr = src.ptr<float>(rIdx);
-			if (mask.depth() == CV_32F)
-				maskPtr = mask.ptr<float>(rIdx);
-			else
-				maskPtr = mask.ptr<uchar>(rIdx);
-			//maskPtr = (mask.depth() == CV_32F) ? mask.ptr<float>(rIdx) : maskPtr = mask.ptr<uchar>(rIdx);
-
-			for (int cIdx = 0; cIdx < src.cols; cIdx++) {
-
-				// skip mask pixel
-				if ((mask.depth() == CV_32FC1 && ((float*)maskPtr)[cIdx] != 0.0f) ||
-					(mask.depth() == CV_8U && ((uchar*)maskPtr)[cIdx] != 0)) {
-
-					if (cStep >= step) {
-						samples.push_back(srcPtr[cIdx]);
-						cStep = 0;
-					}
-					else
-						cStep++;
-				}
-			}
-		}
+	// compute mean between this and the next element
+	if (area % 2 == 0 && rank < area) {
+		float next = 0;
+		double moment = selectRank(src, mask, rank, &next);
+		return (moment + next) * 0.5;
 	}
 
-	return Algorithms::statMoment(samples, momentValue);
+	return selectRank(src, mask, rank);
 }
 
+/// <summary>
+/// Computes the quantiles of a color image's channels.
+/// Note: channel 0 is assigned to red.
+/// </summary>
+/// <param name="src">The source image CV_8UC3 or CV_8UC4.</param>
+/// <param name="mask">The mask CV_32FC1 or CV_8UC1.</param>
+/// <param name="momentValue">The moment (e.g. 0.5 for median, 0.25 or 0.75 for quartiles).</param>
+/// <returns>The color containing each channel's statistical moment.</returns>
 QColor IP::statMomentColor(const cv::Mat & src, const cv::Mat& mask, double momentValue) {
 
 	assert(src.type() == CV_8UC3 || src.type() == CV_8UC4);
+	assert(mask.empty() || src.size() == mask.size());
 
-	cv::Mat srcF;
-	src.convertTo(srcF, CV_32F);
-
-	std::vector<cv::Mat> channels;
-	cv::split(srcF, channels);
+	int cn = src.channels();
+	int hist[4][256] = { { 0 } };
+	int n = 0;
 
-	assert(channels.size() == 3 || channels.size() == 4);
+	forEachMasked<unsigned char>(src, mask, [&](const unsigned char* px) {
+		for (int c = 0; c < cn; c++)
+			hist[c][px[c]]++;
+		n++;
+	});
 
 	QColor col;
-	col.setRed(qRound(statMomentMat(channels[0], mask, momentValue)));
-	col.setGreen(qRound(statMomentMat(channels[1], mask, momentValue)));
-	col.setBlue(qRound(statMomentMat(channels[2], mask, momentValue)));
+	col.setRed(qRound(histMoment(hist[0], 256, n, momentValue)));
+	col.setGreen(qRound(histMoment(hist[1], 256, n, momentValue)));
+	col.setBlue(qRound(histMoment(hist[2], 256, n, momentValue)));
 
-	if (channels.size() == 4)
-		col.setAlpha(qRound(statMomentMat(channels[3], mask, momentValue)));
+	if (cn == 4)
+		col.setAlpha(qRound(histMoment(hist[3], 256, n, momentValue)));
 
 	return col;
 }
 
+/// <summary>
+/// Returns the (1-based) rank of a statistical moment.
+/// </summary>
+int IP::momentRank(int numValues, double momentValue) {
+	return qBound(1, cvCeil(numValues * momentValue), numValues);
+}
+
+/// <summary>
+/// Computes a statistical moment from a histogram with unit bins.
+/// The same conventions as in Algorithms::statMoment are used.
+/// </summary>
+/// <param name="hist">The histogram.</param>
+/// <param name="numBins">The number of bins.</param>
+/// <param name="numValues">The histogram's sum.</param>
+/// <param name="momentValue">The moment (e.g. 0.5 for median).</param>
+/// <returns>The statistical moment or -1 if the histogram is empty.</returns>
+double IP::histMoment(const int* hist, int numBins, int numValues, double momentValue) {
+
+	if (numValues <= 0)
+		return -1;
+
+	int rank = momentRank(numValues, momentValue);
+
+	// compute mean between this and the next element
+	int nextRank = (numValues % 2 == 0 && rank < numValues) ? rank + 1 : rank;
+
+	int cnt = 0;
+	int bIdx = 0;
+	for (; bIdx < numBins - 1; bIdx++) {
+
+		cnt += hist[bIdx];
+		if (cnt >= rank)
+			break;
+	}
+
+	if (cnt >= nextRank)
+		return bIdx;
+
+	int nIdx = bIdx + 1;
+	while (nIdx < numBins - 1 && hist[nIdx] == 0)
+		nIdx++;
+
+	return (bIdx + nIdx) * 0.5;
+}
+
+/// <summary>
+/// Maps a float to an unsigned key with the same order.
+/// </summary>
+quint32 IP::floatKey(float val) {
+
+	quint32 bits;
+	std::memcpy(&bits, &val, sizeof(bits));
+
+	// negative values: flip all bits, positive values: flip the sign
+	return (bits & 0x80000000u) ? ~bits : bits | 0x80000000u;
+}
+
+/// <summary>
+/// Maps a key (see floatKey) back to its float.
+/// </summary>
+float IP::keyFloat(quint32 key) {
+
+	quint32 bits = (key & 0x80000000u) ? key & 0x7fffffffu : ~key;
+
+	float val;
+	std::memcpy(&val, &bits, sizeof(val));
+
+	return val;
+}
+
+/// <summary>
+/// Returns the value with a given rank (radix selection).
+/// The floats are mapped to ordered 32 bit keys. Each pass
+/// histograms the next 11 bits of all keys that share the
+/// prefix found so far. Hence, three passes over the image
+/// find the exact value. Only stack histograms are used.
+/// </summary>
+/// <param name="src">The source image CV_32FC1.</param>
+/// <param name="mask">The mask CV_32FC1 or CV_8UC1.</param>
+/// <param name="rank">The (1-based) rank, it must not exceed the mask's area.</param>
+/// <param name="next">If not null, it is set to the value with rank + 1.</param>
+/// <returns>The value with the given rank.</returns>
+float IP::selectRank(const cv::Mat & src, const cv::Mat & mask, int rank, float* next) {
+
+	const int numBins = 2048;
+	const int shifts[] = { 21, 10, 0 };
+
+	quint32 prefix = 0;
+	quint32 prefixMask = 0;
+	int nextBin = -1;		// bin of rank + 1 in the last pass (-1 if it is not in the bucket)
+
+	for (int shift : shifts) {
+
+		int hist[numBins] = { 0 };
+		quint32 binMask = (shift == 0) ? 0x3ffu : 0x7ffu;
+
+		forEachMasked<float>(src, mask, [&](const float* v) {
+			quint32 key = floatKey(*v);
+			if ((key & prefixMask) == prefix)
+				hist[(key >> shift) & binMask]++;
+		});
+
+		int bIdx = 0;
+		for (; bIdx < (int)binMask; bIdx++) {
+
+			if (hist[bIdx] >= rank)
+				break;
+			rank -= hist[bIdx];
+		}
+
+		prefix |= (quint32)bIdx << shift;
+		prefixMask |= binMask << shift;
+
+		if (shift == 0 && next) {
+
+			nextBin = (hist[bIdx] > rank) ? bIdx : -1;
+
+			for (int nIdx = bIdx + 1; nextBin == -1 && nIdx <= (int)binMask; nIdx++) {
+				if (hist[nIdx] > 0)
+					nextBin = nIdx;
+			}
+		}
+	}
+
+	if (next) {
+
+		if (nextBin != -1) {
+			*next = keyFloat((prefix & ~0x3ffu) | (quint32)nextBin);
+		}
+		else {
+			// the next value is in another bucket - find the smallest key above
+			quint32 nKey = 0xffffffffu;
+
+			forEachMasked<float>(src, mask, [&](const float* v) {
+				quint32 key = floatKey(*v);
+				if (key > prefix && key < nKey)
+					nKey = key;
+			});
+
+			*next = keyFloat(nKey);
+		}
+	}
+
+	return keyFloat(prefix);
+}
+
 void IP::normalize(cv::Mat & src) {
 
 	double maxV, minV;
@@ -269,12 +482,80 @@ void IP::normalize(cv::Mat & src) {
 
 QVector<Polygon> IP::maskToPoly(const cv::Mat & src, double scale) {
 	
+	cv::Mat img = src.clone();	// find contours changes the src
+	return contoursToPoly(img, scale);
+}
+
+/// <summary>
+/// Returns the outer contours of all labels.
+/// The label image is scanned once to find each label's bounding box.
+/// Contours are then traced (in parallel) within these boxes only.
+/// Hence, small labels do not need full image passes.
+/// </summary>
+/// <param name="labels">The CV_8UC1 label image.</param>
+/// <param name="numLabels">The number of labels (label values must be &lt; numLabels).</param>
+/// <param name="scale">The polygons' scale factor.</param>
+/// <returns>The polygons of each label (indexed by the label value).</returns>
+QVector<QVector<Polygon> > IP::labelsToPoly(const cv::Mat & labels, int numLabels, double scale) {
+
+	assert(labels.type() == CV_8UC1);
+
+	QVector<QVector<Polygon> > polys(numLabels);
+
+	// find the bounding box of each label
+	QVector<cv::Point> tl(numLabels, cv::Point(labels.cols, labels.rows));
+	QVector<cv::Point> br(numLabels, cv::Point(-1, -1));
+
+	for (int rIdx = 0; rIdx < labels.rows; rIdx++) {
+
+		const unsigned char* lPtr = labels.ptr<unsigned char>(rIdx);
+
+		for (int cIdx = 0; cIdx < labels.cols; cIdx++) {
+
+			int l = lPtr[cIdx];
+			if (l >= numLabels)
+				continue;
+
+			cv::Point& ltl = tl[l];
+			cv::Point& lbr = br[l];
+
+			if (cIdx < ltl.x) ltl.x = cIdx;
+			if (cIdx > lbr.x) lbr.x = cIdx;
+			if (rIdx < ltl.y) ltl.y = rIdx;
+			lbr.y = rIdx;	// rows are increasing
+		}
+	}
+
+	Utils::parallelFor(numLabels, [&](int l) {
+
+		// label does not exist
+		if (br[l].x < 0)
+			return;
+
+		// add 1px border - findContours ignores the image border
+		cv::Rect box(tl[l] - cv::Point(1, 1), br[l] + cv::Point(2, 2));
+		box &= cv::Rect(0, 0, labels.cols, labels.rows);
+		cv::Mat mask = labels(box) == l;
+
+		polys[l] = contoursToPoly(mask, scale, box.tl());
+	});
+
+	return polys;
+}
+
+/// <summary>
+/// Converts the outer contours of a mask to polygons.
+/// </summary>
+/// <param name="mask">The CV_8UC1 mask (it is changed).</param>
+/// <param name="scale">The polygons' scale factor.</param>
+/// <param name="offset">The offset added to all contour points.</param>
+/// <returns>The outer contours.</returns>
+QVector<Polygon> IP::contoursToPoly(cv::Mat & mask, double scale, const cv::Point & offset) {
 
 	std::vector<cv::Vec4i> hierarchy;
 	std::vector<std::vector<cv::Point> > contours;
 	
-	cv::Mat img = src.clone();	// find contours changes the src
-	cv::findContours(img, contours, hierarchy, CV_RETR_CCOMP, CV_CHAIN_APPROX_SIMPLE);
+	cv::findContours(mask, contours, hierarchy, CV_RETR_CCOMP, CV_CHAIN_APPROX_SIMPLE, offset);
 	
 	// convert to Qt
 	QVector<Polygon> polys;
@@ -725,6 +1006,9 @@ void IP::mulMask(cv::Mat& src, cv::Mat mask) {
 /// <summary>
 /// Prefilters an binary image according to the blob size.
 /// Should be done to remove small blobs and to reduce the runtime of cvFindContours.
+/// Blobs are labeled by a union-find on the image's runs. Hence,
+/// the auxiliary memory is linear in the number of runs (rather than pixels).
+/// Border pixels are neither filtered nor connect blobs.
 /// </summary>
 /// <param name="img">The source img CV_8UC1.</param>
 /// <param name="minArea">The blob size threshold in pixel.</param>
@@ -732,95 +1016,20 @@ void IP::mulMask(cv::Mat& src, cv::Mat mask) {
 /// <returns>A CV_8UC1 binary image with all blobs smaller than minArea removed.</returns>
 cv::Mat IP::preFilterArea(const cv::Mat& img, int minArea, int maxArea) {
 
-	cv::Mat bwImgTmp = img.clone();
 	cv::Mat filteredImage = img.clone();
 
-	setBorderConst(bwImgTmp);
-	int w = bwImgTmp.cols;
-	int h = bwImgTmp.rows;
-	unsigned char *si = bwImgTmp.data + w + 1;
-	unsigned char *sie = si + w * h - 2 * w - 2;
-
-	unsigned char **ppFGList = new unsigned char*[w * h];	// w*h/4 -> bug when images have large blobs [6.10.2011 markus]
-	int fgListPos;
-	int cur_fgListPos;
-	unsigned char *pCurImgPos;
-
-#define _PUSH_FG_LIST(a) (ppFGList[fgListPos++] = (a))
-#define _PUSH_FG_LIST_CLR(a) (ppFGList[fgListPos++] = (*a = 0, a))
-#define _POP_FG_LIST (ppFGList[cur_fgListPos++])
-
-	while (si < sie) {
-		if (*si) {
-			fgListPos = 0;
-			cur_fgListPos = 0;
-			_PUSH_FG_LIST_CLR(si);
-
-			// 3 2 1
-			// 4 X 8
-			// 5 6 7
-
-			while (cur_fgListPos < fgListPos) {
-				pCurImgPos = _POP_FG_LIST - 1 - w;
-
-				if (*pCurImgPos)
-					// 3
-					_PUSH_FG_LIST_CLR(pCurImgPos);
-
-				pCurImgPos++;
-				if (*pCurImgPos)
-					// 2
-					_PUSH_FG_LIST_CLR(pCurImgPos);
-
-				pCurImgPos++;
-				if (*pCurImgPos)
-					// 1
-					_PUSH_FG_LIST_CLR(pCurImgPos);
-
-				pCurImgPos += w;
-				if (*pCurImgPos)
-					// 8
-					_PUSH_FG_LIST_CLR(pCurImgPos);
-
-				pCurImgPos -= 2;
-				if (*pCurImgPos)
-					// 4
-					_PUSH_FG_LIST_CLR(pCurImgPos);
-
-				pCurImgPos += w;
-				if (*pCurImgPos)
-					// 5
-					_PUSH_FG_LIST_CLR(pCurImgPos);
-
-				pCurImgPos++;
-				if (*pCurImgPos)
-					// 6
-					_PUSH_FG_LIST_CLR(pCurImgPos);
-
-				pCurImgPos++;
-				if (*pCurImgPos)
-					// 7
-					_PUSH_FG_LIST_CLR(pCurImgPos);
-			}
-
-			if (fgListPos <= minArea || (maxArea != -1 && fgListPos >= maxArea)) {
-				cur_fgListPos = 0;
-
-				while (cur_fgListPos < fgListPos) {
-					pCurImgPos = _POP_FG_LIST;
+	if (img.rows <= 2 || img.cols <= 2)
+		return filteredImage;
 
-					*(filteredImage.data + ((size_t)pCurImgPos - (size_t)bwImgTmp.data)) = 0;
-				}
-			}
-		}
+	cv::Rect interior(1, 1, img.cols - 2, img.rows - 2);
 
-		si++;
-	}
+	RunLengthImage removed;
+	RunLengthImage::fromMat(img(interior)).filterArea(minArea, maxArea, &removed);
 
-	delete[] ppFGList;
+	cv::Mat fi = filteredImage(interior);
+	removed.draw(fi, cv::Scalar(0));
 
 	return filteredImage;
-
 }
 
 /// <summary>
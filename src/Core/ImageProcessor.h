@@ -34,6 +34,7 @@
 
 #pragma warning(push, 0)	// no warnings from includes
 #include <QObject>
+#include <QPolygonF>
 #include <opencv2/core.hpp>
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgproc/imgproc_c.h>
@@ -92,6 +93,7 @@ public:
 
 	static cv::Mat computeHist(const cv::Mat& data, int width, int numElements = -1, double* maxBin = 0);
 	static void draw(const std::vector<cv::Point>& pts, cv::Mat& img, unsigned char val = 255);
+	static void fillPolygon(const QPolygonF& poly, cv::Mat& img, int val, int rowStart = 0, int rowEnd = -1);
 	
 	static double statMomentMat(const cv::Mat& src, const cv::Mat& mask = cv::Mat(), double momentValue = 0.5, int maxSamples = 10000, int area = -1);
 	static QColor statMomentColor(const cv::Mat& src, const cv::Mat& mask = cv::Mat(), double momentValue = 0.5);
@@ -99,8 +101,47 @@ public:
 	static void normalize(cv::Mat& src);
 
 	static QVector<Polygon> maskToPoly(const cv::Mat& src, double scale);
+	static QVector<QVector<Polygon> > labelsToPoly(const cv::Mat& labels, int numLabels, double scale);
 
 private:
+	static QVector<Polygon> contoursToPoly(cv::Mat& mask, double scale, const cv::Point& offset = cv::Point());
+
+	static int momentRank(int numValues, double momentValue);
+	static double histMoment(const int* hist, int numBins, int numValues, double momentValue);
+	static quint32 floatKey(float val);
+	static float keyFloat(quint32 key);
+	static float selectRank(const cv::Mat& src, const cv::Mat& mask, int rank, float* next = 0);
+
+	/// <summary>
+	/// Calls fnc for all pixels where the mask is not zero.
+	/// fnc gets a pointer to the pixel's first channel.
+	/// </summary>
+	template<typename sFmt, typename Fnc>
+	static void forEachMasked(const cv::Mat& src, const cv::Mat& mask, Fnc fnc) {
+
+		int cn = src.channels();
+
+		for (int rIdx = 0; rIdx < src.rows; rIdx++) {
+
+			const sFmt* srcPtr = src.ptr<sFmt>(rIdx);
+
+			if (mask.empty()) {
+				for (int cIdx = 0; cIdx < src.cols; cIdx++)
+					fnc(srcPtr + cIdx * cn);
+			}
+			else if (mask.depth() == CV_32F) {
+				const float* mPtr = mask.ptr<float>(rIdx);
+				for (int cIdx = 0; cIdx < src.cols; cIdx++)
+					if (mPtr[cIdx] != 0.0f) fnc(srcPtr + cIdx * cn);
+			}
+			else {
+				const unsigned char* mPtr = mask.ptr<unsigned char>(rIdx);
+				for (int cIdx = 0; cIdx < src.cols; cIdx++)
+					if (mPtr[cIdx] != 0) fnc(srcPtr + cIdx * cn);
+			}
+		}
+	}
+
 	template<typename sFmt, typename mFmt>
 	static void mulMaskIntern(cv::Mat src, const cv::Mat mask) {
 
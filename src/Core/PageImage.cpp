@@ -0,0 +1,112 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#include "PageImage.h"
+#include "ImageProcessor.h"
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QMutexLocker>
+#include <opencv2/imgproc.hpp>
+#pragma warning(pop)
+
+namespace rdf {
+
+// PageImage --------------------------------------------------------------------
+PageImage::PageImage(const cv::Mat& img) : mImg(img) {
+}
+
+bool PageImage::isEmpty() const {
+	return mImg.empty();
+}
+
+/// <summary>
+/// Returns the page image.
+/// </summary>
+cv::Mat PageImage::image() const {
+	return mImg;
+}
+
+/// <summary>
+/// Returns the grayscale page (see IP::grayscale).
+/// </summary>
+/// <returns>A CV_8UC1 image.</returns>
+cv::Mat PageImage::grayscale() const {
+
+	QMutexLocker l(&mMutex);
+
+	if (mGray.empty() && !mImg.empty())
+		mGray = IP::grayscale(mImg);
+
+	return mGray;
+}
+
+/// <summary>
+/// Returns the grayscale page normalized to [0 255].
+/// </summary>
+/// <returns>A CV_8UC1 image.</returns>
+cv::Mat PageImage::normalized() const {
+	return pyramidLevel(0);
+}
+
+/// <summary>
+/// Returns a pyramid level of the normalized page.
+/// Each level halves the previous level's size (area interpolation).
+/// </summary>
+/// <param name="level">The pyramid level (0 is the normalized page).</param>
+/// <returns>A CV_8UC1 image.</returns>
+cv::Mat PageImage::pyramidLevel(int level) const {
+
+	assert(level >= 0);
+
+	cv::Mat gray = grayscale();
+
+	QMutexLocker l(&mMutex);
+
+	if (gray.empty())
+		return cv::Mat();
+
+	if (mPyramid.isEmpty()) {
+		cv::Mat img;
+		cv::normalize(gray, img, 255, 0, cv::NORM_MINMAX);
+		mPyramid << img;
+	}
+
+	while (mPyramid.size() <= level) {
+		cv::Mat img;
+		cv::resize(mPyramid.last(), img, cv::Size(), 0.5, 0.5, cv::INTER_AREA);
+		mPyramid << img;
+	}
+
+	return mPyramid[level];
+}
+
+}
@@ -0,0 +1,82 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QMutex>
+#include <QVector>
+#include <opencv2/core.hpp>
+#pragma warning(pop)
+
+#ifndef DllCoreExport
+#ifdef DLL_CORE_EXPORT
+#define DllCoreExport Q_DECL_EXPORT
+#else
+#define DllCoreExport Q_DECL_IMPORT
+#endif
+#endif
+
+#pragma warning(disable: 4251)
+
+namespace rdf {
+
+/// <summary>
+/// Per-page image context.
+/// Conversions of the page image (grayscale, normalized, pyramid levels)
+/// are computed lazily, once, and shared by all modules that get the context.
+/// The returned images are shared - do not modify them (clone if needed).
+/// All functions are thread-safe.
+/// </summary>
+class DllCoreExport PageImage {
+
+public:
+	PageImage(const cv::Mat& img = cv::Mat());
+
+	bool isEmpty() const;
+
+	cv::Mat image() const;
+	cv::Mat grayscale() const;
+	cv::Mat normalized() const;
+	cv::Mat pyramidLevel(int level) const;
+
+private:
+	cv::Mat mImg;
+
+	mutable QMutex mMutex;
+	mutable cv::Mat mGray;
+	mutable QVector<cv::Mat> mPyramid;	// [0] is the normalized image
+
+	Q_DISABLE_COPY(PageImage)
+};
+
+}
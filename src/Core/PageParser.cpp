@@ -52,9 +52,19 @@ PageXmlParser::PageXmlParser() {
 
 }
 
+/// <summary>
+/// Reads a PAGE XML from a local file or an URL.
+/// Local files are parsed directly from the file device
+/// (i.e. the file is not loaded to memory before parsing).
+/// Use setTypeFilter and setLazyPolygons to speed-up
+/// reading if only a few region types are needed.
+/// </summary>
+/// <param name="xmlPath">The XML path or URL.</param>
+/// <param name="ignoreLayers">If true, layers are not parsed.</param>
+/// <param name="silent">If true, no info is printed.</param>
+/// <returns>true if the XML was parsed successfully.</returns>
 bool PageXmlParser::read(const QString & xmlPath, bool ignoreLayers, bool silent) {
 
-	QByteArray ba;
 	bool ok = true;
 
 	if (QFileInfo(xmlPath).exists()) {
@@ -66,19 +76,25 @@ bool PageXmlParser::read(const QString & xmlPath, bool ignoreLayers, bool silent
 			mStatus = status_file_locked;
 			ok = false;
 		}
-
-		// load the element
-		ba = f.readAll();
-		f.close();
+		else {
+			// stream the element from the file
+			mPage = parse(&f, mStatus, ignoreLayers);
+			f.close();
+		}
 	}
 	// if there is no local resource - try downloading it
 	else if (QUrl(xmlPath).isValid()) {
 
-		ba = net::download(xmlPath, &ok);
+		QByteArray ba = net::download(xmlPath, &ok);
 
 		if (!ok) {
 			mStatus = status_not_downloaded;
 		}
+		else {
+			QBuffer buffer(&ba);
+			buffer.open(QIODevice::ReadOnly);
+			mPage = parse(&buffer, mStatus, ignoreLayers);
+		}
 	}
 	else {
 		qCritical() << "cannot read XML from non-existing file:" << xmlPath;
@@ -86,11 +102,8 @@ bool PageXmlParser::read(const QString & xmlPath, bool ignoreLayers, bool silent
 		ok = false;
 	}
 
-	if (mStatus == status_not_loaded) {
-		mPage = parse(ba, mStatus, ignoreLayers);
-		if (mPage)
-			mPage->setXmlPath(xmlPath);
-	}
+	if (mPage && mStatus == status_ok)
+		mPage->setXmlPath(xmlPath);
 
 	// create an empty page if we could not read the XML
 	if (!mPage || mStatus != status_ok) {
@@ -103,13 +116,20 @@ bool PageXmlParser::read(const QString & xmlPath, bool ignoreLayers, bool silent
 	return ok;
 }
 
-void PageXmlParser::write(const QString & xmlPath, const QSharedPointer<PageElement> pageElement) {
+/// <summary>
+/// Writes the page element to a PAGE XML file.
+/// The XML is streamed to the file directly.
+/// </summary>
+/// <param name="xmlPath">The XML path.</param>
+/// <param name="pageElement">The page element to write.</param>
+/// <returns>true if the XML was written.</returns>
+bool PageXmlParser::write(const QString & xmlPath, const QSharedPointer<PageElement> pageElement) {
 
 	mPage = pageElement;
 
 	if (!mPage) {
 		qWarning() << "[PageXmlWriter] cannot write a NULL page...";
-		return;
+		return false;
 	}
 
 	Timer dt;
@@ -123,18 +143,50 @@ void PageXmlParser::write(const QString & xmlPath, const QSharedPointer<PageElem
 	// update date modified
 	mPage->setDateModified(QDateTime::currentDateTimeUtc());	// using UTC directly here - somehow the +01:00 to CET is not working here
 	
-	const QByteArray& ba = writePageElement();
-
 	QFile file(xmlPath);
-	file.open(QIODevice::ReadWrite | QIODevice::Truncate | QIODevice::Text);
+	bool success = file.open(QIODevice::ReadWrite | QIODevice::Truncate | QIODevice::Text);
 
-	qint64 success = file.write(ba);
-	file.close();
+	if (success) {
+		writePageElement(&file);
+		success = file.error() == QFileDevice::NoError;
+		file.close();
+	}
 
-	if (success > 0)
+	if (success)
 		qDebug() << "XML written to" << xmlPath << "in" << dt;
 	else
 		qDebug() << "could not write to" << xmlPath;
+
+	return success;
+}
+
+/// <summary>
+/// Only regions of the specified types are created when reading.
+/// Children of skipped regions are added to their closest
+/// parent that is created (e.g. if only text lines are
+/// requested, they are direct children of the root region).
+/// Pass an empty vector to create all regions (default).
+/// </summary>
+/// <param name="types">The region types which should be parsed.</param>
+void PageXmlParser::setTypeFilter(const QVector<Region::Type>& types) {
+	mTypeFilter = types;
+}
+
+QVector<Region::Type> PageXmlParser::typeFilter() const {
+	return mTypeFilter;
+}
+
+/// <summary>
+/// If lazy is true, region polygons are parsed on first access.
+/// See Polygon::fromPointList for details.
+/// </summary>
+/// <param name="lazy">If true, polygons are parsed when they are used.</param>
+void PageXmlParser::setLazyPolygons(bool lazy) {
+	mLazyPolygons = lazy;
+}
+
+bool PageXmlParser::lazyPolygons() const {
+	return mLazyPolygons;
 }
 
 PageXmlParser::LoadStatus PageXmlParser::loadStatus() const {
@@ -198,7 +250,7 @@ void PageXmlParser::setPage(QSharedPointer<PageElement> page) {
 	mPage = page;
 }
 
-QSharedPointer<PageElement> PageXmlParser::parse(const QByteArray& ba, LoadStatus& status, bool ignoreLayers) const {
+QSharedPointer<PageElement> PageXmlParser::parse(QIODevice* device, LoadStatus& status, bool ignoreLayers) const {
 
 	QSharedPointer<PageElement> pageElement;
 
@@ -206,6 +258,7 @@ QSharedPointer<PageElement> PageXmlParser::parse(const QByteArray& ba, LoadStatu
 
 	QString pageTag = tagName(tag_page);	// cache - since it might be called a lot of time
 	QString metaTag = tagName(tag_meta);
+	QString layersTag = tagName(tag_layers);
 
 	RegionManager& rm = RegionManager::instance();
 
@@ -216,17 +269,17 @@ QSharedPointer<PageElement> PageXmlParser::parse(const QByteArray& ba, LoadStatu
 
 	Timer dt;
 
-	QXmlStreamReader reader(ba);
+	QXmlStreamReader reader(device);
 
 	while (!reader.atEnd()) {
 
 		QString tag = reader.qualifiedName().toString();
 
-		if (reader.tokenType() == QXmlStreamReader::StartElement && tag == tagName(tag_meta)) {
+		if (reader.tokenType() == QXmlStreamReader::StartElement && tag == metaTag) {
 			parseMetadata(reader, pageElement);
 		}
 		// e.g. <Page imageFilename="00001234.tif" imageWidth="1000" imageHeight="2000">
-		else if (reader.tokenType() == QXmlStreamReader::StartElement && tag == tagName(tag_page)) {
+		else if (reader.tokenType() == QXmlStreamReader::StartElement && tag == pageTag) {
 
 			pageElement->setImageFileName(reader.attributes().value(tagName(attr_imageFilename)).toString());
 
@@ -240,7 +293,7 @@ QSharedPointer<PageElement> PageXmlParser::parse(const QByteArray& ba, LoadStatu
 				qWarning() << "could not read image dimensions";
 		}
 		// <Layers>
-		else if (reader.tokenType() == QXmlStreamReader::StartElement && tag == tagName(tag_layers)) {
+		else if (reader.tokenType() == QXmlStreamReader::StartElement && tag == layersTag) {
 			parseLayers(reader, pageElement, ignoreLayers);
 		}
 		// e.g. <TextLine id="r1" type="heading">
@@ -308,6 +361,13 @@ void PageXmlParser::parseRegion(QXmlStreamReader & reader, QSharedPointer<Region
 	RegionManager& rm = RegionManager::instance();
 
 	Region::Type rType = rm.type(reader.qualifiedName().toString());
+
+	// the type is not needed - continue with its children
+	if (!mTypeFilter.isEmpty() && !mTypeFilter.contains(rType)) {
+		skipRegion(reader, parent);
+		return;
+	}
+
 	QSharedPointer<Region> region = rm.createRegion(rType);
 	
 	// add region attributes
@@ -320,6 +380,10 @@ void PageXmlParser::parseRegion(QXmlStreamReader & reader, QSharedPointer<Region
 	//region->setTextType(reader.attributes().value(tagName(attr_text_type)).toString());
 	bool readNextLine = true;
 
+	RegionXmlHelper& rh = RegionXmlHelper::instance();
+	const QString coordsTag = rh.tag(RegionXmlHelper::tag_coords);
+	const QString pointsTag = rh.tag(RegionXmlHelper::attr_points);
+
 	while (!reader.atEnd()) {
 		
 		if (readNextLine)
@@ -336,12 +400,46 @@ void PageXmlParser::parseRegion(QXmlStreamReader & reader, QSharedPointer<Region
 		// append children?!
 		if (reader.tokenType() == QXmlStreamReader::StartElement && rm.isValidTypeName(tag)) 
 			parseRegion(reader, region);
+		// keep the point list - it is parsed when the polygon is needed
+		else if (mLazyPolygons && reader.tokenType() == QXmlStreamReader::StartElement && tag == coordsTag &&
+			!reader.attributes().value(pointsTag).isEmpty()) {
+			region->setPolygon(Polygon::fromPointList(reader.attributes().value(pointsTag).toString()));
+			readNextLine = true;
+		}
 		else
 			readNextLine = region->read(reader);	// present current (xml) line to the region
 	}
 
 }
 
+/// <summary>
+/// Skips a region which is not needed (see setTypeFilter).
+/// Region children are parsed and added to the parent.
+/// </summary>
+/// <param name="reader">The XML Reader.</param>
+/// <param name="parent">The parent of the skipped region.</param>
+void PageXmlParser::skipRegion(QXmlStreamReader & reader, QSharedPointer<Region> parent) const {
+
+	RegionManager& rm = RegionManager::instance();
+
+	while (!reader.atEnd()) {
+
+		reader.readNext();
+
+		if (reader.tokenType() == QXmlStreamReader::EndElement && rm.isValidTypeName(reader.qualifiedName().toString()))
+			break;
+
+		if (reader.tokenType() != QXmlStreamReader::StartElement)
+			continue;
+
+		// children of interest?
+		if (rm.isValidTypeName(reader.qualifiedName().toString()))
+			parseRegion(reader, parent);
+		else
+			reader.skipCurrentElement();	// e.g. <Coords> or <TextEquiv>
+	}
+}
+
 /// <summary>
 /// Parses the metadata of a PAGE XML.
 /// </summary>
@@ -425,8 +523,23 @@ QByteArray PageXmlParser::writePageElement() const {
 	QBuffer buffer(&ba);
 	buffer.open(QIODevice::WriteOnly);
 
+	writePageElement(&buffer);
+
+	return ba;
+}
+
+/// <summary>
+/// Writes the current page to the device.
+/// </summary>
+/// <param name="device">An open device (e.g. a file).</param>
+void PageXmlParser::writePageElement(QIODevice* device) const {
+
+	if (!mPage) {
+		qWarning() << "Cannot write XML if page is NULL";
+		return;
+	}
 
-	QXmlStreamWriter writer(&buffer);
+	QXmlStreamWriter writer(device);
 	writer.setAutoFormatting(true);
 	writer.writeStartDocument();
 
@@ -466,8 +579,6 @@ QByteArray PageXmlParser::writePageElement() const {
 	writer.writeEndElement();	// </Page>
 	writer.writeEndElement();	// </PcGts>
 	writer.writeEndDocument();
-
-	return ba;
 }
 
 void PageXmlParser::writeMetaData(QXmlStreamWriter& writer) const {
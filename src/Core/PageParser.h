@@ -32,9 +32,12 @@
 
 #pragma once
 
+#include "Elements.h"
+
 #pragma warning(push, 0)	// no warnings from includes
 #include <QString>
 #include <QSharedPointer>
+#include <QVector>
 #pragma warning(pop)
 
 #pragma warning(disable: 4251)	// dll interface warning
@@ -50,12 +53,10 @@
 // Qt defines
 class QXmlStreamReader;
 class QXmlStreamWriter;
+class QIODevice;
 
 namespace rdf {
 
-class PageElement;
-class Region;
-
 // read defines
 class DllCoreExport PageXmlParser {
 
@@ -94,7 +95,13 @@ public:
 	};
 
 	bool read(const QString& xmlPath, bool ignoreLayers = false, bool silent = false);
-	void write(const QString& xmlPath, const QSharedPointer<PageElement> pageElement);
+	bool write(const QString& xmlPath, const QSharedPointer<PageElement> pageElement);
+
+	void setTypeFilter(const QVector<Region::Type>& types);
+	QVector<Region::Type> typeFilter() const;
+
+	void setLazyPolygons(bool lazy);
+	bool lazyPolygons() const;
 
 	LoadStatus loadStatus() const;
 	QString loadStatusMessage() const;
@@ -111,12 +118,17 @@ protected:
 	QSharedPointer<PageElement> mPage;
 	LoadStatus mStatus = status_not_loaded;
 
-	virtual QSharedPointer<PageElement> parse(const QByteArray& ba, LoadStatus& status, bool ignoreLayers = false) const;
+	QVector<Region::Type> mTypeFilter;		// if not empty, only these region types are created
+	bool mLazyPolygons = false;				// if true, region coordinates are parsed on first access
+
+	virtual QSharedPointer<PageElement> parse(QIODevice* device, LoadStatus& status, bool ignoreLayers = false) const;
 	virtual void parseRegion(QXmlStreamReader& reader, QSharedPointer<Region> parent) const;
+	void skipRegion(QXmlStreamReader& reader, QSharedPointer<Region> parent) const;
 	virtual void parseMetadata(QXmlStreamReader& reader, QSharedPointer<PageElement> page) const;
 	virtual void parseLayers(QXmlStreamReader& reader, QSharedPointer<PageElement> page, bool ignoreLayers = false) const;
 
 	QByteArray writePageElement() const;
+	void writePageElement(QIODevice* device) const;
 	void writeMetaData(QXmlStreamWriter& writer) const;
 };
 
@@ -165,24 +165,37 @@ void MserBlob::draw(QPainter & p) {
 }
 
 // PixelStats --------------------------------------------------------------------
+/// <summary>
+/// Initializes a new instance of the <see cref="PixelStats"/> class.
+/// </summary>
+/// <param name="orHist">The orientation histograms (one row per orientation).</param>
+/// <param name="sparsity">The sparsity (1 x number of orientations).</param>
+/// <param name="scale">The scale (radius) of the histograms.</param>
+/// <param name="scaleFactory">The scale factory.</param>
+/// <param name="id">The pixel's ID.</param>
+/// <param name="data">Optional preallocated storage (idx_end x number of orientations, CV_32FC1).</param>
 PixelStats::PixelStats(const cv::Mat& orHist, 
 	const cv::Mat& sparsity, 
 	double scale, 
 	QSharedPointer<ScaleFactory> scaleFactory,
-	const QString& id) : BaseElement(id) {
+	const QString& id,
+	const cv::Mat& data) : BaseElement(id) {
 
 	mScale = scale;
 	mScaleFactory = scaleFactory;
-	convertData(orHist, sparsity);
+	convertData(orHist, sparsity, data);
 }
 
-void PixelStats::convertData(const cv::Mat& orHist, const cv::Mat& sparsity) {
+void PixelStats::convertData(const cv::Mat& orHist, const cv::Mat& sparsity, const cv::Mat& data) {
 
 	double lambda = 0.5;	// weights sparsity & line frequency measure (1.0 is dft only)
 	assert(orHist.rows == sparsity.cols);
 
 	// enrich our data
-	mData = cv::Mat(idx_end, orHist.rows, CV_32FC1);
+	if (data.rows == idx_end && data.cols == orHist.rows && data.type() == CV_32FC1)
+		mData = data;
+	else
+		mData = cv::Mat(idx_end, orHist.rows, CV_32FC1);
 	sparsity.copyTo(mData.row(sparsity_idx));
 
 	float* maxP = mData.ptr<float>(max_val_idx);
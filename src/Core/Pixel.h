@@ -106,7 +106,8 @@ public:
 		const cv::Mat& sparsity = cv::Mat(),
 		double scale = 0.0,
 		QSharedPointer<ScaleFactory> scaleFactory = QSharedPointer<ScaleFactory>(new ScaleFactory()),
-		const QString& id = QString());
+		const QString& id = QString(),
+		const cv::Mat& data = cv::Mat());
 
 	/* row index of data */
 	enum DataIndex {
@@ -150,7 +151,7 @@ protected:
 	int mOrIdx = -1;
 	int mLineSpacing = -1;
 
-	void convertData(const cv::Mat& orHist, const cv::Mat& sparsity);
+	void convertData(const cv::Mat& orHist, const cv::Mat& sparsity, const cv::Mat& data = cv::Mat());
 };
 
 class DllCoreExport PixelTabStop : public BaseElement {
@@ -40,6 +40,7 @@
 #pragma warning(push, 0)	// no warnings from includes
 #include <QDebug>
 #include <QPainter>
+#include <QSet>
 
 #include <opencv2/imgproc.hpp>
 #pragma warning(pop)
@@ -1409,6 +1410,14 @@ void TextBlock::addPixels(const PixelSet & ps) {
 	}
 }
 
+/// <summary>
+/// Adds a pixel without checking if it is located within the block.
+/// </summary>
+/// <param name="px">The pixel.</param>
+void TextBlock::addPixel(const QSharedPointer<Pixel>& px) {
+	mSet.add(px);
+}
+
 PixelSet TextBlock::pixelSet() const {
 	return mSet;
 }
@@ -1521,12 +1530,98 @@ void TextBlockSet::scale(double factor) {
 		tb->scale(factor);
 }
 
+/// <summary>
+/// Assigns pixels to all text blocks that contain their center.
+/// The blocks' bounding boxes are indexed with a uniform grid
+/// so that each pixel is only tested against nearby polygons.
+/// Blocks with empty polygons cannot contain pixels and are skipped.
+/// </summary>
+/// <param name="ps">The pixels.</param>
 void TextBlockSet::setPixels(const PixelSet & ps) {
 
+	QVector<QPolygonF> polys;
+	QVector<Rect> boxes;
+	QVector<int> blockIdx;	// maps polys/boxes to mTextBlocks
+
+	for (int idx = 0; idx < mTextBlocks.size(); idx++) {
+
+		assert(mTextBlocks[idx]);
+		QPolygonF poly = mTextBlocks[idx]->poly().polygon();
+
+		if (poly.isEmpty())
+			continue;
+
+		polys << poly;
+		boxes << Rect(poly.boundingRect());
+		blockIdx << idx;
+	}
+
+	if (boxes.isEmpty())
+		return;
+
+	Rect bb = boxes[0];
+	for (const Rect& r : boxes)
+		bb = bb.joined(r);
+
+	// grid that maps cells to the blocks overlapping them
+	const int gridSize = 32;
+	double cw = qMax(bb.width() / gridSize, 1.0);
+	double ch = qMax(bb.height() / gridSize, 1.0);
+
+	auto cellIdx = [&](double v, double origin, double cs) {
+		return qBound(0, (int)((v - origin) / cs), gridSize - 1);
+	};
+
+	QVector<QVector<int> > grid(gridSize * gridSize);
+	for (int bIdx = 0; bIdx < boxes.size(); bIdx++) {
+
+		const Rect& r = boxes[bIdx];
+
+		for (int y = cellIdx(r.top(), bb.top(), ch); y <= cellIdx(r.bottom(), bb.top(), ch); y++)
+			for (int x = cellIdx(r.left(), bb.left(), cw); x <= cellIdx(r.right(), bb.left(), cw); x++)
+				grid[y * gridSize + x] << bIdx;
+	}
+
+	for (auto px : ps.pixels()) {
+
+		Vector2D c = px->center();
+
+		if (!bb.contains(c))
+			continue;
+
+		const QVector<int>& cell = grid[cellIdx(c.y(), bb.top(), ch) * gridSize + cellIdx(c.x(), bb.left(), cw)];
+
+		for (int bIdx : cell) {
+
+			// same test as Polygon::contains
+			if (boxes[bIdx].contains(c) && polys[bIdx].containsPoint(c.toQPointF(), Qt::WindingFill))
+				mTextBlocks[blockIdx[bIdx]]->addPixel(px);
+		}
+	}
+}
+
+/// <summary>
+/// Returns true if at least one pixel is assigned to several
+/// text blocks (i.e. if text block polygons overlap).
+/// Blocks which share pixels must not be processed concurrently.
+/// </summary>
+/// <returns>true if pixels are shared between text blocks.</returns>
+bool TextBlockSet::sharesPixels() const {
+
+	QSet<const Pixel*> pixels;
+
 	for (auto tb : mTextBlocks) {
-		assert(tb);
-		tb->addPixels(ps);
+
+		for (auto px : tb->pixelSet().pixels()) {
+
+			if (pixels.contains(px.data()))
+				return true;
+
+			pixels.insert(px.data());
+		}
 	}
+
+	return false;
 }
 
 QVector<QSharedPointer<TextBlock> > TextBlockSet::textBlocks() const {
@@ -314,6 +314,7 @@ public:
 	typedef Flags<mDrawFlags> DrawFlags;
 
 	void addPixels(const PixelSet& ps);
+	void addPixel(const QSharedPointer<Pixel>& px);
 	PixelSet pixelSet() const;
 
 	void scale(double factor) override;
@@ -356,6 +357,7 @@ public:
 	void scale(double factor) override;
 
 	void setPixels(const PixelSet& ps);
+	bool sharesPixels() const;
 	QVector<QSharedPointer<TextBlock> > textBlocks() const;
 
 	QSharedPointer<Region> toTextRegion() const;
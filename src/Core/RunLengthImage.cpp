@@ -0,0 +1,404 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#include "RunLengthImage.h"
+#include "Utils.h"
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QDebug>
+#pragma warning(pop)
+
+namespace rdf {
+
+// RunLengthImage --------------------------------------------------------------------
+RunLengthImage::RunLengthImage(const cv::Size& size) : mSize(size) {
+	updateRowIndex();
+}
+
+/// <summary>
+/// Encodes a binary image (all values != 0 are foreground).
+/// Horizontal strips are encoded in parallel.
+/// </summary>
+/// <param name="bwImg">The CV_8UC1 binary image.</param>
+/// <returns>The run-length encoded image.</returns>
+RunLengthImage RunLengthImage::fromMat(const cv::Mat & bwImg) {
+
+	assert(bwImg.type() == CV_8UC1);
+
+	RunLengthImage img(bwImg.size());
+
+	const int stripHeight = 256;
+	int numStrips = (bwImg.rows + stripHeight - 1) / stripHeight;
+	QVector<QVector<Run> > stripRuns(numStrips);
+
+	Utils::parallelFor(numStrips, [&](int sIdx) {
+
+		QVector<Run>& runs = stripRuns[sIdx];
+		int rEnd = qMin((sIdx + 1) * stripHeight, bwImg.rows);
+
+		for (int rIdx = sIdx * stripHeight; rIdx < rEnd; rIdx++) {
+
+			const unsigned char* ptr = bwImg.ptr<unsigned char>(rIdx);
+
+			for (int cIdx = 0; cIdx < bwImg.cols; ) {
+
+				if (!ptr[cIdx]) {
+					cIdx++;
+					continue;
+				}
+
+				Run r;
+				r.row = rIdx;
+				r.start = cIdx;
+
+				while (cIdx < bwImg.cols && ptr[cIdx])
+					cIdx++;
+
+				r.end = cIdx;
+				runs << r;
+			}
+		}
+	});
+
+	int numRuns = 0;
+	for (const QVector<Run>& runs : stripRuns)
+		numRuns += runs.size();
+
+	img.mRuns.reserve(numRuns);
+	for (const QVector<Run>& runs : stripRuns)
+		img.mRuns << runs;
+
+	img.updateRowIndex();
+
+	return img;
+}
+
+/// <summary>
+/// Encodes a binary patch (e.g. a drawing's bounding box)
+/// which is placed at offset in an image with the given size.
+/// Runs outside the image are clipped.
+/// </summary>
+/// <param name="bwImg">The CV_8UC1 binary patch.</param>
+/// <param name="size">The image size.</param>
+/// <param name="offset">The patch's top left corner in the image.</param>
+/// <returns>The run-length encoded image.</returns>
+RunLengthImage RunLengthImage::fromMat(const cv::Mat & bwImg, const cv::Size & size, const cv::Point & offset) {
+
+	RunLengthImage patch = fromMat(bwImg);
+	RunLengthImage img(size);
+
+	for (Run r : patch.mRuns) {
+
+		r.row += offset.y;
+		r.start = qMax(r.start + offset.x, 0);
+		r.end = qMin(r.end + offset.x, size.width);
+
+		if (r.row >= 0 && r.row < size.height && r.start < r.end)
+			img.mRuns << r;
+	}
+
+	img.updateRowIndex();
+
+	return img;
+}
+
+/// <summary>
+/// Decodes the image.
+/// </summary>
+/// <param name="fgVal">The foreground value.</param>
+/// <returns>A CV_8UC1 image.</returns>
+cv::Mat RunLengthImage::toMat(unsigned char fgVal) const {
+
+	cv::Mat img(mSize, CV_8UC1, cv::Scalar(0));
+	draw(img, cv::Scalar(fgVal));
+
+	return img;
+}
+
+/// <summary>
+/// Draws all runs to img.
+/// </summary>
+/// <param name="img">A CV_8UC1 image with the size of this image.</param>
+/// <param name="color">The foreground color.</param>
+void RunLengthImage::draw(cv::Mat & img, const cv::Scalar & color) const {
+
+	assert(img.type() == CV_8UC1 && img.size() == mSize);
+
+	unsigned char val = cv::saturate_cast<unsigned char>(color[0]);
+
+	for (const Run& r : mRuns) {
+		unsigned char* ptr = img.ptr<unsigned char>(r.row);
+		memset(ptr + r.start, val, r.length());
+	}
+}
+
+bool RunLengthImage::isEmpty() const {
+	return mRuns.isEmpty();
+}
+
+cv::Size RunLengthImage::size() const {
+	return mSize;
+}
+
+int RunLengthImage::numRuns() const {
+	return mRuns.size();
+}
+
+/// <summary>
+/// Returns the number of foreground pixels.
+/// </summary>
+int64 RunLengthImage::area() const {
+
+	int64 a = 0;
+	for (const Run& r : mRuns)
+		a += r.length();
+
+	return a;
+}
+
+QVector<RunLengthImage::Run> RunLengthImage::runs() const {
+	return mRuns;
+}
+
+/// <summary>
+/// Returns the intersection of two images.
+/// </summary>
+/// <param name="img">An image with the same size.</param>
+/// <returns>The intersection.</returns>
+RunLengthImage RunLengthImage::operator&(const RunLengthImage & img) const {
+
+	assert(img.size() == mSize);
+	RunLengthImage dst(mSize);
+
+	for (int rIdx = 0; rIdx < mSize.height; rIdx++) {
+
+		int i1 = mRowIdx[rIdx], i2 = img.mRowIdx[rIdx];
+
+		while (i1 < mRowIdx[rIdx + 1] && i2 < img.mRowIdx[rIdx + 1]) {
+
+			const Run& r1 = mRuns[i1];
+			const Run& r2 = img.mRuns[i2];
+
+			Run r;
+			r.row = rIdx;
+			r.start = qMax(r1.start, r2.start);
+			r.end = qMin(r1.end, r2.end);
+
+			if (r.start < r.end)
+				dst.mRuns << r;
+
+			// continue with the run that ends first
+			if (r1.end < r2.end)
+				i1++;
+			else
+				i2++;
+		}
+	}
+
+	dst.updateRowIndex();
+
+	return dst;
+}
+
+/// <summary>
+/// Returns the union of two images.
+/// </summary>
+/// <param name="img">An image with the same size.</param>
+/// <returns>The union.</returns>
+RunLengthImage RunLengthImage::operator|(const RunLengthImage & img) const {
+
+	assert(img.size() == mSize);
+	RunLengthImage dst(mSize);
+
+	for (int rIdx = 0; rIdx < mSize.height; rIdx++) {
+
+		int i1 = mRowIdx[rIdx], i2 = img.mRowIdx[rIdx];
+		int e1 = mRowIdx[rIdx + 1], e2 = img.mRowIdx[rIdx + 1];
+		int rowStart = dst.mRuns.size();
+
+		while (i1 < e1 || i2 < e2) {
+
+			// take the run that starts first
+			const Run& r = (i2 >= e2 || (i1 < e1 && mRuns[i1].start <= img.mRuns[i2].start)) ? mRuns[i1++] : img.mRuns[i2++];
+
+			// merge touching & overlapping runs
+			if (dst.mRuns.size() > rowStart && dst.mRuns.last().end >= r.start)
+				dst.mRuns.last().end = qMax(dst.mRuns.last().end, r.end);
+			else
+				dst.mRuns << r;
+		}
+	}
+
+	dst.updateRowIndex();
+
+	return dst;
+}
+
+/// <summary>
+/// Labels the 8-connected components.
+/// Runs are merged with a union-find.
+/// </summary>
+/// <param name="numComponents">If not NULL, the number of components is returned.</param>
+/// <returns>The component label [0 numComponents) of each run.</returns>
+QVector<int> RunLengthImage::labels(int* numComponents) const {
+
+	QVector<int> parents(mRuns.size());
+	for (int idx = 0; idx < parents.size(); idx++)
+		parents[idx] = idx;
+
+	for (int rIdx = 1; rIdx < mSize.height; rIdx++) {
+
+		int iu = mRowIdx[rIdx - 1];
+		int ic = mRowIdx[rIdx];
+
+		while (iu < mRowIdx[rIdx] && ic < mRowIdx[rIdx + 1]) {
+
+			const Run& ru = mRuns[iu];
+			const Run& rc = mRuns[ic];
+
+			// 8-connected: diagonal neighbors are connected too
+			if (ru.start <= rc.end && rc.start <= ru.end) {
+
+				int pu = find(parents, iu);
+				int pc = find(parents, ic);
+
+				if (pu != pc)
+					parents[qMax(pu, pc)] = qMin(pu, pc);
+			}
+
+			if (ru.end < rc.end)
+				iu++;
+			else
+				ic++;
+		}
+	}
+
+	// consecutive labels
+	QVector<int> labels(mRuns.size());
+	int nc = 0;
+
+	for (int idx = 0; idx < mRuns.size(); idx++) {
+
+		int p = find(parents, idx);
+		labels[idx] = (p == idx) ? nc++ : labels[p];	// roots have the smallest index
+	}
+
+	if (numComponents)
+		*numComponents = nc;
+
+	return labels;
+}
+
+/// <summary>
+/// Removes all components with an area &lt;= minArea or &gt;= maxArea.
+/// </summary>
+/// <param name="minArea">The minimum area.</param>
+/// <param name="maxArea">The maximum area (-1 ignores it).</param>
+/// <param name="removed">If not NULL, the removed components are returned.</param>
+/// <returns>The filtered image.</returns>
+RunLengthImage RunLengthImage::filterArea(int minArea, int maxArea, RunLengthImage* removed) const {
+
+	int nc = 0;
+	QVector<int> l = labels(&nc);
+
+	QVector<int64> areas(nc, 0);
+	for (int idx = 0; idx < mRuns.size(); idx++)
+		areas[l[idx]] += mRuns[idx].length();
+
+	RunLengthImage dst(mSize);
+
+	if (removed)
+		*removed = RunLengthImage(mSize);
+
+	for (int idx = 0; idx < mRuns.size(); idx++) {
+
+		int64 a = areas[l[idx]];
+
+		if (a > minArea && (maxArea == -1 || a < maxArea))
+			dst.mRuns << mRuns[idx];
+		else if (removed)
+			removed->mRuns << mRuns[idx];
+	}
+
+	dst.updateRowIndex();
+
+	if (removed)
+		removed->updateRowIndex();
+
+	return dst;
+}
+
+/// <summary>
+/// Keeps all components that are marked in keep.
+/// </summary>
+/// <param name="labels">The component labels of all runs (see labels()).</param>
+/// <param name="keep">A flag for each component label.</param>
+/// <returns>The filtered image.</returns>
+RunLengthImage RunLengthImage::filterComponents(const QVector<int>& labels, const QVector<bool>& keep) const {
+
+	assert(labels.size() == mRuns.size());
+	RunLengthImage dst(mSize);
+
+	for (int idx = 0; idx < mRuns.size(); idx++) {
+
+		if (keep[labels[idx]])
+			dst.mRuns << mRuns[idx];
+	}
+
+	dst.updateRowIndex();
+
+	return dst;
+}
+
+void RunLengthImage::updateRowIndex() {
+
+	mRowIdx.fill(0, qMax(mSize.height, 0) + 1);
+
+	for (const Run& r : mRuns)
+		mRowIdx[r.row + 1]++;
+
+	for (int idx = 1; idx < mRowIdx.size(); idx++)
+		mRowIdx[idx] += mRowIdx[idx - 1];
+}
+
+int RunLengthImage::find(QVector<int>& parents, int idx) const {
+
+	// path halving
+	while (parents[idx] != idx) {
+		parents[idx] = parents[parents[idx]];
+		idx = parents[idx];
+	}
+
+	return idx;
+}
+
+}
@@ -0,0 +1,103 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QVector>
+#include <opencv2/core.hpp>
+#pragma warning(pop)
+
+#ifndef DllCoreExport
+#ifdef DLL_CORE_EXPORT
+#define DllCoreExport Q_DECL_EXPORT
+#else
+#define DllCoreExport Q_DECL_IMPORT
+#endif
+#endif
+
+#pragma warning(disable: 4251)
+
+namespace rdf {
+
+/// <summary>
+/// Run-length encoded binary image.
+/// Foreground pixels are stored as horizontal runs which
+/// needs a fraction of the memory of CV_8UC1 masks for
+/// sparse images (e.g. line or separator images).
+/// Connected components, area filtering and logical
+/// operations are computed on the runs directly.
+/// </summary>
+class DllCoreExport RunLengthImage {
+
+public:
+	RunLengthImage(const cv::Size& size = cv::Size());
+
+	/// <summary>
+	/// Foreground pixels [start end) of a row.
+	/// </summary>
+	struct Run {
+		int row;
+		int start;
+		int end;
+
+		int length() const { return end - start; }
+	};
+
+	static RunLengthImage fromMat(const cv::Mat& bwImg);
+	static RunLengthImage fromMat(const cv::Mat& bwImg, const cv::Size& size, const cv::Point& offset);
+	cv::Mat toMat(unsigned char fgVal = 255) const;
+	void draw(cv::Mat& img, const cv::Scalar& color = cv::Scalar(255)) const;
+
+	bool isEmpty() const;
+	cv::Size size() const;
+	int numRuns() const;
+	int64 area() const;
+	QVector<Run> runs() const;
+
+	RunLengthImage operator&(const RunLengthImage& img) const;
+	RunLengthImage operator|(const RunLengthImage& img) const;
+
+	QVector<int> labels(int* numComponents = 0) const;
+	RunLengthImage filterArea(int minArea, int maxArea = -1, RunLengthImage* removed = 0) const;
+	RunLengthImage filterComponents(const QVector<int>& labels, const QVector<bool>& keep) const;
+
+protected:
+	cv::Size mSize;
+	QVector<Run> mRuns;			// sorted by rows and columns
+	QVector<int> mRowIdx;		// runs of row r: [mRowIdx[r] mRowIdx[r+1])
+
+	void updateRowIndex();
+	int find(QVector<int>& parents, int idx) const;
+};
+
+}
@@ -95,7 +95,7 @@ ScaleFactory::ScaleFactory(const Vector2D& imgSize) {
 	mScaleFactor = scaleFactor(mImgSize, config()->maxImageSide(), config()->scaleMode());
 }
 
-double ScaleFactory::scaleFactor() {
+double ScaleFactory::scaleFactor() const {
 
 
 	if (mImgSize.isNull()) {
@@ -106,7 +106,7 @@ double ScaleFactory::scaleFactor() {
 	return mScaleFactor;
 }
 
-double ScaleFactory::scaleFactorDpi() {
+double ScaleFactory::scaleFactorDpi() const {
 
 	// clear dpi changes (parameters are tuned for 300dpi)
 	return scaleFactor() * (double)config()->dpi() / 300.0;
@@ -122,7 +122,7 @@ void ScaleFactory::setConfig(QSharedPointer<ScaleFactoryConfig> c) {
 	mScaleFactor = scaleFactor(mImgSize, config()->maxImageSide(), config()->scaleMode());
 }
 
-cv::Mat ScaleFactory::scaled(cv::Mat & img) {
+cv::Mat ScaleFactory::scaled(cv::Mat & img) const {
 
 	cv::Mat sImg = img;
 
@@ -137,15 +137,15 @@ cv::Mat ScaleFactory::scaled(cv::Mat & img) {
 	return sImg;
 }
 
-void ScaleFactory::scale(BaseElement & el) {
+void ScaleFactory::scale(BaseElement & el) const {
 	el.scale(ScaleFactory::scaleFactor());
 }
 
-void ScaleFactory::scaleInv(BaseElement & el) {
+void ScaleFactory::scaleInv(BaseElement & el) const {
 	el.scale(1.0 / ScaleFactory::scaleFactor());
 }
 
-Vector2D ScaleFactory::imgSize() {
+Vector2D ScaleFactory::imgSize() const {
 	return mImgSize;
 }
 
@@ -92,17 +92,22 @@ protected:
 	ScaleFactoryConfig::ScaleSideMode mScaleMode = ScaleFactoryConfig::scale_height;	// scaling mode (see ScaleSideMode)
 };
 
+/// <summary>
+/// Scales images and page elements to the working resolution.
+/// The const functions are thread-safe, i.e. one ScaleFactory
+/// can be shared by modules that run concurrently.
+/// </summary>
 class DllCoreExport ScaleFactory {
 
 public:
 	ScaleFactory(const Vector2D& imgSize = Vector2D());
 
-	double scaleFactor();
-	double scaleFactorDpi();
-	cv::Mat scaled(cv::Mat& img);
-	void scale(BaseElement& el);
-	void scaleInv(BaseElement& el);
-	Vector2D imgSize();
+	double scaleFactor() const;
+	double scaleFactorDpi() const;
+	cv::Mat scaled(cv::Mat& img) const;
+	void scale(BaseElement& el) const;
+	void scaleInv(BaseElement& el) const;
+	Vector2D imgSize() const;
 
 	QSharedPointer<ScaleFactoryConfig> config() const;
 	void setConfig(QSharedPointer<ScaleFactoryConfig> c);
@@ -100,9 +100,7 @@ Config::Config() {
 
 Config& Config::instance() { 
 
-	static QSharedPointer<Config> inst;
-	if (!inst)
-		inst = QSharedPointer<Config>(new Config());
+	static QSharedPointer<Config> inst(new Config());
 	return *inst; 
 }
 
@@ -48,21 +48,63 @@ Polygon::Polygon(const QPolygonF& polygon) {
 	mPoly = polygon;
 }
 bool Polygon::isEmpty() const {
+	materialize();
 	return mPoly.isEmpty();
 }
 void Polygon::read(const QString & pointList) {
+	mPointList.clear();
 	mPoly = Converter::stringToPoly(pointList);
 }
 
 QString Polygon::write() const {
+
+	// nothing changed since reading - we can write the point list as is
+	if (!mPointList.isEmpty())
+		return mPointList;
+
 	return Converter::polyToString(mPoly.toPolygon());
 }
 
+/// <summary>
+/// Creates a polygon from a PAGE point list (e.g. "1077,482 1167,482 1167,547").
+/// In contrast to read(), the point list is parsed when the polygon
+/// is accessed for the first time. Hence, regions that are never
+/// touched do not pay for parsing their coordinates.
+/// NOTE: the first access modifies the polygon - so make sure it
+/// is not accessed concurrently before it is materialized.
+/// </summary>
+/// <param name="pointList">The point list.</param>
+/// <returns>A polygon which is parsed on demand.</returns>
+Polygon Polygon::fromPointList(const QString & pointList) {
+	
+	Polygon p;
+	p.mPointList = pointList;
+
+	return p;
+}
+
+/// <summary>
+/// Parses a lazy point list (see fromPointList).
+/// Owners that hand out copies (e.g. Region::polygon) should call this
+/// on their own instance so that the parsed points are shared by all
+/// copies rather than being parsed again for every copy.
+/// </summary>
+void Polygon::materialize() const {
+
+	if (mPointList.isEmpty())
+		return;
+
+	mPoly = Converter::stringToPoly(mPointList);
+	mPointList.clear();
+}
+
 void Polygon::translate(const QPointF & offset) {
+	materialize();
 	mPoly.translate(offset);
 }
 
 int Polygon::size() const {
+	materialize();
 	return mPoly.size();
 }
 
@@ -111,11 +153,13 @@ Polygon Polygon::fromRect(const Rect & rect) {
 }
 
 void Polygon::setPolygon(const QPolygonF & polygon) {
+	mPointList.clear();
 	mPoly = polygon;
 }
 
 void Polygon::scale(double factor) {
 
+	materialize();
 	QPolygonF sPoly;
 
 	for (const QPointF& pt : mPoly) {
@@ -146,15 +190,18 @@ void Polygon::draw(QPainter & p) const {
 
 bool Polygon::contains(const Vector2D & pt) const {
 
+	materialize();
 	return mPoly.containsPoint(pt.toQPointF(), Qt::WindingFill);
 }
 
 QPolygonF Polygon::polygon() const {
+	materialize();
 	return mPoly;
 }
 
 QPolygonF Polygon::closedPolygon() const {
 	
+	materialize();
 	QPolygonF closed = mPoly;
 	if (!mPoly.isEmpty())
 		closed.append(mPoly.first());
@@ -164,6 +211,8 @@ QPolygonF Polygon::closedPolygon() const {
 
 QVector<Vector2D> Polygon::toPoints() const {
 
+	materialize();
+
 	//QVector<Vector2D> pts(mPoly.size());
 	QVector<Vector2D> pts; //bugfix fk
 	for (const QPointF& p : mPoly)
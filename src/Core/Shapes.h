@@ -496,9 +496,11 @@ public:
 	Polygon(const QPolygonF& polygon = QPolygonF());
 
 	void operator<<(const QPointF& pt) {
+		materialize();
 		mPoly << pt;
 	}
 	void operator<<(const Vector2D& pt) {
+		materialize();
 		mPoly << pt.toQPointF();
 	}
 
@@ -507,6 +509,8 @@ public:
 	void read(const QString& pointList);
 	QString write() const;
 
+	static Polygon fromPointList(const QString& pointList);
+
 	void translate(const QPointF& offset);
 
 	int size() const;
@@ -524,9 +528,11 @@ public:
 	void draw(QPainter& p) const;
 	bool contains(const Vector2D& pt) const;
 
-protected:
-	QPolygonF mPoly;
+	void materialize() const;
 
+protected:
+	mutable QPolygonF mPoly;
+	mutable QString mPointList;		// PAGE point list which is parsed on first access (see fromPointList)
 };
 
 class DllCoreExport LineCandidates {
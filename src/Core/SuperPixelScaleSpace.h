@@ -96,10 +96,6 @@ public:
 
 		Timer dt;
 
-		cv::Mat img = mSrcImg.clone();
-		img = IP::grayscale(img);
-		cv::normalize(img, img, 255, 0, cv::NORM_MINMAX);
-
 		Config::instance().global().setNumScales(config()->numLayers());
 
 		int idCnt = 0;
@@ -109,6 +105,9 @@ public:
 			// compute super pixel
 			if (config()->minLayer() <= idx) {
 
+				// pyramid levels are shared with other modules via the page context
+				cv::Mat img = mPageImage->pyramidLevel(idx);
+
 				SuperPixelModule spm(img);
 				spm.setPyramidLevel(idx);
 				qDebug() << "computing new layer...";
@@ -136,8 +135,6 @@ public:
 
 				mSet += set;
 			}
-
-			cv::resize(img, img, cv::Size(), 0.5, 0.5, CV_INTER_AREA);
 		}
 
 		// filter from all scales
@@ -171,7 +168,7 @@ public:
 	}
 
 	QSharedPointer<ScaleSpaceSPConfig> config() const {
-		return qSharedPointerDynamicCast<ScaleSpaceSPConfig>(mConfig);
+		return castConfig<ScaleSpaceSPConfig>();
 	}
 
 };
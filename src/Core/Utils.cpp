@@ -61,6 +61,24 @@
 namespace rdf {
 
 
+/// <summary>
+/// Calls a function for each index of a cv::parallel_for_ range.
+/// </summary>
+class ParallelFunctionBody : public cv::ParallelLoopBody {
+
+public:
+	ParallelFunctionBody(const std::function<void(int)>& fnc) : mFnc(fnc) {}
+
+	void operator()(const cv::Range& range) const override {
+
+		for (int idx = range.start; idx < range.end; idx++)
+			mFnc(idx);
+	}
+
+private:
+	const std::function<void(int)>& mFnc;
+};
+
 // Utils --------------------------------------------------------------------
 Utils::Utils() {
 
@@ -353,6 +371,32 @@ void Utils::initDefaultFramework() {
 
 }
 
+/// <summary>
+/// Calls fnc(idx) for all idx in [0 numElements) using OpenCV's thread pool.
+/// The calling order is not defined and fnc must be thread-safe.
+/// </summary>
+/// <param name="numElements">The number of elements.</param>
+/// <param name="fnc">The function called for each element.</param>
+/// <param name="maxWorkers">The maximum number of concurrent calls (0 = OpenCV's default).</param>
+void Utils::parallelFor(int numElements, const std::function<void(int)>& fnc, int maxWorkers) {
+
+	if (numElements <= 0)
+		return;
+
+	if (maxWorkers <= 0 || maxWorkers >= numElements) {
+		cv::parallel_for_(cv::Range(0, numElements), ParallelFunctionBody(fnc));
+		return;
+	}
+
+	// each worker processes every maxWorkers-th element
+	std::function<void(int)> worker = [&](int wIdx) {
+		for (int idx = wIdx; idx < numElements; idx += maxWorkers)
+			fnc(idx);
+	};
+
+	cv::parallel_for_(cv::Range(0, maxWorkers), ParallelFunctionBody(worker));
+}
+
 // Converter --------------------------------------------------------------------
 
 /// <summary>
@@ -415,17 +459,42 @@ QPolygon Converter::stringToPoly(const QString& pointList) {
 /// <returns>A string representing the polygon.</returns>
 QString Converter::polyToString(const QPolygon& polygon) {
 
-	QString polyStr;
+	// NOTE: this is called for every region & baseline when writing PAGE XMLs
+	// so we format the integers directly into a preallocated buffer
+	QByteArray polyStr;
+	polyStr.reserve(polygon.size() * 12);	// ~ "1234,5678 "
 
-	for (const QPoint& p : polygon) {
-		polyStr += QString::number(p.x()) + "," + QString::number(p.y()) + " ";
-	}
+	char digits[12];
+
+	auto appendInt = [&](int val) {
 
-	// NOTE: we have one space at the end
-	//FK040716: remove last space - otherwise we get a warning when reading
-	polyStr.remove(polyStr.length() - 1, 1);
+		unsigned int uVal = val < 0 ? 0u - (unsigned int)val : (unsigned int)val;
+		int idx = 0;
+
+		do {
+			digits[idx++] = (char)('0' + uVal % 10);
+			uVal /= 10;
+		} while (uVal > 0);
+
+		if (val < 0)
+			polyStr.append('-');
+
+		while (idx > 0)
+			polyStr.append(digits[--idx]);
+	};
+
+	for (int idx = 0; idx < polygon.size(); idx++) {
+
+		//FK040716: no space at the end - otherwise we get a warning when reading
+		if (idx > 0)
+			polyStr.append(' ');
+
+		appendInt(polygon[idx].x());
+		polyStr.append(',');
+		appendInt(polygon[idx].y());
+	}
 
-	return polyStr;
+	return QString::fromLatin1(polyStr);
 }
 
 QPointF Converter::cvPointToQt(const cv::Point & pt) {
@@ -38,6 +38,8 @@
 #include <QTime>
 
 #include <opencv2/core.hpp>
+
+#include <functional>
 #pragma warning(pop)
 
 #pragma warning (disable: 4251)	// inlined Qt functions in dll interface
@@ -89,6 +91,8 @@ public:
 	static int64 writeJson(const QString& filePath, const QJsonObject& jo);
 	static void initDefaultFramework();
 
+	static void parallelFor(int numElements, const std::function<void(int)>& fnc, int maxWorkers = 0);
+
 	// little number thingies
 	template<typename num>
 	static num clamp(num val, num min, num max) {
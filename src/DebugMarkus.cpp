@@ -56,6 +56,7 @@
 #pragma warning(push, 0)	// no warnings from includes
 #include <QDebug>
 #include <QImage>
+#include <QDir>
 #include <QFileInfo>
 #include <QProcess>
 
@@ -326,6 +327,62 @@ void LayoutTest::layoutToXmlDebug() const {
 	qInfo() << "layout analysis computed in" << dt;
 }
 
+/// <summary>
+/// Collects the features of all GT pages and trains the super pixel classifier.
+/// The image path is either a single image or a folder of images
+/// whose PAGE XMLs are stored in the page subfolder.
+/// </summary>
+void LayoutTest::train() const {
+
+	QStringList imagePaths;
+	QFileInfo imgInfo(mConfig.imagePath());
+
+	if (imgInfo.isDir()) {
+
+		QDir dir(imgInfo.absoluteFilePath());
+		QStringList filters;
+		filters << "*.jpg" << "*.jpeg" << "*.png" << "*.tif" << "*.tiff";
+
+		for (const QString& fileName : dir.entryList(filters, QDir::Files))
+			imagePaths << dir.absoluteFilePath(fileName);
+	}
+	else
+		imagePaths << mConfig.imagePath();
+
+	Timer dt;
+
+	LabelManager lm = LabelManager::read(mConfig.labelConfigPath());
+	qInfo().noquote() << lm.toString();
+
+	// collect features of all pages
+	FeatureCollector fc(imagePaths, lm);
+
+	if (!fc.compute()) {
+		qCritical() << "could not collect features...";
+		return;
+	}
+
+	qInfo().noquote() << fc.toString();
+
+	FeatureCollectionManager fcm = fc.featureManager();
+
+	if (!mConfig.featureCachePath().isEmpty())
+		fcm.write(mConfig.featureCachePath());
+
+	// train classifier
+	SuperPixelTrainer spt(fcm);
+
+	if (!spt.compute()) {
+		qCritical() << "could not train data...";
+		return;
+	}
+
+	if (!mConfig.classifierPath().isEmpty())
+		spt.write(mConfig.classifierPath());
+
+	qInfo() << fc.numPagesProcessed() << "pages trained in" << dt;
+}
+
 void LayoutTest::testFeatureCollector(const cv::Mat & src) const {
 	
 	rdf::Timer dt;
@@ -67,6 +67,7 @@ public:
 	void testComponents();
 	void layoutToXml() const;
 	void layoutToXmlDebug() const;
+	void train() const;
 
 protected:
 	void testFeatureCollector(const cv::Mat& src) const;
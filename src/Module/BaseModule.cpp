@@ -37,10 +37,13 @@
 #pragma warning(push, 0)	// no warnings from includes
 #include <QSettings>
 #include <QDebug>
+#include <QAtomicInt>
 #pragma warning(pop)
 
 namespace rdf {
 
+static QAtomicInt sConfigCasts;	// number of typed config casts (profiling)
+
 // ModuleConfig --------------------------------------------------------------------
 ModuleConfig::ModuleConfig(const QString& moduleName) {
 	mModuleName = moduleName;
@@ -122,6 +125,25 @@ QSharedPointer<ModuleConfig> Module::config() const {
 	return mConfig;
 }
 
+/// <summary>
+/// Returns the number of typed config casts performed by all modules.
+/// Compare the value before and after compute() to check that
+/// a module does not resolve its config in hot loops.
+/// Casts are only counted in debug builds (no global atomic in hot paths).
+/// </summary>
+/// <returns>The number of config casts since the framework was loaded or -1 if casts are not counted (release).</returns>
+int Module::numConfigCasts() {
+#ifndef QT_NO_DEBUG
+	return sConfigCasts.load();
+#else
+	return -1;
+#endif
+}
+
+void Module::countConfigCast() {
+	sConfigCasts.fetchAndAddRelaxed(1);
+}
+
 QString Module::debugName() const {
 	return "[" + mConfig->name() + "]";
 }
@@ -153,7 +175,7 @@ void ScaleModuleConfig::setScaleFactory(const QSharedPointer<ScaleFactory>& sf)
 	mScaleFactory = sf;
 }
 
-QSharedPointer<ScaleFactory> ScaleModuleConfig::scaleFactory() {
+QSharedPointer<ScaleFactory> ScaleModuleConfig::scaleFactory() const {
 	return mScaleFactory;
 }
 
@@ -112,7 +112,7 @@ public:
 		const QSharedPointer<ScaleFactory>& sf = QSharedPointer<ScaleFactory>());
 
 	void setScaleFactory(const QSharedPointer<ScaleFactory>& sf);
-	QSharedPointer<ScaleFactory> scaleFactory();
+	QSharedPointer<ScaleFactory> scaleFactory() const;
 
 protected:
 	QSharedPointer<ScaleFactory> mScaleFactory;
@@ -165,12 +165,49 @@ public:
 	virtual void setConfig(QSharedPointer<ModuleConfig> config);
 	QSharedPointer<ModuleConfig> config() const;
 
+	static int numConfigCasts();
+
 protected:
 	QSharedPointer<ModuleConfig> mConfig;		/**< the module config **/
 
 	virtual bool checkInput() const = 0;		/**< checks if all input images are in the specified format.**/
 	QString debugName() const;
 
+	/// <summary>
+	/// Casts the module config to its derived type.
+	/// All typed config() accessors should use this function.
+	/// In debug builds, casts are counted (see numConfigCasts) so
+	/// that profiling can verify that no cast is left in hot loops.
+	/// </summary>
+	/// <returns>The typed config or a null pointer if the type does not match.</returns>
+	template <class T>
+	QSharedPointer<T> castConfig() const {
+#ifndef QT_NO_DEBUG
+		countConfigCast();
+#endif
+		return qSharedPointerDynamicCast<T>(mConfig);
+	}
+
+	/// <summary>
+	/// Returns an immutable copy of the typed config.
+	/// Resolve the snapshot once when compute() starts and pass
+	/// it to inner loops instead of calling config() per item.
+	/// </summary>
+	/// <returns>A read-only copy of the config or a null pointer if the type does not match.</returns>
+	template <class T>
+	QSharedPointer<const T> configSnapshot() const {
+
+		QSharedPointer<T> c = castConfig<T>();
+
+		if (!c)
+			return QSharedPointer<const T>();
+
+		return QSharedPointer<const T>(new T(*c));
+	}
+
+private:
+	static void countConfigCast();
+
 };
 
 }
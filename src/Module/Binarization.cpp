@@ -115,7 +115,7 @@ QString SimpleBinarization::toString() const {
 }
 
 QSharedPointer<SimpleBinarizationConfig> SimpleBinarization::config() const {
-	return qSharedPointerDynamicCast<SimpleBinarizationConfig>(mConfig);
+	return castConfig<SimpleBinarizationConfig>();
 }
 
 // BaseBinarizationSu --------------------------------------------------------------------
@@ -234,7 +234,7 @@ void BaseBinarizationSu::setPreFiltering(bool preFilter, int preFilterSize) {
 }
 
 QSharedPointer<BaseBinarizationSuConfig> BaseBinarizationSu::config() const {
-	return qSharedPointerDynamicCast<BaseBinarizationSuConfig>(mConfig);
+	return castConfig<BaseBinarizationSuConfig>();
 }
 
 cv::Mat BaseBinarizationSu::compContrastImg(const cv::Mat& srcImg, const cv::Mat& mask) const {
@@ -58,14 +58,29 @@ QString DeepMergeConfig::labelConfigPath() const {
 	return mLabelConfigPath;
 }
 
+/// <summary>
+/// Probability maps larger than tileSize are optimized in
+/// tiles (in parallel) so that large pages fit into memory.
+/// </summary>
+/// <param name="tileSize">The tile size in pixels (0 disables tiling).</param>
+void DeepMergeConfig::setTileSize(int tileSize) {
+	mTileSize = tileSize;
+}
+
+int DeepMergeConfig::tileSize() const {
+	return ModuleConfig::checkParam(mTileSize, 0, INT_MAX, "tileSize");
+}
+
 void DeepMergeConfig::load(const QSettings & settings) {
 	
 	mLabelConfigPath = settings.value("LabelConfigPath", mLabelConfigPath).toString();
+	mTileSize = settings.value("tileSize", tileSize()).toInt();
 }
 
 void DeepMergeConfig::save(QSettings & settings) const {
 	
 	settings.setValue("LabelConfigPath", mLabelConfigPath);
+	settings.setValue("tileSize", tileSize());
 }
 
 // LayoutAnalysis --------------------------------------------------------------------
@@ -106,6 +121,8 @@ bool DeepMerge::compute() {
 	channels.push_front(1.0 - mi);
 
 	DeepCut dc(channels);
+	dc.config()->setTileSize(config()->tileSize());
+
 	if (!dc.compute())
 		qWarning() << "could not compute DeepCut!";
 
@@ -117,14 +134,12 @@ bool DeepMerge::compute() {
 		qWarning() << "the labels loaded from" << config()->labelConfigPath() << "do not fit the number of labels we have in DeepMerge:" << channels.size();
 	}
 
-	for (int idx = 0; idx < channels.size(); idx++) {
+	QVector<QVector<Polygon> > polys = IP::labelsToPoly(mLabelImg, channels.size(), mScaleFactor);
 
-		cv::Mat cImg = mLabelImg == idx;
+	for (int idx = 0; idx < polys.size(); idx++) {
 
-		auto poly = IP::maskToPoly(cImg, mScaleFactor);
 		LabelInfo l = mManager.find(idx);
-
-		mRegions << DMRegion(poly, l);
+		mRegions << DMRegion(polys[idx], l);
 	}
 
 	mInfo << "computed in" << dt;
@@ -156,7 +171,7 @@ cv::Mat DeepMerge::thresh(const cv::Mat& src, double thr) const {
 }
 
 QSharedPointer<DeepMergeConfig> DeepMerge::config() const {
-	return qSharedPointerDynamicCast<DeepMergeConfig>(mConfig);
+	return castConfig<DeepMergeConfig>();
 }
 
 cv::Mat DeepMerge::draw(const cv::Mat & img, const QColor& /*col*/) const {
@@ -64,9 +64,13 @@ public:
 
 	QString labelConfigPath() const;
 
+	void setTileSize(int tileSize);
+	int tileSize() const;
+
 protected:
 
 	QString mLabelConfigPath = "C:/nextcloud/READ/basilis/DeepMerge-config.json";
+	int mTileSize = 2048;		// larger probability maps are cut in tiles (0 = never)
 
 	void load(const QSettings& settings) override;
 	void save(QSettings& settings) const override;
@@ -391,7 +391,10 @@ bool FormFeatures::readTemplate(QSharedPointer<rdf::FormFeatures> templateForm,
 	//QString loadXmlPath = rdf::PageXmlParser::imagePathToXmlPath(mTemplateName);
 	QString loadXmlPath = mTemplateName;
 	
+	// only table regions, cells & their text (regions & lines) are needed
+	// NOTE: keep text regions - otherwise lines become direct children of the cells
 	rdf::PageXmlParser parser;
+	parser.setTypeFilter({ rdf::Region::type_table_region, rdf::Region::type_table_cell, rdf::Region::type_text_region, rdf::Region::type_text_line });
 	if (!parser.read(loadXmlPath)) {
 		qWarning() << "could not read template from" << loadXmlPath;
 		return false;
@@ -1088,6 +1091,7 @@ QVector<QSharedPointer<rdf::TableCellRaw>> FormFeatures::createRawTableFromTempl
 void FormFeatures::createAssociationGraphNodes(QVector<QSharedPointer<rdf::TableCellRaw>> cellsR) {
 
 	//QVector<QSharedPointer<rdf::AssociationGraphNode>> nodes;
+	const double distThreshold = configSnapshot<FormFeaturesConfig>()->distThreshold();
 
 	qDebug() << "try to match cell lines of all cells: " << cellsR.size() << " for associaton graph nodes...";
 
@@ -1159,8 +1163,8 @@ void FormFeatures::createAssociationGraphNodes(QVector<QSharedPointer<rdf::Table
 				//else
 				//	mMinGraphSizeVer++;
 
-				d = d < config()->distThreshold() ? config()->distThreshold() : d; //search size is minimum width of the neighbouring cell
-				d = d == std::numeric_limits<double>::max() ? config()->distThreshold() : d;
+				d = d < distThreshold ? distThreshold : d; //search size is minimum width of the neighbouring cell
+				d = d == std::numeric_limits<double>::max() ? distThreshold : d;
 				l.translate(mOffset);
 
 				LineCandidates lC = findLineCandidates(l, d, horizontal);
@@ -1199,6 +1203,7 @@ void FormFeatures::createAssociationGraphNodes(QVector<QSharedPointer<rdf::Table
 
 void FormFeatures::createReducedAssociationGraphNodes(QVector<QSharedPointer<rdf::TableCellRaw>> cellsR) {
 
+	const double distThreshold = configSnapshot<FormFeaturesConfig>()->distThreshold();
 	rdf::Line line;
 	//find all horizontal nodes for the association graph
 	int tableRows = mRegion->rows();
@@ -1246,8 +1251,8 @@ void FormFeatures::createReducedAssociationGraphNodes(QVector<QSharedPointer<rdf
 			//createAssociationGraphNode
 			if (!idxUpper.isEmpty()) {
 				double d = findMinWidth(cellsR, idxUpper[0], AssociationGraphNode::LinePosition::pos_top);
-				d = d < config()->distThreshold() ? config()->distThreshold() : d; //search size is minimum width of the neighbouring cell
-				d = d == std::numeric_limits<double>::max() ? config()->distThreshold() : d;
+				d = d < distThreshold ? distThreshold : d; //search size is minimum width of the neighbouring cell
+				d = d == std::numeric_limits<double>::max() ? distThreshold : d;
 				tmpU.translate(mOffset);
 
 				LineCandidates lC = findLineCandidates(tmpU, d, true);
@@ -1305,8 +1310,8 @@ void FormFeatures::createReducedAssociationGraphNodes(QVector<QSharedPointer<rdf
 				//createAssociationGraphNode
 				if (!idx.isEmpty()) {
 					double d = findMinWidth(cellsR, idx[0], AssociationGraphNode::LinePosition::pos_bottom);
-					d = d < config()->distThreshold() ? config()->distThreshold() : d; //search size is minimum width of the neighbouring cell
-					d = d == std::numeric_limits<double>::max() ? config()->distThreshold() : d;
+					d = d < distThreshold ? distThreshold : d; //search size is minimum width of the neighbouring cell
+					d = d == std::numeric_limits<double>::max() ? distThreshold : d;
 					tmpL.translate(mOffset);
 
 					LineCandidates lC = findLineCandidates(tmpL, d, true);
@@ -1371,8 +1376,8 @@ void FormFeatures::createReducedAssociationGraphNodes(QVector<QSharedPointer<rdf
 			//createAssociationGraphNode
 			if (!idxUpper.isEmpty()) {
 				double d = findMinWidth(cellsR, idxUpper[0], AssociationGraphNode::LinePosition::pos_left);
-				d = d < config()->distThreshold() ? config()->distThreshold() : d; //search size is minimum width of the neighbouring cell
-				d = d == std::numeric_limits<double>::max() ? config()->distThreshold() : d;
+				d = d < distThreshold ? distThreshold : d; //search size is minimum width of the neighbouring cell
+				d = d == std::numeric_limits<double>::max() ? distThreshold : d;
 				tmpU.translate(mOffset);
 
 				LineCandidates lC = findLineCandidates(tmpU, d, false);
@@ -1429,8 +1434,8 @@ void FormFeatures::createReducedAssociationGraphNodes(QVector<QSharedPointer<rdf
 				//createAssociationGraphNode
 				if (!idx.isEmpty()) {
 					double d = findMinWidth(cellsR, idx[0], AssociationGraphNode::LinePosition::pos_right);
-					d = d < config()->distThreshold() ? config()->distThreshold() : d; //search size is minimum width of the neighbouring cell
-					d = d == std::numeric_limits<double>::max() ? config()->distThreshold() : d;
+					d = d < distThreshold ? distThreshold : d; //search size is minimum width of the neighbouring cell
+					d = d == std::numeric_limits<double>::max() ? distThreshold : d;
 					tmpL.translate(mOffset);
 
 					LineCandidates lC = findLineCandidates(tmpL, d, false);
@@ -1519,12 +1524,18 @@ QVector<QSharedPointer<rdf::AssociationGraphNode>> FormFeatures::mergeColinearNo
 
 void FormFeatures::createAssociationGraph() {
 
+	// resolve the thresholds once - testAdjacency is called for all node pairs
+	QSharedPointer<const FormFeaturesConfig> cfg = configSnapshot<FormFeaturesConfig>();
+	const double coLinearityThr = cfg->coLinearityThr();
+	const double variationThrLower = cfg->variationThrLower();
+	const double variationThrUpper = cfg->variationThrUpper();
+
 	//create graph for vertical lines
 	for (int currentNodeIdx = 0; currentNodeIdx < mANodesVertical.size(); currentNodeIdx++) {
 		for (int compareNodeIdx = currentNodeIdx + 1; compareNodeIdx < mANodesVertical.size(); compareNodeIdx++) {
 
 			//test if nodes can be associated
-			if (mANodesVertical[currentNodeIdx]->testAdjacency(mANodesVertical[compareNodeIdx], config()->coLinearityThr(), config()->variationThrLower(), config()->variationThrUpper())) {
+			if (mANodesVertical[currentNodeIdx]->testAdjacency(mANodesVertical[compareNodeIdx], coLinearityThr, variationThrLower, variationThrUpper)) {
 				mANodesVertical[currentNodeIdx]->addAdjacencyNode(compareNodeIdx);
 				mANodesVertical[compareNodeIdx]->addAdjacencyNode(currentNodeIdx);
 			}
@@ -1536,7 +1547,7 @@ void FormFeatures::createAssociationGraph() {
 		for (int compareNodeIdx = currentNodeIdx + 1; compareNodeIdx < mANodesHorizontal.size(); compareNodeIdx++) {
 
 			//test if nodes can be associated
-			if (mANodesHorizontal[currentNodeIdx]->testAdjacency(mANodesHorizontal[compareNodeIdx], config()->coLinearityThr(), config()->variationThrLower(), config()->variationThrUpper())) {
+			if (mANodesHorizontal[currentNodeIdx]->testAdjacency(mANodesHorizontal[compareNodeIdx], coLinearityThr, variationThrLower, variationThrUpper)) {
 				mANodesHorizontal[currentNodeIdx]->addAdjacencyNode(compareNodeIdx);
 				mANodesHorizontal[compareNodeIdx]->addAdjacencyNode(currentNodeIdx);
 			}
@@ -3147,7 +3158,7 @@ cv::Size FormFeatures::sizeImg() const
 	}
 
 	QSharedPointer<FormFeaturesConfig> FormFeatures::config() const	{
-		return qSharedPointerDynamicCast<FormFeaturesConfig>(mConfig);
+		return castConfig<FormFeaturesConfig>();
 	}
 
 	void FormFeatures::setConfig(QSharedPointer<FormFeaturesConfig> c) 	{
@@ -3816,6 +3827,7 @@ cv::Size FormFeatures::sizeImg() const
 		QString loadXmlPath = templateName;
 
 		rdf::PageXmlParser parser;
+		parser.setTypeFilter({ rdf::Region::type_table_region, rdf::Region::type_table_cell });
 		if (!parser.read(loadXmlPath)) {
 			qWarning() << "could not read template from" << loadXmlPath;
 			return false;
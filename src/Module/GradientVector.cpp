@@ -169,7 +169,7 @@ namespace rdf {
 	}
 
 	QSharedPointer<GradientVectorConfig> GradientVector::config() const	{
-		return qSharedPointerDynamicCast<GradientVectorConfig>(mConfig);
+		return castConfig<GradientVectorConfig>();
 	}
 
 	QString GradientVector::toString() const {
@@ -35,10 +35,15 @@
 // read includes
 #include "Image.h"
 #include "ImageProcessor.h"
+#include "Utils.h"
 
 #pragma warning(push, 0)	// no warnings from includes
 
 #include <QPainter>
+#include <QAtomicInt>
+#include <QSet>
+
+#include <algorithm>
 
 //#pragma warning(disable: 4706)
 #include "GCGraph.hpp"
@@ -60,23 +65,104 @@ int GraphCutConfig::numIter() const {
 	return mGcIter;
 }
 
+void GraphCutConfig::setParallelSwap(bool parallel) {
+	mParallelSwap = parallel;
+}
+
+bool GraphCutConfig::parallelSwap() const {
+	return mParallelSwap;
+}
+
 void GraphCutConfig::load(const QSettings & settings) {
 
 	mGcIter = settings.value("numIter", mGcIter).toInt();
 	mScaleFactor = settings.value("scaleFactor", mScaleFactor).toDouble();
+	mParallelSwap = settings.value("parallelSwap", mParallelSwap).toBool();
 }
 
 void GraphCutConfig::save(QSettings & settings) const {
 	settings.setValue("numIter", mGcIter);
 	settings.setValue("scaleFactor", mScaleFactor);
+	settings.setValue("parallelSwap", mParallelSwap);
+}
+
+// GraphCutContext --------------------------------------------------------------------
+/// <summary>
+/// The node/arc arena that is shared by all moves.
+/// </summary>
+class GraphCutContext::EnergyArena : public GCoptimization::EnergyT {
+
+public:
+	EnergyArena(int numVars) : GCoptimization::EnergyT(numVars, 0, GCoptimization::handleError) {}
+};
+
+GraphCutContext::GraphCutContext() {
+}
+
+/// <summary>
+/// Lets the graph-cut build all moves in this context's arena.
+/// The context must outlive the graph-cut's optimization.
+/// Attached graph-cuts share one arena, so they must not
+/// run concurrently (this function is not thread-safe either).
+/// </summary>
+/// <param name="gc">The graph-cut.</param>
+void GraphCutContext::attach(GCoptimization & gc) {
+
+	// the first graph-cut sizes the arena (it grows with the first move)
+	if (mArenas.isEmpty())
+		mArenas << QSharedPointer<EnergyArena>(new EnergyArena(gc.numSites()));
+
+	gc.setEnergyArena(mArenas[0].data());
+	mNumGraphCuts++;
+}
+
+/// <summary>
+/// Returns the arena with index idx.
+/// Concurrent moves need one arena each.
+/// Arenas are created on demand - so this function is not thread-safe.
+/// </summary>
+/// <param name="idx">The arena index.</param>
+GraphCutContext::EnergyArena* GraphCutContext::arena(int idx) {
+
+	while (mArenas.size() <= idx)
+		mArenas << QSharedPointer<EnergyArena>(new EnergyArena(0));
+
+	return mArenas[idx].data();
+}
+
+/// <summary>
+/// Returns the number of graph-cuts that used this context.
+/// </summary>
+int GraphCutContext::numGraphCuts() const {
+	return mNumGraphCuts;
+}
+
+/// <summary>
+/// Returns the number of heap allocations of the arena.
+/// If the arena is sized properly, this number does not
+/// increase with subsequent moves or graph-cuts.
+/// </summary>
+int GraphCutContext::numAllocations() const {
+
+	int numAllocs = 0;
+	for (const QSharedPointer<EnergyArena>& a : mArenas)
+		numAllocs += a->get_alloc_num();
+
+	return numAllocs;
+}
+
+QString GraphCutContext::toString() const {
+	return QString("graph-cut context: %1 graph-cuts, %2 allocations").arg(numGraphCuts()).arg(numAllocations());
 }
 
 // GraphCutPixel --------------------------------------------------------------------
 GraphCutPixel::GraphCutPixel(const PixelSet & set) : mSet(set) {
 	mWeightFnc = PixelDistance::spacingWeighted;
 	mConnector = QSharedPointer<DelaunayPixelConnector>::create();
+	mContext = QSharedPointer<GraphCutContext>::create();
 
 	mConfig = QSharedPointer<GraphCutConfig>::create();
+	mConfig->loadSettings();
 }
 
 bool GraphCutPixel::isEmpty() const {
@@ -87,10 +173,32 @@ QSharedPointer<GraphCutConfig> GraphCutPixel::config() const {
 	return qSharedPointerCast<GraphCutConfig>(mConfig);
 }
 
+/// <summary>
+/// Sets the graph-cut context.
+/// Pass the same context to subsequent graph-cuts
+/// to reuse their node/arc memory.
+/// </summary>
+/// <param name="context">The context.</param>
+void GraphCutPixel::setContext(const QSharedPointer<GraphCutContext>& context) {
+	mContext = context;
+}
+
+QSharedPointer<GraphCutContext> GraphCutPixel::context() const {
+	return mContext;
+}
+
 PixelSet GraphCutPixel::set() const {
 	return mSet;
 }
 
+/// <summary>
+/// Returns the energy of the final labeling.
+/// </summary>
+/// <returns>The energy or -1 if the graph-cut was not computed.</returns>
+double GraphCutPixel::energy() const {
+	return mEnergy;
+}
+
 QSharedPointer<GCoptimizationGeneralGraph> GraphCutPixel::graphCut(const PixelGraph & graph) const {
 
 	if (graph.isEmpty()) {
@@ -109,9 +217,40 @@ QSharedPointer<GCoptimizationGeneralGraph> GraphCutPixel::graphCut(const PixelGr
 	QSharedPointer<GCoptimizationGeneralGraph> gc(new GCoptimizationGeneralGraph(pixel.size(), nLabels));
 	gc->setDataCost(c.ptr<int>());
 	gc->setSmoothCost(sm.ptr<int>());
+	mContext->attach(*gc);
 	
 	// create neighbors
+	setNeighbors(*gc, graph);
+
+	//Image::imageInfo(c, "cost");
+	//Image::imageInfo(sm, "labelDist");
+
+	// run the swap-move
+	try {
+		//gc->expansion(config()->numIter());
+		swap(*gc);
+	}
+	catch (GCException gce) {
+
+		mWarning << "exception while performing graph-cut";
+		mWarning << QString::fromUtf8(gce.message);
+		return QSharedPointer<GCoptimizationGeneralGraph>();
+	}
+	
+	return gc;
+}
+
+/// <summary>
+/// Adds the graph's edges (weighted by mWeightFnc) to the graph-cut.
+/// </summary>
+/// <param name="gc">The graph-cut.</param>
+/// <param name="graph">The pixel graph.</param>
+void GraphCutPixel::setNeighbors(GCoptimizationGeneralGraph& gc, const PixelGraph & graph) const {
+
+	QVector<QSharedPointer<Pixel> > pixel = graph.set().pixels();
 	const QVector<QSharedPointer<PixelEdge> >& edges = graph.edges();
+	const double scaleFactor = config()->scaleFactor();
+
 	for (int idx = 0; idx < pixel.size(); idx++) {
 
 		for (int edgeIdx : graph.edgeIndexes(pixel.at(idx)->id())) {
@@ -124,30 +263,159 @@ QSharedPointer<GCoptimizationGeneralGraph> GraphCutPixel::graphCut(const PixelGr
 
 			// compute weight
 			double rawWeight = mWeightFnc(pe.data());
-			int w = qRound(rawWeight * config()->scaleFactor());
+			int w = qRound(rawWeight * scaleFactor);
 
-			gc->setNeighbors(idx, sVtxIdx, w);
+			gc.setNeighbors(idx, sVtxIdx, w);
 		}
 	}
+}
 
-	//Image::imageInfo(c, "cost");
-	//Image::imageInfo(sm, "labelDist");
+/// <summary>
+/// Groups label pairs into rounds in which no label is used twice.
+/// The swap moves of a round work on disjoint sites.
+/// </summary>
+/// <param name="labelPairs">The label pairs.</param>
+/// <returns>The rounds (in the order of labelPairs).</returns>
+static QVector<QVector<QPair<int, int> > > disjointLabelRounds(const QVector<QPair<int, int> >& labelPairs) {
 
-	// run the expansion-move
-	try {
-		//qDebug() << "energy before:" << gc->compute_energy();
-		//gc->expansion(config()->numIter());
-		gc->swap(config()->numIter());
-		//qDebug() << "energy after:" << gc->compute_energy();
+	QVector<QVector<QPair<int, int> > > rounds;
+	QVector<QSet<int> > roundLabels;
+
+	for (const QPair<int, int>& lp : labelPairs) {
+
+		int rIdx = 0;
+		for (; rIdx < rounds.size(); rIdx++) {
+			if (!roundLabels[rIdx].contains(lp.first) && !roundLabels[rIdx].contains(lp.second))
+				break;
+		}
+
+		if (rIdx == rounds.size()) {
+			rounds << QVector<QPair<int, int> >();
+			roundLabels << QSet<int>();
+		}
+
+		rounds[rIdx] << lp;
+		roundLabels[rIdx] << lp.first << lp.second;
 	}
-	catch (GCException gce) {
 
-		mWarning << "exception while performing graph-cut";
-		mWarning << QString::fromUtf8(gce.message);
-		return QSharedPointer<GCoptimizationGeneralGraph>();
+	return rounds;
+}
+
+/// <summary>
+/// Runs swap cycles until the energy does not decrease anymore
+/// or config()->numIter() cycles are reached. The energy is reported
+/// after each cycle.
+/// If config()->parallelSwap() is set, the label pairs are grouped into
+/// rounds of disjoint pairs whose moves are solved concurrently. Their
+/// new labels are applied at the end of the round. If this increases the
+/// energy (neighboring sites changed in different moves), the round is
+/// undone and its moves are performed sequentially. The energy is
+/// reported after each round, too.
+/// Throws a GCException if the graph-cut fails.
+/// </summary>
+/// <param name="gc">The graph-cut.</param>
+/// <param name="labelPairs">The label pairs to swap (all pairs if empty).</param>
+void GraphCutPixel::swap(GCoptimizationGeneralGraph & gc, const QVector<QPair<int, int> >& labelPairs) const {
+
+	bool parallel = config()->parallelSwap();
+	QVector<QPair<int, int> > pairs = labelPairs;
+
+	// same order as GCoptimization::swap
+	if (pairs.isEmpty()) {
+		for (int l1 = 0; l1 < gc.numLabels(); l1++) {
+			for (int l2 = gc.numLabels() - 1; l2 > l1; l2--)
+				pairs << QPair<int, int>(l1, l2);
+		}
+	}
+
+	QVector<QVector<QPair<int, int> > > rounds;
+	QVector<int> labels(gc.numSites());
+	QVector<int> newLabels;
+
+	if (parallel) {
+		rounds = disjointLabelRounds(pairs);
+		gc.prepare_deferred_swap();
+	}
+
+	GCoptimization::EnergyType energy = gc.compute_energy();
+
+	for (int cIdx = 0; cIdx < config()->numIter(); cIdx++) {
+
+		int numFallbacks = 0;
+
+		if (!parallel && labelPairs.isEmpty()) {
+			gc.swap(1);
+		}
+		else if (!parallel) {
+			for (const QPair<int, int>& lp : pairs)
+				gc.alpha_beta_swap(lp.first, lp.second);
+		}
+		else {
+
+			for (int rIdx = 0; rIdx < rounds.size(); rIdx++) {
+
+				const QVector<QPair<int, int> >& r = rounds[rIdx];
+
+				if (r.size() == 1) {
+					gc.alpha_beta_swap(r[0].first, r[0].second);
+					continue;
+				}
+
+				GCoptimization::EnergyType roundEnergy = gc.compute_energy();
+				gc.whatLabel(0, labels.size(), labels.data());
+				newLabels = labels;
+
+				// the arenas must exist before the moves run concurrently
+				QVector<GCoptimization::EnergyT*> arenas;
+				for (int idx = 0; idx < r.size(); idx++)
+					arenas << mContext->arena(idx + 1);
+
+				QVector<const char*> errors(r.size(), 0);
+
+				Utils::parallelFor(r.size(), [&](int idx) {
+
+					try {
+						gc.alpha_beta_swap_deferred(r[idx].first, r[idx].second, arenas[idx], newLabels.data());
+					}
+					catch (GCException gce) {
+						errors[idx] = gce.message;
+					}
+				});
+
+				for (const char* msg : errors) {
+					if (msg)
+						throw GCException(msg);
+				}
+
+				gc.setLabeling(newLabels.data());
+				GCoptimization::EnergyType parallelEnergy = gc.compute_energy();
+
+				if (parallelEnergy > roundEnergy) {
+
+					gc.setLabeling(labels.data());
+					for (const QPair<int, int>& lp : r)
+						gc.alpha_beta_swap(lp.first, lp.second);
+
+					numFallbacks++;
+					mDebug << "swap round" << rIdx << "energy:" << roundEnergy << "->" << parallelEnergy << "undone," << gc.compute_energy() << "sequential";
+				}
+				else
+					mDebug << "swap round" << rIdx << "energy:" << roundEnergy << "->" << parallelEnergy;
+			}
+		}
+
+		GCoptimization::EnergyType newEnergy = gc.compute_energy();
+
+		if (parallel)
+			mDebug << "swap cycle" << cIdx << "energy:" << energy << "->" << newEnergy << "in" << rounds.size() << "rounds," << numFallbacks << "sequential";
+		else
+			mDebug << "swap cycle" << cIdx << "energy:" << energy << "->" << newEnergy;
+
+		if (newEnergy >= energy)
+			break;
+
+		energy = newEnergy;
 	}
-	
-	return gc;
 }
 
 int GraphCutPixel::numLabels() const {
@@ -183,6 +451,7 @@ bool GraphCutOrientation::compute() {
 	auto gc = graphCut(graph);
 
 	if (gc) {
+		mEnergy = (double)gc->compute_energy();
 		QVector<QSharedPointer<Pixel> > pixel = graph.set().pixels();
 		for (int idx = 0; idx < pixel.size(); idx++) {
 
@@ -299,6 +568,7 @@ bool GraphCutPixelLabel::compute() {
 	auto gc = graphCut(graph);
 
 	if (gc) {
+		mEnergy = (double)gc->compute_energy();
 		QVector<QSharedPointer<Pixel> > pixel = graph.set().pixels();
 		for (int idx = 0; idx < pixel.size(); idx++) {
 
@@ -393,13 +663,84 @@ int GraphCutPixelLabel::numLabels() const {
 	return mManager.size();
 }
 
+// GraphCutTextLineConfig --------------------------------------------------------------------
+GraphCutTextLineConfig::GraphCutTextLineConfig() : GraphCutConfig("Text Line Graph-Cut") {
+}
+
+/// <summary>
+/// Restricts each pixel to its numCandidates nearest text lines.
+/// This sparse graph-cut scales to pages with many text lines,
+/// but pixels cannot move to lines outside their candidates.
+/// Hence, it is disabled by default (0 = dense graph-cut).
+/// </summary>
+/// <param name="numCandidates">The number of candidate text lines per pixel.</param>
+void GraphCutTextLineConfig::setNumCandidates(int numCandidates) {
+	mNumCandidates = numCandidates;
+}
+
+int GraphCutTextLineConfig::numCandidates() const {
+	return ModuleConfig::checkParam(mNumCandidates, 0, INT_MAX, "numCandidates");
+}
+
+void GraphCutTextLineConfig::load(const QSettings & settings) {
+
+	GraphCutConfig::load(settings);
+	mNumCandidates = settings.value("numCandidates", numCandidates()).toInt();
+}
+
+void GraphCutTextLineConfig::save(QSettings & settings) const {
+
+	GraphCutConfig::save(settings);
+	settings.setValue("numCandidates", numCandidates());
+}
+
+/// <summary>
+/// Mahalanobis distance to a text line.
+/// The 2x2 inverse covariance is stored as scalars
+/// so that distances are computed in closed form.
+/// </summary>
+class MahalanobisModel {
+
+public:
+	MahalanobisModel() {}
+	MahalanobisModel(const Vector2D& center, const cv::Mat& cov) : mCenter(center) {
+
+		cv::Mat icov;
+		cv::invert(cov, icov, cv::DECOMP_SVD);
+
+		mA = icov.at<double>(0, 0);
+		mB = icov.at<double>(0, 1) + icov.at<double>(1, 0);
+		mC = icov.at<double>(1, 1);
+	}
+
+	double dist(const Vector2D& pt) const {
+
+		double dx = pt.x() - mCenter.x();
+		double dy = pt.y() - mCenter.y();
+
+		return std::sqrt(qMax(mA*dx*dx + mB*dx*dy + mC*dy*dy, 0.0));
+	}
+
+private:
+	Vector2D mCenter;
+	double mA = 0.0;
+	double mB = 0.0;	// both off-diagonal elements
+	double mC = 0.0;
+};
+
 // GraphCutTextLine --------------------------------------------------------------------
 GraphCutTextLine::GraphCutTextLine(const QVector<PixelSet>& sets) : GraphCutPixel(PixelSet::merge(sets)) {
 	mWeightFnc = PixelDistance::orientationWeighted;
-	
+	mConfig = QSharedPointer<GraphCutTextLineConfig>::create();
+	mConfig->loadSettings();
+
 	mTextLines = sets;
 }
 
+QSharedPointer<GraphCutTextLineConfig> GraphCutTextLine::config() const {
+	return qSharedPointerCast<GraphCutTextLineConfig>(mConfig);
+}
+
 bool GraphCutTextLine::compute() {
 	
 	if (!checkInput())
@@ -427,11 +768,14 @@ bool GraphCutTextLine::compute() {
 	// create graph & perform energy minimization
 	PixelGraph graph(mSet);
 	graph.connect(*mConnector);
-	auto gc = graphCut(graph);
+
+	int nc = config()->numCandidates();
+	auto gc = (nc > 0 && nc < numLabels()) ? sparseGraphCut(graph, nc) : graphCut(graph);
 
 	int ntl = mTextLines.size();
 
 	if (gc) {
+		mEnergy = (double)gc->compute_energy();
 
 		// convert gc labels to text lines
 		QMap<int, PixelSet> tlMap;
@@ -539,24 +883,20 @@ cv::Mat GraphCutTextLine::labelDistMatrix(int numLabels) const {
 
 	cv::Mat labelDist(numLabels, numLabels, CV_32FC1);
 
+	QVector<Vector2D> centers;
+	for (const PixelSet& tl : mTextLines)
+		centers << tl.center();
+
 	for (int rIdx = 0; rIdx < numLabels; rIdx++) {
 
 		float* lp = labelDist.ptr<float>(rIdx);
-		cv::Mat icov = mTextLines[rIdx].fitEllipse().toCov();
-		icov = icov.mul(icov);	// square the covariance - to prefer 'horizontally' aligned text lines
-		cv::invert(icov, icov, cv::DECOMP_SVD);
-
-		for (int cIdx = 0; cIdx < numLabels; cIdx++) {
-
-			// compute the mahalnobis distance
-			Vector2D vec(mTextLines[rIdx].center() - mTextLines[cIdx].center());
-			cv::Mat nm = vec.toMatCol();
-			nm = nm*icov*nm.t();
+		cv::Mat cov = mTextLines[rIdx].fitEllipse().toCov();
+		cov = cov.mul(cov);	// square the covariance - to prefer 'horizontally' aligned text lines
+		MahalanobisModel mm(centers[rIdx], cov);
 
-			double d = std::sqrt(nm.at<double>(0, 0));
-
-			lp[cIdx] = (float)d;
-		}
+		// compute the mahalnobis distance
+		for (int cIdx = 0; cIdx < numLabels; cIdx++)
+			lp[cIdx] = (float)mm.dist(centers[cIdx]);
 	}
 
 	cv::Mat labelIdx;
@@ -597,27 +937,109 @@ int GraphCutTextLine::numLabels() const {
 	return mTextLines.size();
 }
 
+/// <summary>
+/// Graph-cut with sparse data costs.
+/// Each pixel can only be assigned to its numCandidates nearest
+/// text lines (Mahalanobis distance). The swap moves are restricted to
+/// label pairs that are both candidates of at least one pixel.
+/// </summary>
+/// <param name="graph">The pixel graph.</param>
+/// <param name="numCandidates">The number of candidate text lines per pixel.</param>
+/// <returns>The optimized graph-cut or an empty pointer on failure.</returns>
+QSharedPointer<GCoptimizationGeneralGraph> GraphCutTextLine::sparseGraphCut(const PixelGraph & graph, int numCandidates) const {
+
+	if (graph.isEmpty())
+		return QSharedPointer<GCoptimizationGeneralGraph>();
+
+	int nLabels = numLabels();
+	QVector<QSharedPointer<Pixel> > pixel = graph.set().pixels();
+
+	QVector<MahalanobisModel> models;
+	for (const PixelSet& tl : mTextLines)
+		models << MahalanobisModel(tl.center(), tl.fitEllipse().toCov());
+
+	// find the candidates (sites are added in increasing order)
+	QVector<QVector<GCoptimization::SparseDataCost> > dataCosts(nLabels);
+	QVector<int> initLabels(pixel.size());
+	QVector<QPair<int, int> > labelPairs;
+
+	QVector<QPair<double, int> > dists(nLabels);
+
+	for (int idx = 0; idx < pixel.size(); idx++) {
+
+		const Vector2D c = pixel[idx]->center();
+
+		for (int lIdx = 0; lIdx < nLabels; lIdx++)
+			dists[lIdx] = QPair<double, int>(models[lIdx].dist(c), lIdx);
+
+		std::partial_sort(dists.begin(), dists.begin() + numCandidates, dists.end());
+
+		for (int cIdx = 0; cIdx < numCandidates; cIdx++) {
+
+			GCoptimization::SparseDataCost sdc;
+			sdc.site = idx;
+			sdc.cost = (int)qMin(dists[cIdx].first * 5000.0, GCO_MAX_ENERGYTERM - 1.0);
+			dataCosts[dists[cIdx].second] << sdc;
+
+			for (int pIdx = cIdx + 1; pIdx < numCandidates; pIdx++) {
+				int l1 = dists[cIdx].second;
+				int l2 = dists[pIdx].second;
+				labelPairs << QPair<int, int>(qMin(l1, l2), qMax(l1, l2));
+			}
+		}
+
+		initLabels[idx] = dists[0].second;
+	}
+
+	std::sort(labelPairs.begin(), labelPairs.end());
+	labelPairs.erase(std::unique(labelPairs.begin(), labelPairs.end()), labelPairs.end());
+
+	cv::Mat sm = labelDistMatrix(nLabels);	// #labels x #labels
+
+	// init the graph
+	QSharedPointer<GCoptimizationGeneralGraph> gc(new GCoptimizationGeneralGraph(pixel.size(), nLabels));
+
+	for (int lIdx = 0; lIdx < nLabels; lIdx++) {
+		if (!dataCosts[lIdx].isEmpty())
+			gc->setDataCost(lIdx, dataCosts[lIdx].data(), dataCosts[lIdx].size());
+	}
+
+	gc->setSmoothCost(sm.ptr<int>());
+	mContext->attach(*gc);
+	setNeighbors(*gc, graph);
+
+	// start with the nearest text line
+	for (int idx = 0; idx < pixel.size(); idx++)
+		gc->setLabel(idx, initLabels[idx]);
+
+	// run the swap on candidate label pairs
+	try {
+		if (!labelPairs.isEmpty())
+			swap(*gc, labelPairs);
+	}
+	catch (GCException gce) {
+
+		mWarning << "exception while performing graph-cut";
+		mWarning << QString::fromUtf8(gce.message);
+		return QSharedPointer<GCoptimizationGeneralGraph>();
+	}
+
+	return gc;
+}
+
 cv::Mat GraphCutTextLine::mahalanobisDists(const PixelSet & tl, const cv::Mat& centers) const {
 	
 	cv::Mat dists(centers.rows, 1, CV_64FC1);
 	double* dp = dists.ptr<double>();
 
 	// get the textlines mean & cov
-	cv::Mat c = tl.center().toMatCol();
-	cv::Mat icov = tl.fitEllipse().toCov();
-	//icov = icov.mul(icov);
-	cv::invert(icov, icov, cv::DECOMP_SVD);
-
-	//double mthr = 7.0;
+	MahalanobisModel mm(tl.center(), tl.fitEllipse().toCov());
 
 	for (int idx = 0; idx < centers.rows; idx++) {
 
 		// compute the mahalnobis distance
-		cv::Mat nm = centers.row(idx) - c;
-		nm = nm*icov*nm.t();
-
-		double d = std::sqrt(nm.at<double>(0, 0));
-		dp[idx] = d;// (d < mthr) ? d : mthr;
+		const double* cp = centers.ptr<double>(idx);
+		dp[idx] = mm.dist(Vector2D(cp[0], cp[1]));
 	}
 
 	return dists;
@@ -743,6 +1165,7 @@ void GraphCutTextLine::saveDistsDebug(const QString & filePath, const cv::Mat& i
 // GraphCutLineSpacing --------------------------------------------------------------------
 GraphCutLineSpacing::GraphCutLineSpacing(const PixelSet & set) : GraphCutPixel(set) {
 	mConfig = QSharedPointer<GraphCutLineSpacingConfig>::create();
+	mConfig->loadSettings();
 }
 
 bool GraphCutLineSpacing::checkInput() const {
@@ -771,6 +1194,7 @@ bool GraphCutLineSpacing::compute() {
 	auto gc = graphCut(graph);
 
 	if (gc) {
+		mEnergy = (double)gc->compute_energy();
 
 		QVector<QSharedPointer<Pixel> > pixel = graph.set().pixels();
 		for (int idx = 0; idx < pixel.size(); idx++) {
@@ -788,7 +1212,7 @@ bool GraphCutLineSpacing::compute() {
 }
 
 QSharedPointer<GraphCutLineSpacingConfig> GraphCutLineSpacing::config() const {
-	return qSharedPointerDynamicCast<GraphCutLineSpacingConfig>(mConfig);
+	return castConfig<GraphCutLineSpacingConfig>();
 }
 
 cv::Mat GraphCutLineSpacing::costs(int numLabels) const {
@@ -945,8 +1369,41 @@ void GraphCutLineSpacingConfig::save(QSettings & settings) const {
 }
 
 // GarphCutImage --------------------------------------------------------------------
+/// <summary>
+/// Data costs of the image graph-cut.
+/// It reads the compact CV_8UC1 costs (see GraphCutImage::convertData)
+/// and penalizes all labels but the fixed one for fixed pixels.
+/// </summary>
+class CompactDataCost : public GCoptimization::DataCostFunctor {
+
+public:
+	CompactDataCost(const cv::Mat& costs, const cv::Mat& fixedLabels, int numLabels) :
+		mCosts(costs.ptr<unsigned char>()),
+		mFixed(fixedLabels.empty() ? 0 : fixedLabels.ptr<unsigned char>()),
+		mNumLabels(numLabels) {}
+
+	GCoptimization::EnergyTermType compute(GCoptimization::SiteID s, GCoptimization::LabelID l) override {
+
+		if (mFixed && mFixed[s] != label_free && mFixed[s] != l)
+			return fixed_penalty;
+
+		return mCosts[s*mNumLabels + l];
+	}
+
+	enum {
+		label_free = 255,
+		fixed_penalty = 1000,	// >> max data cost (10)
+	};
+
+private:
+	const unsigned char* mCosts;
+	const unsigned char* mFixed;
+	int mNumLabels;
+};
+
 GraphCutImage::GraphCutImage(const QVector<cv::Mat> & src) : mImgs(src) {
 
+	mContext = QSharedPointer<GraphCutContext>::create();
 	mConfig = QSharedPointer<GraphCutConfig>::create();
 }
 
@@ -960,57 +1417,90 @@ QSharedPointer<GraphCutConfig> GraphCutImage::config() const {
 	return qSharedPointerCast<GraphCutConfig>(mConfig);
 }
 
+/// <summary>
+/// Sets the graph-cut context.
+/// Pass the same context to subsequent graph-cuts
+/// to reuse their node/arc memory.
+/// </summary>
+/// <param name="context">The context.</param>
+void GraphCutImage::setContext(const QSharedPointer<GraphCutContext>& context) {
+	mContext = context;
+}
+
+QSharedPointer<GraphCutContext> GraphCutImage::context() const {
+	return mContext;
+}
+
 cv::Mat GraphCutImage::image() const {
 	
 	return mLabelImg;
 }
 
-QSharedPointer<GCoptimizationGridGraph> GraphCutImage::graphCut(const QVector<cv::Mat>& src) const {
+cv::Mat GraphCutImage::graphCut(const QVector<cv::Mat>& src, const cv::Mat& fixedLabels, GraphCutContext* context) const {
 
 	if (src.empty()) {
-		return QSharedPointer<GCoptimizationGridGraph>();
+		return cv::Mat();
 	}
 
+	assert(fixedLabels.empty() || (fixedLabels.size() == src[0].size() && fixedLabels.isContinuous()));
+
 	cv::Mat data = convertData(src);
 
 	int nLabels = numLabels();
 
 	// get costs and smoothness term
 	cv::Mat sm = labelDistMatrix(nLabels);	// #labels x #labels
+	CompactDataCost dataCost(data, fixedLabels, nLabels);
 
 	// init the graph
-	QSharedPointer<GCoptimizationGridGraph> gc(new GCoptimizationGridGraph(size().height(), size().width(), nLabels));
-	gc->setDataCost(data.ptr<int>());
-	gc->setSmoothCost(sm.ptr<int>());
+	GCoptimizationGridGraph gc(src[0].cols, src[0].rows, nLabels);
+	gc.setDataCostFunctor(&dataCost);
+	gc.setSmoothCost(sm.ptr<int>());
+
+	if (context)
+		context->attach(gc);
+	else
+		mContext->attach(gc);
 
 	// run the expansion-move
 	try {
-		qDebug() << "energy before:" << gc->compute_energy();
-		gc->expansion(config()->numIter());
+		gc.expansion(config()->numIter());
 		//gc->swap(config()->numIter());
-		qDebug() << "energy after:" << gc->compute_energy();
 	}
 	catch (GCException gce) {
 
 		mWarning << "exception while performing graph-cut";
 		mWarning << QString::fromUtf8(gce.message);
-		return QSharedPointer<GCoptimizationGridGraph>();
+		return cv::Mat();
 	}
 
-	return gc;
+	cv::Mat labelImg(src[0].rows, src[0].cols, CV_8UC1);
+	unsigned char* lPtr = labelImg.ptr<unsigned char>();
+
+	for (int idx = 0; idx < labelImg.rows*labelImg.cols; idx++)
+		lPtr[idx] = (unsigned char)gc.whatLabel(idx);
+
+	return labelImg;
 }
 
 int GraphCutImage::numLabels() const {
 	return 0;
 }
 
+/// <summary>
+/// Converts the probability maps to data costs.
+/// The costs are kept as CV_8UC1 (they are in [0 10])
+/// which needs 1/4 of the memory of int costs.
+/// src may be ROIs of larger images.
+/// </summary>
+/// <param name="src">The probability maps.</param>
+/// <returns>A (#pixels x #labels) CV_8UC1 cost matrix.</returns>
 cv::Mat GraphCutImage::convertData(const QVector<cv::Mat>& src) const {
 
 	int nL = numLabels();
-	int numPixels = src[0].rows*src[0].cols;
-	int length = numPixels * nL;
-	cv::Mat data(1, length, CV_8UC1);
-	unsigned char* dPtr = data.ptr<unsigned char>();
+	int rows = src[0].rows;
+	int cols = src[0].cols;
+	cv::Mat data(rows*cols, nL, CV_8UC1);
 
 	// max value - indicates the 'dynamic range'
 	double maxVal = 10;
@@ -1019,16 +1509,17 @@ cv::Mat GraphCutImage::convertData(const QVector<cv::Mat>& src) const {
 	// [l0p0 l1p0 l2p0 l0p1 l1p1 l2p1 ...] with li (i = 0 ... numLabels()) and pj (j = 0 ... numPixels)
 	for (int lIdx = 0; lIdx < src.size(); lIdx++) {
 
-		const float* sPtr = src[lIdx].ptr<float>();
+		for (int rIdx = 0; rIdx < rows; rIdx++) {
 
-		for (int pIdx = 0; pIdx < numPixels; pIdx++) {
+			const float* sPtr = src[lIdx].ptr<float>(rIdx);
+			unsigned char* dPtr = data.ptr<unsigned char>(rIdx*cols);
 
-			dPtr[(pIdx*nL) + lIdx] = (unsigned char)qRound(maxVal - (sPtr[pIdx] * maxVal));
+			for (int cIdx = 0; cIdx < cols; cIdx++) {
+				dPtr[(cIdx*nL) + lIdx] = (unsigned char)qRound(maxVal - (sPtr[cIdx] * maxVal));
+			}
 		}
 	}
 
-	data.convertTo(data, CV_32SC1);
-
 	return data;
 }
 
@@ -1040,9 +1531,51 @@ QSize GraphCutImage::size() const {
 	return QSize(mImgs[0].rows, mImgs[0].cols);
 }
 
+// -------------------------------------------------------------------- DeepCutConfig 
+DeepCutConfig::DeepCutConfig() : GraphCutConfig("Deep Cut") {
+}
+
+/// <summary>
+/// Images larger than tileSize are optimized in tiles (in parallel).
+/// Tiling is disabled by default (tileSize = 0) since the stitched
+/// labels may differ from a global graph-cut close to the tile seams.
+/// </summary>
+/// <param name="tileSize">The tile size in pixels.</param>
+void DeepCutConfig::setTileSize(int tileSize) {
+	mTileSize = tileSize;
+}
+
+int DeepCutConfig::tileSize() const {
+	return ModuleConfig::checkParam(mTileSize, 0, INT_MAX, "tileSize");
+}
+
+void DeepCutConfig::setTileOverlap(int overlap) {
+	mTileOverlap = overlap;
+}
+
+int DeepCutConfig::tileOverlap() const {
+	return ModuleConfig::checkParam(mTileOverlap, 1, INT_MAX, "tileOverlap");
+}
+
+void DeepCutConfig::load(const QSettings & settings) {
+
+	GraphCutConfig::load(settings);
+	mTileSize = settings.value("tileSize", tileSize()).toInt();
+	mTileOverlap = settings.value("tileOverlap", tileOverlap()).toInt();
+}
+
+void DeepCutConfig::save(QSettings & settings) const {
+
+	GraphCutConfig::save(settings);
+	settings.setValue("tileSize", tileSize());
+	settings.setValue("tileOverlap", tileOverlap());
+}
+
 // -------------------------------------------------------------------- DeepCut 
 DeepCut::DeepCut(const QVector<cv::Mat>& src) : GraphCutImage(src) {
 
+	mConfig = QSharedPointer<DeepCutConfig>::create();
+	mConfig->loadSettings();
 }
 
 bool DeepCut::checkInput() const {
@@ -1056,25 +1589,150 @@ bool DeepCut::compute() {
 
 	Timer dt;
 
+	int ts = config()->tileSize();
+
 	// perform graphcut
-	auto gc = graphCut(mImgs);
+	if (ts <= 0 || (mImgs[0].rows <= ts && mImgs[0].cols <= ts))
+		mLabelImg = graphCut(mImgs);
+	else
+		mLabelImg = tiledGraphCut(ts, config()->tileOverlap());
 
-	if (gc) {
+	if (mLabelImg.empty())
+		return false;
+
+	Image::imageInfo(mLabelImg, "labelImg");
+
+	mInfo << "computed in" << dt;
+
+	return true;
+}
+
+QSharedPointer<DeepCutConfig> DeepCut::config() const {
+	return castConfig<DeepCutConfig>();
+}
+
+/// <summary>
+/// Optimizes the image in overlapping tiles (in parallel).
+/// The label image is then stitched along the tile seams.
+/// </summary>
+/// <param name="tileSize">Size of the tiles.</param>
+/// <param name="overlap">Context added to each tile.</param>
+/// <returns>The label image or an empty image if the graph-cut failed.</returns>
+cv::Mat DeepCut::tiledGraphCut(int tileSize, int overlap) const {
+
+	// seam strips must not overlap
+	overlap = qBound(1, overlap, tileSize / 4);
 
-		QSize s = size();
+	cv::Rect imgRect(cv::Point(), mImgs[0].size());
+	cv::Mat labelImg(imgRect.size(), CV_8UC1, cv::Scalar(0));
+
+	QVector<cv::Rect> tiles;
+	QVector<cv::Rect> vStrips;
+	QVector<cv::Rect> hStrips;
+
+	for (int y = 0; y < imgRect.height; y += tileSize) {
+
+		for (int x = 0; x < imgRect.width; x += tileSize)
+			tiles << (cv::Rect(x, y, tileSize, tileSize) & imgRect);
+
+		if (y > 0)
+			hStrips << (cv::Rect(0, y - overlap, imgRect.width, 2 * overlap) & imgRect);
+	}
 
-		mLabelImg = cv::Mat(size().width(), size().height(), CV_8UC1);
-		unsigned char* lPtr = mLabelImg.ptr<unsigned char>();
+	for (int x = tileSize; x < imgRect.width; x += tileSize)
+		vStrips << (cv::Rect(x - overlap, 0, 2 * overlap, imgRect.height) & imgRect);
 
-		for (int idx = 0; idx < s.width()*s.height(); idx++) {
+	QAtomicInt numFailed(0);
 
-			lPtr[idx] = (unsigned char)gc->whatLabel(idx);
+	// tiles are optimized concurrently - so each needs its own arena
+	QVector<QSharedPointer<GraphCutContext> > contexts;
+	for (int idx = 0; idx < tiles.size(); idx++)
+		contexts << QSharedPointer<GraphCutContext>::create();
+
+	Utils::parallelFor(tiles.size(), [&](int idx) {
+
+		const cv::Rect& tile = tiles[idx];
+		cv::Rect ctx(tile.x - overlap, tile.y - overlap, tile.width + 2 * overlap, tile.height + 2 * overlap);
+		ctx &= imgRect;
+
+		QVector<cv::Mat> src;
+		for (const cv::Mat& img : mImgs)
+			src << img(ctx);
+
+		cv::Mat tileLabels = graphCut(src, cv::Mat(), contexts[idx].data());
+
+		if (tileLabels.empty()) {
+			numFailed.ref();
+			return;
 		}
 
-		Image::imageInfo(mLabelImg, "labelImg");
+		// copy the tile without its context
+		tileLabels(cv::Rect(tile.tl() - ctx.tl(), tile.size())).copyTo(labelImg(tile));
+	});
+
+	if (numFailed.load() > 0) {
+		mWarning << numFailed.load() << "/" << tiles.size() << "tiles could not be optimized";
+		return cv::Mat();
 	}
 
-	mInfo << "computed in" << dt;
+	if (!stitchSeams(labelImg, vStrips, true) || !stitchSeams(labelImg, hStrips, false))
+		return cv::Mat();
+
+	return labelImg;
+}
+
+/// <summary>
+/// Optimizes strips along the tile seams.
+/// The strips' outer rows (horizontal) or columns (vertical)
+/// keep their labels so that they fit to the tiles.
+/// </summary>
+/// <param name="labelImg">The label image.</param>
+/// <param name="strips">Non-overlapping seam strips.</param>
+/// <param name="vertical">If true, the strips are vertical.</param>
+/// <returns>true if all strips were optimized.</returns>
+bool DeepCut::stitchSeams(cv::Mat& labelImg, const QVector<cv::Rect>& strips, bool vertical) const {
+
+	QAtomicInt numFailed(0);
+
+	// strips are optimized concurrently - so each needs its own arena
+	QVector<QSharedPointer<GraphCutContext> > contexts;
+	for (int idx = 0; idx < strips.size(); idx++)
+		contexts << QSharedPointer<GraphCutContext>::create();
+
+	Utils::parallelFor(strips.size(), [&](int idx) {
+
+		const cv::Rect& strip = strips[idx];
+
+		cv::Mat fixedLabels(strip.size(), CV_8UC1, cv::Scalar(CompactDataCost::label_free));
+		cv::Mat stripLabels = labelImg(strip);
+
+		if (vertical) {
+			stripLabels.col(0).copyTo(fixedLabels.col(0));
+			stripLabels.col(strip.width - 1).copyTo(fixedLabels.col(strip.width - 1));
+		}
+		else {
+			stripLabels.row(0).copyTo(fixedLabels.row(0));
+			stripLabels.row(strip.height - 1).copyTo(fixedLabels.row(strip.height - 1));
+		}
+
+		QVector<cv::Mat> src;
+		for (const cv::Mat& img : mImgs)
+			src << img(strip);
+
+		cv::Mat seamLabels = graphCut(src, fixedLabels, contexts[idx].data());
+
+		if (seamLabels.empty()) {
+			numFailed.ref();
+			return;
+		}
+
+		seamLabels.copyTo(stripLabels);
+	});
+
+	if (numFailed.load() > 0) {
+		mWarning << numFailed.load() << "/" << strips.size() << "seams could not be optimized";
+		return false;
+	}
 
 	return true;
 }
@@ -49,6 +49,7 @@
 #endif
 
 // Qt defines
+class GCoptimization;
 class GCoptimizationGeneralGraph;
 class GCoptimizationGridGraph;
 
@@ -65,12 +66,47 @@ public:
 	double scaleFactor() const;
 	int numIter() const;
 
+	void setParallelSwap(bool parallel);
+	bool parallelSwap() const;
+
 protected:
 	void load(const QSettings& settings) override;
 	void save(QSettings& settings) const override;
 
 	double mScaleFactor = 1000.0;	// scale factor to use (faster) int instead of double
 	int mGcIter = 2;				// # iterations of graph-cut (expansion)
+	bool mParallelSwap = false;		// if true, swap moves on disjoint label pairs run concurrently
+};
+
+/// <summary>
+/// Reusable memory for graph-cuts.
+/// All alpha-expansion/swap moves of the attached graph-cuts build
+/// their binary graphs in one node/arc arena. The arena is sized by
+/// the first graph-cut, only grows afterwards and it is reset (not freed)
+/// between moves. Share a context between graph-cuts that run one after
+/// another (e.g. subsequent pages) - but never between concurrent ones.
+/// The context is not thread-safe: concurrent graph-cuts need a context each.
+/// </summary>
+class DllCoreExport GraphCutContext {
+
+public:
+	GraphCutContext();
+
+	class EnergyArena;
+
+	void attach(GCoptimization& gc);
+	EnergyArena* arena(int idx);
+
+	int numGraphCuts() const;
+	int numAllocations() const;
+
+	QString toString() const;
+
+private:
+	QVector<QSharedPointer<EnergyArena> > mArenas;	// [0] is used by attached graph-cuts, others by concurrent moves
+	int mNumGraphCuts = 0;
+
+	Q_DISABLE_COPY(GraphCutContext)
 };
 
 /// <summary>
@@ -86,15 +122,21 @@ public:
 
 	QSharedPointer<GraphCutConfig> config() const;
 
+	void setContext(const QSharedPointer<GraphCutContext>& context);
+	QSharedPointer<GraphCutContext> context() const;
+
 	// results - available after compute() is called
 	PixelSet set() const;
+	double energy() const;
 
 protected:
 
 	// input/output
 	PixelSet mSet;
+	double mEnergy = -1;
 	PixelDistance::EdgeWeightFunction mWeightFnc;
 	QSharedPointer<PixelConnector> mConnector;
+	QSharedPointer<GraphCutContext> mContext;
 
 	/// <summary>
 	/// Performs the graphcut.
@@ -104,6 +146,8 @@ protected:
 	/// <param name="graph">The pixel graph.</param>
 	/// <returns></returns>
 	QSharedPointer<GCoptimizationGeneralGraph> graphCut(const PixelGraph& graph) const;
+	void setNeighbors(GCoptimizationGeneralGraph& gc, const PixelGraph& graph) const;
+	void swap(GCoptimizationGeneralGraph& gc, const QVector<QPair<int, int> >& labelPairs = QVector<QPair<int, int> >()) const;
 	
 	/// <summary>
 	/// Returns a matrix with the costs for each state.
@@ -220,6 +264,21 @@ private:
 	Histogram mSpaceHist;
 };
 
+class DllCoreExport GraphCutTextLineConfig : public GraphCutConfig {
+
+public:
+	GraphCutTextLineConfig();
+
+	void setNumCandidates(int numCandidates);
+	int numCandidates() const;
+
+protected:
+	void load(const QSettings& settings) override;
+	void save(QSettings& settings) const override;
+
+	int mNumCandidates = 0;		// number of (nearest) text lines a pixel can be assigned to (0 = all)
+};
+
 /// <summary>
 /// Textline clustering using graph-cut.
 /// </summary>
@@ -231,6 +290,8 @@ public:
 
 	virtual bool compute() override;
 
+	QSharedPointer<GraphCutTextLineConfig> config() const;
+
 	cv::Mat draw(const cv::Mat& img, const QColor& col = QColor()) const;
 
 	QVector<PixelSet> textLines();
@@ -245,6 +306,8 @@ private:
 	cv::Mat labelDistMatrix(int numLabels) const override;
 	int numLabels() const override;
 
+	QSharedPointer<GCoptimizationGeneralGraph> sparseGraphCut(const PixelGraph& graph, int numCandidates) const;
+
 	cv::Mat mahalanobisDists(const PixelSet& tl, const cv::Mat& centers) const;
 	cv::Mat euclideanDists(const PixelSet& tl) const;
 	cv::Mat pixelSetCentersToMat(const PixelSet& set) const;
@@ -290,6 +353,9 @@ public:
 
 	QSharedPointer<GraphCutConfig> config() const;
 
+	void setContext(const QSharedPointer<GraphCutContext>& context);
+	QSharedPointer<GraphCutContext> context() const;
+
 	// results - available after compute() is called
 	cv::Mat image() const;
 
@@ -298,15 +364,18 @@ protected:
 	// input/output
 	QVector<cv::Mat> mImgs;
 	cv::Mat mLabelImg;
+	QSharedPointer<GraphCutContext> mContext;
 
 	/// <summary>
 	/// Performs the graphcut.
 	/// The graphcut globally optimizes the pixel states
 	/// w.r.t. the costs given
 	/// </summary>
-	/// <param name="graph">The pixel graph.</param>
-	/// <returns></returns>
-	QSharedPointer<GCoptimizationGridGraph> graphCut(const QVector<cv::Mat>& src) const;
+	/// <param name="src">The probability maps (one per label).</param>
+	/// <param name="fixedLabels">Optional CV_8UC1 labels that should be kept (255 = not fixed).</param>
+	/// <param name="context">Optional context (mContext if 0) - concurrent graph-cuts need one each.</param>
+	/// <returns>The CV_8UC1 label image or an empty image if the graph-cut failed.</returns>
+	cv::Mat graphCut(const QVector<cv::Mat>& src, const cv::Mat& fixedLabels = cv::Mat(), GraphCutContext* context = 0) const;
 
 	/// <summary>
 	/// Returns a matrix with the costs for each state.
@@ -333,8 +402,30 @@ protected:
 	QSize size() const;
 };
 
+class DllCoreExport DeepCutConfig : public GraphCutConfig {
+
+public:
+	DeepCutConfig();
+
+	void setTileSize(int tileSize);
+	int tileSize() const;
+
+	void setTileOverlap(int overlap);
+	int tileOverlap() const;
+
+protected:
+	void load(const QSettings& settings) override;
+	void save(QSettings& settings) const override;
+
+	int mTileSize = 0;			// images larger than this are cut in tiles (0 disables tiling)
+	int mTileOverlap = 32;		// context (in pixels) added to each tile & half width of the seam strips
+};
+
 /// <summary>
 /// Graph cut for optimizing probability maps.
+/// Large maps are cut in overlapping tiles which are optimized
+/// in parallel. Afterwards, strips along the tile seams are
+/// optimized again (with fixed borders) to stitch the tiles.
 /// </summary>
 /// <seealso cref="GraphCutImage" />
 class DllCoreExport DeepCut : public GraphCutImage {
@@ -344,12 +435,17 @@ public:
 
 	virtual bool compute() override;
 
+	QSharedPointer<DeepCutConfig> config() const;
+
 	cv::Mat draw(const cv::Mat& img, const QColor& col = QColor()) const;
 
 private:
 
 	bool checkInput() const override;
 
+	cv::Mat tiledGraphCut(int tileSize, int overlap) const;
+	bool stitchSeams(cv::Mat& labelImg, const QVector<cv::Rect>& strips, bool vertical) const;
+
 	cv::Mat labelDistMatrix(int numLabels) const override;
 	int numLabels() const override;
 };
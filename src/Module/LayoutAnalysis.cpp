@@ -102,6 +102,14 @@ QString LayoutAnalysisConfig::classifierPath() const {
 	return mClassifierPath;
 }
 
+void LayoutAnalysisConfig::setMaxThreads(int maxThreads) {
+	mMaxThreads = maxThreads;
+}
+
+int LayoutAnalysisConfig::maxThreads() const {
+	return ModuleConfig::checkParam(mMaxThreads, 0, INT_MAX, "maxThreads");
+}
+
 void LayoutAnalysisConfig::load(const QSettings & settings) {
 
 	mMinSuperPixelsPerBlock	= settings.value("minSuperPixelsPerBlock", minSuperixelsPerBlock()).toInt();
@@ -109,6 +117,7 @@ void LayoutAnalysisConfig::load(const QSettings & settings) {
 	mLocalBlockOrientation	= settings.value("localBlockOrientation", localBlockOrientation()).toBool();
 	mComputeSeparators		= settings.value("computeSeparators", computeSeparators()).toBool();
 	mClassifierPath			= settings.value("classifierPath", classifierPath()).toString();
+	mMaxThreads				= settings.value("maxThreads", maxThreads()).toInt();
 }
 
 void LayoutAnalysisConfig::save(QSettings & settings) const {
@@ -118,6 +127,7 @@ void LayoutAnalysisConfig::save(QSettings & settings) const {
 	settings.setValue("localBlockOrientation", localBlockOrientation());
 	settings.setValue("computeSeparators", computeSeparators());
 	settings.setValue("classifierPath", classifierPath());
+	settings.setValue("maxThreads", maxThreads());
 }
 
 // LayoutAnalysis --------------------------------------------------------------------
@@ -158,10 +168,13 @@ bool LayoutAnalysis::compute() {
 	img = mScaleFactory->scaled(img);
 	mImg = img;
 
+	// share image conversions between modules
+	QSharedPointer<PageImage> page = QSharedPointer<PageImage>::create(mImg);
 
 	// find super pixels
 	//ScaleSpaceSuperPixel<GridSuperPixel> spM(mImg);
 	ScaleSpaceSuperPixel<SuperPixel> spM(mImg);
+	spM.setPageImage(page);
 	//GridSuperPixel spM(img);
 	//SuperPixel spM(img);
 	//LineSuperPixel spM(img);
@@ -205,6 +218,7 @@ bool LayoutAnalysis::compute() {
 
 		SuperPixelClassifier spc(img, pixels);
 		spc.setModel(model);
+		spc.setPageImage(page);
 
 		if (!spc.compute())
 			qWarning() << "could not classify SuperPixels";
@@ -214,50 +228,23 @@ bool LayoutAnalysis::compute() {
 		qDebug() << "could not load classifier from " << config()->classifierPath();
 
 	// compute text lines for each text block
-	for (QSharedPointer<TextBlock> tb : mTextBlockSet.textBlocks()) {
-
-		PixelSet sp = tb->pixelSet();
-
-		if (sp.isEmpty()) {
-			qInfo() << *tb << "is empty...";
-			continue;
-		}
-
-		if (config()->localBlockOrientation()) {
-
-			if (!computeLocalStats(sp))
-				return false;
-		}
-
-		//// find tab stops
-		//rdf::TabStopAnalysis tabStops(sp);
-		//if (!tabStops.compute())
-		//	qWarning() << "could not compute text block segmentation!";
-
-		// find text lines
-		QVector<QSharedPointer<TextLineSet> > textLines;
-		if (sp.size() > config()->minSuperixelsPerBlock()) {
-
-			rdf::TextLineSegmentation tlM(sp);
-			tlM.addSeparatorLines(mStopLines);
-			tlM.config()->setScaleFactory(mScaleFactory);
-
-			if (!tlM.compute()) {
-				qWarning() << "could not compute text line segmentation!";
-				return false;
-			}
+	// blocks are independent - so process them concurrently
+	// unless overlapping blocks share pixels (their stats are written)
+	const QVector<QSharedPointer<TextBlock> > textBlocks = mTextBlockSet.textBlocks();
+	QVector<int> success(textBlocks.size(), 1);
+
+	int maxThreads = config()->maxThreads();
+	if (textBlocks.size() > 1 && mTextBlockSet.sharesPixels()) {
+		mInfo << "text blocks overlap - processing them sequentially";
+		maxThreads = 1;
+	}
 
-			// save text lines
-			textLines = tlM.textLineSets();
-		}
+	Utils::parallelFor(textBlocks.size(), [&](int idx) {
+		success[idx] = computeTextLines(textBlocks[idx]) ? 1 : 0;
+	}, maxThreads);
 
-		// paragraph is a single textline
-		if (textLines.empty()) {
-			textLines << QSharedPointer<TextLineSet>(new TextLineSet(sp.pixels()));
-		}
-
-		tb->setTextLines(textLines);
-	}
+	if (success.contains(0))
+		return false;
 	
 	mInfo << "Textlines computed in" << dtTl;
 
@@ -278,8 +265,61 @@ bool LayoutAnalysis::compute() {
 	return true;
 }
 
+/// <summary>
+/// Computes the local statistics (if requested) and the text lines of a text block.
+/// This function is thread-safe for distinct text blocks.
+/// </summary>
+/// <param name="tb">The text block.</param>
+/// <returns>false if the text lines could not be computed.</returns>
+bool LayoutAnalysis::computeTextLines(const QSharedPointer<TextBlock>& tb) const {
+
+	PixelSet sp = tb->pixelSet();
+
+	if (sp.isEmpty()) {
+		qInfo() << *tb << "is empty...";
+		return true;
+	}
+
+	if (config()->localBlockOrientation()) {
+
+		if (!computeLocalStats(sp))
+			return false;
+	}
+
+	//// find tab stops
+	//rdf::TabStopAnalysis tabStops(sp);
+	//if (!tabStops.compute())
+	//	qWarning() << "could not compute text block segmentation!";
+
+	// find text lines
+	QVector<QSharedPointer<TextLineSet> > textLines;
+	if (sp.size() > config()->minSuperixelsPerBlock()) {
+
+		rdf::TextLineSegmentation tlM(sp);
+		tlM.addSeparatorLines(mStopLines);
+		tlM.config()->setScaleFactory(mScaleFactory);
+
+		if (!tlM.compute()) {
+			qWarning() << "could not compute text line segmentation!";
+			return false;
+		}
+
+		// save text lines
+		textLines = tlM.textLineSets();
+	}
+
+	// paragraph is a single textline
+	if (textLines.empty()) {
+		textLines << QSharedPointer<TextLineSet>(new TextLineSet(sp.pixels()));
+	}
+
+	tb->setTextLines(textLines);
+
+	return true;
+}
+
 QSharedPointer<LayoutAnalysisConfig> LayoutAnalysis::config() const {
-	return qSharedPointerDynamicCast<LayoutAnalysisConfig>(mConfig);
+	return castConfig<LayoutAnalysisConfig>();
 }
 
 cv::Mat LayoutAnalysis::draw(const cv::Mat & img, const QColor& col) const {
@@ -423,8 +463,12 @@ bool LayoutAnalysis::computeLocalStats(PixelSet & pixels) const {
 		return false;
 	}
 
+	// both graph-cuts share their node/arc memory
+	QSharedPointer<GraphCutContext> gcContext = QSharedPointer<GraphCutContext>::create();
+
 	// smooth orientation
 	rdf::GraphCutOrientation pse(pixels);
+	pse.setContext(gcContext);
 
 	if (!pse.compute()) {
 		qWarning() << "could not smooth orientation";
@@ -433,6 +477,7 @@ bool LayoutAnalysis::computeLocalStats(PixelSet & pixels) const {
 
 	// smooth line spacing
 	rdf::GraphCutLineSpacing pls(pixels);
+	pls.setContext(gcContext);
 
 	if (!pls.compute()) {
 		qWarning() << "could not smooth line spacing";
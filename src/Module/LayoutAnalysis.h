@@ -82,6 +82,9 @@ public:
 	void setClassiferPath(const QString& cp);
 	QString classifierPath() const;
 
+	void setMaxThreads(int maxThreads);
+	int maxThreads() const;
+
 protected:
 
 	void load(const QSettings& settings) override;
@@ -92,6 +95,7 @@ protected:
 	bool mLocalBlockOrientation = false;	// local orientation is estimated per text block
 	bool mComputeSeparators = true;			// if true, separators lines are computed
 	QString mClassifierPath = "";
+	int mMaxThreads = 0;					// maximum number of text blocks processed concurrently (0 = all cores)
 };
 
 class DllCoreExport LayoutAnalysis : public Module {
@@ -129,6 +133,7 @@ private:
 	TextBlockSet createTextBlocks() const;
 	QVector<Line> createStopLines() const;
 	bool computeLocalStats(PixelSet& pixels) const;
+	bool computeTextLines(const QSharedPointer<TextBlock>& tb) const;
 };
 
 
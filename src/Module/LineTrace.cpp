@@ -44,8 +44,13 @@
 #include <QSettings>
 #include <QPainter>
 #include <qmath.h>
+#include <QHash>
+
 #include <opencv2/imgproc.hpp>
 #include "lsd/LSDDetector.h"
+
+#include <algorithm>
+#include <numeric>
 #pragma warning(pop)
 
 namespace rdf {
@@ -186,7 +191,7 @@ namespace rdf {
 
 	QSharedPointer<LineTraceConfig> LineTrace::config() const {
 
-		return qSharedPointerDynamicCast<LineTraceConfig>(mConfig);		
+		return castConfig<LineTraceConfig>();		
 	}
 
 	/// <summary>
@@ -223,10 +228,10 @@ namespace rdf {
 		//Image::save(vDSCCImg, "D:\\tmp\\vdscc.tif");
 		//return true;
 
-		mLineImg = cv::Mat(mSrcImg.rows, mSrcImg.cols, CV_8UC1);
-		cv::bitwise_or(hDSCCImg, vDSCCImg, mLineImg);
-
-		//Image::save(mLineImg, "D:\\tmp\\mLineImg.tif");
+		// line images are sparse - keep them run-length encoded
+		mLineImg = RunLengthImage::fromMat(hDSCCImg) | RunLengthImage::fromMat(vDSCCImg);
+		hDSCCImg.release();
+		vDSCCImg.release();
 
 		if (!std::isinf(mAngle)) {
 			QVector<rdf::Line> tmp;
@@ -248,12 +253,23 @@ namespace rdf {
 
 		filterLines();
 
-		rdf::Blobs finalBlobs;
-		finalBlobs.setImage(mLineImg);
-		finalBlobs.compute();
+		// filter the line components on runs (same as Blobs + BlobManager::filterMar)
+		int numComponents = 0;
+		QVector<int> labels = mLineImg.labels(&numComponents);
+		QVector<RunLengthImage::Run> runs = mLineImg.runs();
+
+		// the run end points have the same convex hull as the components' contours
+		QVector<std::vector<cv::Point> > pts(numComponents);
+		for (int idx = 0; idx < runs.size(); idx++) {
+			pts[labels[idx]].push_back(cv::Point(runs[idx].start, runs[idx].row));
+			pts[labels[idx]].push_back(cv::Point(runs[idx].end - 1, runs[idx].row));
+		}
 
-		finalBlobs.setBlobs(rdf::BlobManager::instance().filterMar(1.0f, config()->minLenSecondRun(), finalBlobs));
-		mLineImg = rdf::BlobManager::instance().drawBlobs(finalBlobs);
+		QVector<bool> keep(numComponents);
+		for (int idx = 0; idx < numComponents; idx++)
+			keep[idx] = rdf::BlobManager::instance().checkMar(pts[idx], 1.0f, config()->minLenSecondRun());
+
+		mLineImg = mLineImg.filterComponents(labels, keep);
 
 		return true;
 	}
@@ -320,18 +336,39 @@ namespace rdf {
 		}
 	}
 
-	void LineTrace::drawGapLines(cv::Mat& img, QVector<rdf::Line> lines) {
+	/// <summary>
+	/// Draws the gap lines to the (run-length encoded) line image.
+	/// Each line is rasterized in its bounding box only.
+	/// </summary>
+	/// <param name="img">The line image.</param>
+	/// <param name="lines">The gap lines.</param>
+	void LineTrace::drawGapLines(RunLengthImage& img, const QVector<rdf::Line>& lines) const {
 
-		for (auto l : lines) {
+		cv::Rect imgRect(cv::Point(), img.size());
+		RunLengthImage gapImg(img.size());
 
-			cv::Point2d pStart(l.p1().x(), l.p1().y());
-			cv::Point2d pEnd(l.p2().x(), l.p2().y());
+		for (const rdf::Line& l : lines) {
+
+			cv::Point pStart = cv::Point2d(l.p1().x(), l.p1().y());
+			cv::Point pEnd = cv::Point2d(l.p2().x(), l.p2().y());
 			int t = (int)l.thickness();
 			if (t <= 0)
 				t = 1;
-			cv::line(img, pStart, pEnd, cv::Scalar(255), (int)l.thickness(), 8, 0);
+
+			int pad = t + 2;
+			cv::Point tl(qMin(pStart.x, pEnd.x) - pad, qMin(pStart.y, pEnd.y) - pad);
+			cv::Point br(qMax(pStart.x, pEnd.x) + pad + 1, qMax(pStart.y, pEnd.y) + pad + 1);
+			cv::Rect box = cv::Rect(tl, br) & imgRect;
+
+			if (box.area() == 0)
+				continue;
+
+			cv::Mat patch(box.size(), CV_8UC1, cv::Scalar(0));
+			cv::line(patch, pStart - box.tl(), pEnd - box.tl(), cv::Scalar(255), t, 8, 0);
+			gapImg = gapImg | RunLengthImage::fromMat(patch, img.size(), box.tl());
 		}
 
+		img = img | gapImg;
 	}
 
 	void LineTrace::filterLines() {
@@ -354,6 +391,11 @@ namespace rdf {
 
 	cv::Mat LineTrace::hDSCC(const cv::Mat& bwImg) const {
 
+		// resolve the config once - the thresholds are checked per run length
+		QSharedPointer<const LineTraceConfig> cfg = configSnapshot<LineTraceConfig>();
+		const float maxLenDiff = (float)cfg->maxLenDiff();
+		const int maxLen = cfg->maxLen();
+
 		//std::vector<int> invalidLabels;
 		//std::vector<int> currentLen;
 		QVector<int> invalidLabels;
@@ -498,8 +540,8 @@ namespace rdf {
 							int uppr = equivalenceLbl[0];
 							//int len = currentLen[uppr-1];
 							//if runlength is longer than maxlenDiff * upprNeighbour delete runlenghts (cross points!)
-							if ((((float)runlen > config()->maxLenDiff()*(float)(currentLen[uppr - 1])) ||
-								(config()->maxLenDiff()*(float)runlen <= (float)(currentLen[uppr - 1]))) && (runlen > 5)) {
+							if ((((float)runlen > maxLenDiff*(float)(currentLen[uppr - 1])) ||
+								(maxLenDiff*(float)runlen <= (float)(currentLen[uppr - 1]))) && (runlen > 5)) {
 
 								invalidLabels[(int)(*ptrBw) - 1] = col;
 								invalidLabels[uppr - 1] = col;
@@ -512,7 +554,7 @@ namespace rdf {
 							}
 						}
 						//runlength greater maximal alloewd
-						if (runlen > config()->maxLen()) {
+						if (runlen > maxLen) {
 							invalidLabels[(int)(*ptrBw) - 1] = col;
 						}
 
@@ -601,7 +643,7 @@ namespace rdf {
 	/// </summary>
 	/// <returns>A binary CV_8UC1 image containing the lines.</returns>
 	cv::Mat LineTrace::lineImage() const {
-		return mLineImg;
+		return mLineImg.toMat();
 	}
 
 	LineTraceConfig::LineTraceConfig() 	{
@@ -718,6 +760,30 @@ namespace rdf {
 		return mMergeLines;
 	}
 
+	void LineTraceLSDConfig::setNumOctaves(int numOctaves) {
+		mNumOctaves = numOctaves;
+	}
+
+	int LineTraceLSDConfig::numOctaves() const {
+		return ModuleConfig::checkParam(mNumOctaves, 1, 5, "numOctaves");
+	}
+
+	void LineTraceLSDConfig::setStripHeight(int height) {
+		mStripHeight = height;
+	}
+
+	int LineTraceLSDConfig::stripHeight() const {
+		return mStripHeight;
+	}
+
+	void LineTraceLSDConfig::setStripOverlap(int overlap) {
+		mStripOverlap = overlap;
+	}
+
+	int LineTraceLSDConfig::stripOverlap() const {
+		return ModuleConfig::checkParam(mStripOverlap, 1, INT_MAX, "stripOverlap");
+	}
+
 	QString LineTraceLSDConfig::toString() const {
 		return ModuleConfig::toString();
 	}
@@ -725,11 +791,17 @@ namespace rdf {
 	void LineTraceLSDConfig::load(const QSettings & settings) {
 
 		mScale = settings.value("scale", scale()).toDouble();
+		mNumOctaves = settings.value("numOctaves", numOctaves()).toInt();
+		mStripHeight = settings.value("stripHeight", stripHeight()).toInt();
+		mStripOverlap = settings.value("stripOverlap", stripOverlap()).toInt();
 	}
 
 	void LineTraceLSDConfig::save(QSettings & settings) const {
 
 		settings.setValue("scale", scale());
+		settings.setValue("numOctaves", numOctaves());
+		settings.setValue("stripHeight", stripHeight());
+		settings.setValue("stripOverlap", stripOverlap());
 	}
 
 	// LineTraceLSD --------------------------------------------------------------------
@@ -756,23 +828,18 @@ namespace rdf {
 		if (scale != 1.0)
 			cv::resize(mImg, lImg, cv::Size(), scale, scale);
 
-		Timer ddt;
-
-		// create the detector
-		auto lsdd = lsd::LSDDetector::createLSDDetector();
-		std::vector<lsd::KeyLine> kls;
+		int stripHeight = config()->stripHeight();
+		int numOctaves = config()->numOctaves();
 
-		lsdd->detect(lImg, kls, 2, 1);
+		if (stripHeight > 0 && lImg.rows > stripHeight)
+			mLines = detectStrips(lImg, numOctaves, stripHeight, config()->stripOverlap());
+		else
+			mLines = detect(lImg, numOctaves);
 
-		// convert lines & scale them back
-		for (auto kl : kls) {
-			
-			Line l(kl.getStartPoint(), kl.getEndPoint());
-			
-			if (scale != 1.0)
+		// scale lines back
+		if (scale != 1.0) {
+			for (Line& l : mLines)
 				l.scale(1.0/scale);
-
-			mLines << l;
 		}
 
 		mLines = mLineFilter.removeSmall(mLines, qRound(mLineFilter.config()->minLength()*0.5));	// speed-up
@@ -805,7 +872,7 @@ namespace rdf {
 	}
 
 	QSharedPointer<LineTraceLSDConfig> LineTraceLSD::config() const {
-		return qSharedPointerDynamicCast<LineTraceLSDConfig>(Module::config());
+		return castConfig<LineTraceLSDConfig>();
 	}
 
 	LineFilter LineTraceLSD::lineFilter() const {
@@ -838,6 +905,165 @@ namespace rdf {
 		return !mImg.empty();
 	}
 
+	/// <summary>
+	/// Detects lines in several images in parallel.
+	/// </summary>
+	/// <param name="imgs">The images.</param>
+	/// <param name="config">The config used for all images (default config if NULL).</param>
+	/// <returns>The lines of each image.</returns>
+	QVector<QVector<Line> > LineTraceLSD::computeBatch(const QVector<cv::Mat>& imgs, const QSharedPointer<LineTraceLSDConfig>& config) {
+
+		QVector<QVector<Line> > lines(imgs.size());
+
+		Utils::parallelFor(imgs.size(), [&](int idx) {
+
+			LineTraceLSD lsd(imgs[idx]);
+
+			if (config)
+				lsd.setConfig(QSharedPointer<LineTraceLSDConfig>::create(*config));
+
+			if (lsd.compute())
+				lines[idx] = lsd.lines();
+		});
+
+		return lines;
+	}
+
+	/// <summary>
+	/// Detects LSD lines in img.
+	/// If several octaves are used, lines of coarser octaves
+	/// which were already found in a finer octave are removed.
+	/// </summary>
+	/// <param name="img">The image.</param>
+	/// <param name="numOctaves">The number of octaves.</param>
+	/// <returns>The detected lines.</returns>
+	QVector<Line> LineTraceLSD::detect(const cv::Mat & img, int numOctaves) const {
+
+		// create the detector (it is not thread-safe)
+		auto lsdd = lsd::LSDDetector::createLSDDetector();
+		std::vector<lsd::KeyLine> kls;
+
+		lsdd->detect(img, kls, 2, numOctaves);
+
+		// finer octaves first (they localize lines best)
+		std::stable_sort(kls.begin(), kls.end(), [](const lsd::KeyLine& kl1, const lsd::KeyLine& kl2) {
+			return kl1.octave < kl2.octave;
+		});
+
+		QVector<Line> lines;
+		lines.reserve((int)kls.size());
+
+		// grid of line centers - duplicates have close centers
+		double cellSize = 2.0 * (1 << (numOctaves - 1));
+		QHash<QPair<int, int>, QVector<int> > grid;
+
+		auto cell = [&](const Vector2D& p) {
+			return qMakePair(qFloor(p.x() / cellSize), qFloor(p.y() / cellSize));
+		};
+
+		auto isDuplicate = [&](const Line& l, double maxDist) {
+
+			QPair<int, int> c = cell(l.center());
+
+			for (int dy = -1; dy <= 1; dy++) {
+				for (int dx = -1; dx <= 1; dx++) {
+
+					auto it = grid.constFind(qMakePair(c.first + dx, c.second + dy));
+					if (it == grid.constEnd())
+						continue;
+
+					for (int idx : *it) {
+
+						const Line& ol = lines[idx];
+
+						// the end points may be swapped
+						if (((l.p1() - ol.p1()).length() <= maxDist && (l.p2() - ol.p2()).length() <= maxDist) ||
+							((l.p1() - ol.p2()).length() <= maxDist && (l.p2() - ol.p1()).length() <= maxDist))
+							return true;
+					}
+				}
+			}
+
+			return false;
+		};
+
+		for (const lsd::KeyLine& kl : kls) {
+
+			Line l(kl.getStartPoint(), kl.getEndPoint());
+
+			if (numOctaves > 1) {
+
+				// the localization error grows with the octave's scale
+				if (kl.octave > 0 && isDuplicate(l, 2.0 * (1 << kl.octave)))
+					continue;
+
+				grid[cell(l.center())] << lines.size();
+			}
+
+			lines << l;
+		}
+
+		return lines;
+	}
+
+	/// <summary>
+	/// Detects LSD lines in overlapping horizontal strips (in parallel).
+	/// Lines are assigned to the strip that contains their center.
+	/// Lines that cross strip seams are then merged.
+	/// </summary>
+	/// <param name="img">The image.</param>
+	/// <param name="numOctaves">The number of octaves.</param>
+	/// <param name="stripHeight">Height of the strips.</param>
+	/// <param name="overlap">The strip overlap.</param>
+	/// <returns>The detected lines.</returns>
+	QVector<Line> LineTraceLSD::detectStrips(const cv::Mat & img, int numOctaves, int stripHeight, int overlap) const {
+
+		int numStrips = qCeil((double)img.rows / stripHeight);
+		QVector<QVector<Line> > stripLines(numStrips);
+
+		Utils::parallelFor(numStrips, [&](int idx) {
+
+			int top = idx * stripHeight;
+			int bottom = qMin(top + stripHeight, img.rows);
+
+			cv::Rect r(0, top - overlap, img.cols, bottom - top + 2 * overlap);
+			r &= cv::Rect(0, 0, img.cols, img.rows);
+
+			for (Line l : detect(img(r), numOctaves)) {
+
+				l.translate(r.tl());
+
+				// lines in the overlap belong to the neighbor
+				double cy = l.center().y();
+				if (cy >= top && cy < bottom)
+					stripLines[idx] << l;
+			}
+		});
+
+		// lines with end points close to a seam might be parts of the same line
+		QVector<Line> lines;
+		QVector<Line> seamLines;
+
+		for (const QVector<Line>& sl : stripLines) {
+
+			for (const Line& l : sl) {
+
+				int sp1 = qRound(l.p1().y() / stripHeight) * stripHeight;
+				int sp2 = qRound(l.p2().y() / stripHeight) * stripHeight;
+
+				if ((sp1 > 0 && std::abs(l.p1().y() - sp1) <= overlap) ||
+					(sp2 > 0 && std::abs(l.p2().y() - sp2) <= overlap))
+					seamLines << l;
+				else
+					lines << l;
+			}
+		}
+
+		lines << mLineFilter.mergeLines(seamLines, 0, 2.0 * overlap + 2.0);
+
+		return lines;
+	}
+
 	// LineFilter --------------------------------------------------------------------
 	LineFilter::LineFilter() {
 		mConfig = QSharedPointer<LineFilterConfig>::create();
@@ -873,10 +1099,14 @@ namespace rdf {
 
 	/// <summary>
 	/// Merges the lines.
+	/// Each line is merged with the first (subsequent) line that fulfills
+	/// the gap and angle constraints. Candidates are looked up in a grid
+	/// of line end points (cell size = maxGap) so that only lines
+	/// with close end points are compared.
 	/// </summary>
 	/// <param name="lines">Some lines.</param>
+	/// <param name="gaps">If not NULL, the gap lines of all merged lines are appended.</param>
 	/// <param name="maxGap">The maximum gap.</param>
-	/// <param name="maxSlopeDiff">The maximum slope difference in radians.</param>
 	/// <param name="maxAngleDiff">The maximum angle difference in radians.</param>
 	/// <returns>The merged lines</returns>
 	QVector<rdf::Line> LineFilter::mergeLines(const QVector<rdf::Line>& lines, QVector<rdf::Line>* gaps, double maxGap, double maxAngleDiff) const {
@@ -887,19 +1117,63 @@ namespace rdf {
 			maxAngleDiff = mConfig->maxAngleDiff() * DK_DEG2RAD;
 
 		QVector<rdf::Line> cLines = lines;
-		QVector<rdf::Line>::iterator lineIter, lineIterCmp;
+		QVector<bool> merged(cLines.size(), false);
 
-		int lineIdx, lineCmpIdx;
+		// end point grid - lines closer than maxGap are in neighboring cells
+		double cellSize = qMax(maxGap, 1.0);
+		QHash<QPair<int, int>, QVector<int> > grid;
 
-		for (lineIter = cLines.begin(), lineIdx = 0; lineIter != cLines.end(); ) {
-			rdf::Line cLine = *lineIter;
+		auto cell = [&](const QPointF& p) {
+			return qMakePair(qFloor(p.x() / cellSize), qFloor(p.y() / cellSize));
+		};
 
-			for (lineIterCmp = lineIter, lineCmpIdx = lineIdx; lineIterCmp != cLines.end(); lineIterCmp++, lineCmpIdx++) {
+		auto insert = [&](int idx) {
+			grid[cell(cLines[idx].qLine().p1())] << idx;
+			grid[cell(cLines[idx].qLine().p2())] << idx;
+		};
 
-				if (lineIterCmp == lineIter)
-					continue;
+		auto remove = [&](int idx) {
+			grid[cell(cLines[idx].qLine().p1())].removeAll(idx);
+			grid[cell(cLines[idx].qLine().p2())].removeAll(idx);
+		};
+
+		for (int idx = 0; idx < cLines.size(); idx++)
+			insert(idx);
 
-				rdf::Line cmpLine = *lineIterCmp;
+		QVector<int> candidates;
+
+		for (int lineIdx = 0; lineIdx < cLines.size(); lineIdx++) {
+
+			const rdf::Line cLine = cLines[lineIdx];
+
+			// find all subsequent lines with close end points
+			candidates.clear();
+			for (const QPointF& p : { cLine.qLine().p1(), cLine.qLine().p2() }) {
+
+				QPair<int, int> c = cell(p);
+
+				for (int dx = -1; dx <= 1; dx++) {
+					for (int dy = -1; dy <= 1; dy++) {
+
+						auto cIter = grid.constFind(qMakePair(c.first + dx, c.second + dy));
+						if (cIter == grid.constEnd())
+							continue;
+
+						for (int cIdx : *cIter) {
+							if (cIdx > lineIdx)
+								candidates << cIdx;
+						}
+					}
+				}
+			}
+
+			// keep the order of the lines
+			std::sort(candidates.begin(), candidates.end());
+			candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+			for (int lineCmpIdx : candidates) {
+
+				const rdf::Line cmpLine = cLines[lineCmpIdx];
 				double dist = cLine.minDistance(cmpLine);
 
 				if (dist > maxGap)
@@ -934,62 +1208,80 @@ namespace rdf {
 				if (gaps)
 					gaps->append(gapLine);
 
-				*lineIterCmp = newLine;
+				// the merged line replaces the compared line
+				remove(lineCmpIdx);
+				cLines[lineCmpIdx] = newLine;
+				insert(lineCmpIdx);
 
-				lineIter = cLines.erase(lineIter);
+				remove(lineIdx);
+				merged[lineIdx] = true;
 				break;
 			}
+		}
 
-			if (lineCmpIdx == cLines.size()) {
-				lineIter++;
-				lineIdx++;
-			}
+		QVector<rdf::Line> mergedLines;
+		for (int idx = 0; idx < cLines.size(); idx++) {
+			if (!merged[idx])
+				mergedLines << cLines[idx];
 		}
 
-		QVector<size_t> eraseIdx;
+		return removeContained(mergedLines);
+	}
 
-		// now remove small lines 'within' large lines
-		for (lineIter = cLines.begin(), lineIdx = 0, lineIdx = 0; lineIter != cLines.end(); ) {
-			rdf::Line cLine = *lineIter;
+	/// <summary>
+	/// Removes small lines 'within' large lines.
+	/// Only lines with overlapping bounding boxes are compared (sweep along x).
+	/// </summary>
+	/// <param name="lines">The lines.</param>
+	/// <returns>The lines without contained lines.</returns>
+	QVector<rdf::Line> LineFilter::removeContained(const QVector<rdf::Line>& lines) const {
+
+		// contained lines are closer than 5 px (+1 px margin)
+		QVector<QRectF> boxes;
+		boxes.reserve(lines.size());
+
+		for (const rdf::Line& l : lines)
+			boxes << QRectF(l.qLine().p1(), l.qLine().p2()).normalized().adjusted(-6, -6, 6, 6);
+
+		QVector<int> order(lines.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](int l, int r) { return boxes[l].left() < boxes[r].left(); });
+
+		QVector<bool> erase(lines.size(), false);
+
+		for (int oIdx = 0; oIdx < order.size(); oIdx++) {
+
+			const QRectF& box = boxes[order[oIdx]];
 
-			for (lineIterCmp = lineIter, lineCmpIdx = lineIdx; lineIterCmp != cLines.end(); lineIterCmp++, lineCmpIdx++) {
+			for (int oCmpIdx = oIdx + 1; oCmpIdx < order.size() && boxes[order[oCmpIdx]].left() <= box.right(); oCmpIdx++) {
 
-				if (lineIterCmp == lineIter)
+				const QRectF& cmpBox = boxes[order[oCmpIdx]];
+				if (cmpBox.top() > box.bottom() || cmpBox.bottom() < box.top())
 					continue;
 
-				rdf::Line cmpLine = *lineIterCmp;
+				// compare in the order of the lines
+				int lineIdx = qMin(order[oIdx], order[oCmpIdx]);
+				int lineCmpIdx = qMax(order[oIdx], order[oCmpIdx]);
+
+				const rdf::Line& cLine = lines[lineIdx];
+				const rdf::Line& cmpLine = lines[lineCmpIdx];
 
 				if (cmpLine.distance(cLine.qLine().p1()) > 5 || cmpLine.distance(cLine.qLine().p2()) > 5)
 					continue;
 
 				if (cmpLine.within(cLine.qLine().p1()) && cmpLine.within(cLine.qLine().p2())) {
-					eraseIdx.push_back(lineIdx);
+					erase[lineIdx] = true;
 				}
 				else if (cLine.within(cmpLine.qLine().p1()) && cLine.within(cmpLine.qLine().p2())) {
-					eraseIdx.push_back(lineCmpIdx);
+					erase[lineCmpIdx] = true;
 				}
 			}
-
-			if (lineCmpIdx == cLines.size()) {
-				lineIter++;
-				lineIdx++;
-			}
 		}
 
-		qSort(eraseIdx.begin(), eraseIdx.end());
-
-		//use tmIdx to avoid double entries... deletes additional lines and can cause an exception!
-		int tmpIdx = -1;
-
-		for (int idx = ((int)eraseIdx.size()) - 1; idx >= 0; idx--) {
-			lineIter = cLines.begin();
-			lineIter += eraseIdx[idx];
-
-			if (tmpIdx == (int)eraseIdx[idx])
-				continue;
-
-			cLines.erase(lineIter);
-			tmpIdx = (int)eraseIdx[idx];
+		QVector<rdf::Line> cLines;
+		for (int idx = 0; idx < lines.size(); idx++) {
+			if (!erase[idx])
+				cLines << lines[idx];
 		}
 
 		return cLines;
@@ -34,6 +34,7 @@
 
 #include "BaseModule.h"
 #include "Shapes.h"
+#include "RunLengthImage.h"
 
 #pragma warning(push, 0)	// no warnings from includes
 // Qt Includes
@@ -97,6 +98,8 @@ public:
 protected:
 
 	QSharedPointer<LineFilterConfig> mConfig;
+
+	QVector<rdf::Line> removeContained(const QVector<rdf::Line>& lines) const;
 };
 
 
@@ -172,7 +175,7 @@ protected:
 	bool checkInput() const override;
 
 	cv::Mat mSrcImg;									//the input image  either 3 channel or 1 channel [0 255]
-	cv::Mat mLineImg;									//the line image [0 255]
+	RunLengthImage mLineImg;							//the line image (run-length encoded)
 	cv::Mat mMask;										//the mask image [0 255]
 
 	QVector<rdf::Line> hLines;
@@ -190,7 +193,7 @@ private:
 	cv::Mat hDSCC(const cv::Mat& bwImg) const;
 	void filter(cv::Mat& hDSCCImg, cv::Mat& vDSCCImg);
 	void filterLines();
-	void drawGapLines(cv::Mat& img, QVector<rdf::Line> lines);
+	void drawGapLines(RunLengthImage& img, const QVector<rdf::Line>& lines) const;
 };
 
 class DllCoreExport LineTraceLSDConfig : public ModuleConfig {
@@ -204,6 +207,15 @@ public:
 	void setMergeLines(bool merge);
 	bool mergeLines() const;
 
+	void setNumOctaves(int numOctaves);
+	int numOctaves() const;
+
+	void setStripHeight(int height);
+	int stripHeight() const;
+
+	void setStripOverlap(int overlap);
+	int stripOverlap() const;
+
 	QString toString() const override;
 
 private:
@@ -212,6 +224,9 @@ private:
 
 	double mScale = 0.5;		// initial downscaling of the image
 	bool mMergeLines = true;		// if false, lines are not merged after processing (usefull if you need an exact localization)
+	int mNumOctaves = 1;		// number of octaves of the LSD pyramid
+	int mStripHeight = 0;		// the (scaled) image is processed in horizontal strips of this height in parallel (<= 0 disables strips)
+	int mStripOverlap = 16;		// overlap of neighboring strips in pixel
 };
 
 /// <summary>
@@ -238,12 +253,17 @@ public:
 
 	cv::Mat draw(const cv::Mat& img) const;
 
+	static QVector<QVector<Line> > computeBatch(const QVector<cv::Mat>& imgs, const QSharedPointer<LineTraceLSDConfig>& config = QSharedPointer<LineTraceLSDConfig>());
+
 protected:
 	cv::Mat mImg;
 	QVector<Line> mLines;
 	LineFilter mLineFilter;
 
 	bool checkInput() const override;
+
+	QVector<Line> detect(const cv::Mat& img, int numOctaves) const;
+	QVector<Line> detectStrips(const cv::Mat& img, int numOctaves, int stripHeight, int overlap) const;
 };
 
 }
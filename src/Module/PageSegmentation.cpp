@@ -82,7 +82,7 @@ bool PageSegmentation::compute() {
 }
 
 QSharedPointer<PageSegmentationConfig> PageSegmentation::config() const {
-	return qSharedPointerDynamicCast<PageSegmentationConfig>(mConfig);
+	return castConfig<PageSegmentationConfig>();
 }
 
 cv::Mat PageSegmentation::draw(const cv::Mat& img) const {
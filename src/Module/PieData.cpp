@@ -31,6 +31,7 @@
  *******************************************************************************************************/
 
 #include "PieData.h"
+#include "Utils.h"
 
 #pragma warning(push, 0)	// no warnings from includes
 #include <QTextDocument>
@@ -75,55 +76,167 @@ namespace rdf {
 	}
 
 	void PieData::saveJsonDatabase() {
-		//QStringList filters;
-		//filters << "*.xml";
-		//fileInfoList = dir.entryInfoList(filters, QDir::Files | QDir::NoDotAndDotDot);
+
+		mDictionary.clear();
+
+		if (mJsonLines) {
+			saveJsonLines();
+			return;
+		}
 
 		QJsonObject xmlDatabaseObj;
 		xmlDatabaseObj["database"] = mXmlDir;
-		mDictionary.clear();
 
-		//QDir xmlRootDir(mXmlDir);
-		QJsonArray databaseImgs;
 		QMap<QString, QJsonArray> documents;
 
-		QDirIterator it(mXmlDir, QStringList() << "*.xml", QDir::Files, QDirIterator::Subdirectories);
-		while (it.hasNext()) {
-			QFileInfo f(it.next());
-			
-			QJsonObject page;
-			if (collect(page, f.absoluteFilePath())) {
-
-				QString identifier = page["document"].toString();	// | is not allows in paths
-				QJsonArray da = documents.value(identifier);
-				da << page;
-				documents.insert(identifier, da);
-			}
-		}
+		crawl([&](const QJsonObject& page) {
+			QString identifier = page["document"].toString();	// | is not allows in paths
+			documents[identifier] << page;
+		});
 		
 		// -------------------------------------------------------------------- recreate hierarchy 
 		// here we get the documents
 		QJsonArray jDocs;
 		QMap<QString, QJsonArray>::const_iterator di = documents.constBegin();
 
-		int idx = 0;
 		while (di != documents.constEnd()) {
 			
-			QJsonArray pages = di.value();
 			QJsonObject dob;
 			dob["name"] = di.key();
-			dob["pages"] = pages;
+			dob["pages"] = di.value();
 			
 			jDocs << dob;
 			di++;	// == dr ; )
-
-			idx++;
-			if (idx % 20 == 0)
-				std::cout << ". " << std::endl;
 		}
-		std::cout << "\n" << std::endl;
 
 		xmlDatabaseObj["documents"] = jDocs;
+		addDictionary(xmlDatabaseObj);
+
+		//// test of word2vec
+		//WordAnalyse sim;
+		//sim.loadVectors(vector_file);
+		//std::vector<WordAnalyse::NearestWord> result1, result2;
+		//sim.getNNWords("man", result1);
+		//cout << "nearest of word 'man' is------------" << endl;
+		//for (auto& x : result1) {
+		//	cout << x.text_ << ":        " << x.distance_ << endl;
+		//}
+		//cout << "'man' - 'woman' = 'king' - '?'------------" << endl;
+		//sim.wordAnalogy("man", "woman", "king", result2);
+		//for (auto& x : result2) {
+		//	cout << x.text_ << ":        " << x.distance_ << endl;
+		//}
+
+		QFile saveFile(mJsonFile);
+		if (!saveFile.open(QIODevice::WriteOnly)) {
+			qWarning("Couldn't open save file.");
+			return;
+		}
+
+		QJsonDocument saveDatabase(xmlDatabaseObj);
+		saveFile.write(saveDatabase.toJson());
+
+	}
+
+	/// <summary>
+	/// Streams the database to mJsonFile as JSON Lines.
+	/// The first line holds the database path, then each page is written
+	/// as soon as it is parsed (it has a "document" key which groups pages).
+	/// The last line holds the dictionary and the word vectors.
+	/// Hence, memory does not grow with the number of pages.
+	/// </summary>
+	/// <returns>true if the file was written.</returns>
+	bool PieData::saveJsonLines() {
+
+		QFile saveFile(mJsonFile);
+		if (!saveFile.open(QIODevice::WriteOnly)) {
+			qWarning("Couldn't open save file.");
+			return false;
+		}
+
+		auto writeLine = [&](const QJsonObject& o) {
+			saveFile.write(QJsonDocument(o).toJson(QJsonDocument::Compact));
+			saveFile.write("\n");
+		};
+
+		QJsonObject header;
+		header["database"] = mXmlDir;
+		writeLine(header);
+
+		crawl(writeLine);
+
+		QJsonObject dictionary;
+		addDictionary(dictionary);
+		writeLine(dictionary);
+
+		return true;
+	}
+
+	/// <summary>
+	/// Crawls all PAGE XMLs in mXmlDir (including subdirectories).
+	/// The files are parsed in batches of mBatchSize by mNumThreads workers.
+	/// Parsed pages are passed to pageFnc (in crawling order and in the
+	/// calling thread) and their words are added to the dictionary.
+	/// </summary>
+	/// <param name="pageFnc">Called for each page that was added to the database.</param>
+	/// <returns>The number of pages added.</returns>
+	int PieData::crawl(const std::function<void(const QJsonObject&)>& pageFnc) {
+
+		int numPages = 0;
+		int numFiles = 0;
+
+		auto processBatch = [&](const QStringList& paths) {
+
+			QVector<QJsonObject> pages(paths.size());
+			QVector<QMap<QString, int> > dicts(paths.size());
+			QVector<char> ok(paths.size(), 0);
+
+			Utils::parallelFor(paths.size(), [&](int idx) {
+
+				if (collect(pages[idx], paths[idx])) {
+					dicts[idx] = createDictionary(pages[idx].value("content").toString());
+					ok[idx] = 1;
+				}
+			}, mNumThreads);
+
+			for (int idx = 0; idx < paths.size(); idx++) {
+
+				if (!ok[idx])
+					continue;
+
+				addToDictionary(dicts[idx]);
+				pageFnc(pages[idx]);
+				numPages++;
+			}
+
+			numFiles += paths.size();
+			qInfo() << numPages << "/" << numFiles << "pages added to the database";
+		};
+
+		QStringList batch;
+		QDirIterator it(mXmlDir, QStringList() << "*.xml", QDir::Files, QDirIterator::Subdirectories);
+		while (it.hasNext()) {
+			
+			QFileInfo f(it.next());
+			batch << f.absoluteFilePath();
+
+			if (batch.size() >= mBatchSize) {
+				processBatch(batch);
+				batch.clear();
+			}
+		}
+
+		if (!batch.isEmpty())
+			processBatch(batch);
+
+		return numPages;
+	}
+
+	/// <summary>
+	/// Adds the (filtered) dictionary and the word vectors to the database.
+	/// </summary>
+	/// <param name="database">The database object.</param>
+	void PieData::addDictionary(QJsonObject& database) const {
 
 		std::vector<std::string> words;
 
@@ -137,7 +250,7 @@ namespace rdf {
 				}
 			}
 			QJsonObject dictionary = QJsonObject::fromVariantMap(vDict);
-			xmlDatabaseObj["dictionary"] = dictionary;
+			database["dictionary"] = dictionary;
 		}
 
 		if (mWord2Vec) {
@@ -146,58 +259,63 @@ namespace rdf {
 			// train
 			Word2Vec word2vec;
 			if (!mDictionary.isEmpty()) {
-				size_t vocab_size = word2vec.buildVocabFromVocab(mDictionary);
+				QMap<QString, int> dict = mDictionary;
+				size_t vocab_size = word2vec.buildVocabFromVocab(dict);
 				qDebug() << vocab_size;
 				word2vec.initNet();
 				word2vec.readTrainWords(words);
-				word2vec.train();
+				word2vec.train(mNumThreads);
 				if (mSaveWordVecToFile) {
 					word2vec.saveVectors(vector_file.toStdString());
 				} else {
 					//QVariantMap vectors;
 					QJsonArray vectors;
 					word2vec.saveVectorsMap(vectors);
-					xmlDatabaseObj["word2Vec"] = vectors;
+					database["word2Vec"] = vectors;
 				}
 			}
 		}
-		//// test of word2vec
-		//WordAnalyse sim;
-		//sim.loadVectors(vector_file);
-		//std::vector<WordAnalyse::NearestWord> result1, result2;
-		//sim.getNNWords("man", result1);
-		//cout << "nearest of word 'man' is------------" << endl;
-		//for (auto& x : result1) {
-		//	cout << x.text_ << ":        " << x.distance_ << endl;
-		//}
-		//cout << "'man' - 'woman' = 'king' - '?'------------" << endl;
-		//sim.wordAnalogy("man", "woman", "king", result2);
-		//for (auto& x : result2) {
-		//	cout << x.text_ << ":        " << x.distance_ << endl;
-		//}
+	}
 
-		QFile saveFile(mJsonFile);
-		if (!saveFile.open(QIODevice::WriteOnly)) {
-			qWarning("Couldn't open save file.");
-			return;
-		}
+	void PieData::setWord2Vec(bool w) {
+		mWord2Vec = w;
+	}
 
-		QJsonDocument saveDatabase(xmlDatabaseObj);
-		saveFile.write(saveDatabase.toJson());
+	/// <summary>
+	/// Sets the number of threads used for training word2vec.
+	/// The threads update the word vectors lock-free (Hogwild).
+	/// </summary>
+	/// <param name="numThreads">The number of threads (0 = all cores, 1 = sequential).</param>
+	void PieData::setNumThreads(int numThreads) {
+		mNumThreads = numThreads;
+	}
 
+	int PieData::numThreads() const {
+		return mNumThreads;
 	}
 
-	void PieData::setWord2Vec(bool w) {
-		mWord2Vec = w;
+	/// <summary>
+	/// If true, the database is streamed as JSON Lines.
+	/// Use this for large collections (see saveJsonLines).
+	/// </summary>
+	/// <param name="jsonLines">if set to <c>true</c> JSON Lines are written.</param>
+	void PieData::setJsonLines(bool jsonLines) {
+		mJsonLines = jsonLines;
+	}
+
+	bool PieData::jsonLines() const {
+		return mJsonLines;
 	}
 
-	bool PieData::collect(QJsonObject &document, const QString& xmlPath) {
+	bool PieData::collect(QJsonObject &document, const QString& xmlPath) const {
 
 		if (xmlPath.isEmpty()) {
 			return false;
 		}
 
+		// polygons are only parsed for regions that are exported
 		rdf::PageXmlParser parser;
+		parser.setLazyPolygons(true);
 		if (!parser.read(xmlPath, false, true)) {
 			qWarning() << "could not load" << xmlPath;
 			return false;
@@ -217,13 +335,11 @@ namespace rdf {
 		bool ok = calculateFeatures(pe, document);
 		if (ok)
 			ok = calculateLabels(pe, document);
-		if (ok)
-			ok = calculateDictionary(document);
 
 		return ok;
 	}
 
-	bool PieData::calculateFeatures(QSharedPointer<PageElement> page, QJsonObject & document) {
+	bool PieData::calculateFeatures(QSharedPointer<PageElement> page, QJsonObject & document) const {
 		
 		QVector<QSharedPointer<rdf::Region>> regions = rdf::Region::allRegions(page->rootRegion().data());
 
@@ -235,9 +351,8 @@ namespace rdf {
 		QString txtFromRegions;
 		QString txtFromLines;
 
-		for (auto r : regions) {
-
-			// calculate general region properties
+		// calculate general region properties
+		auto regionProperties = [](const QSharedPointer<rdf::Region>& r) {
 			QJsonObject rProp;
 			rdf::Polygon pol = r->polygon();
 			QPolygonF qPol = pol.closedPolygon();
@@ -245,6 +360,10 @@ namespace rdf {
 			rProp["width"] = qRect.width();
 			rProp["height"] = qRect.height();
 			rProp["type"] = r->type();
+			return rProp;
+		};
+
+		for (auto r : regions) {
 
 
 			// append specific region properties
@@ -254,11 +373,11 @@ namespace rdf {
 			case Region::type_chart:
 			case Region::type_image:
 			case Region::type_graphic:
-				jsonRegions << rProp;
+				jsonRegions << regionProperties(r);
 				break;
 
 			case Region::type_text_region: {
-				jsonRegions << rProp;
+				jsonRegions << regionProperties(r);
 				auto tr = r.dynamicCast<rdf::TextRegion>();
 				QString ct = normalize(tr->text());
 				if (!ct.isEmpty())
@@ -292,7 +411,7 @@ namespace rdf {
 		return true;
 	}
 
-	bool PieData::calculateLabels(QSharedPointer<PageElement> page, QJsonObject & document) {
+	bool PieData::calculateLabels(QSharedPointer<PageElement> page, QJsonObject & document) const {
 		
 		QString path = document["xmlPath"].toString();
 		
@@ -311,26 +430,10 @@ namespace rdf {
 		return true;
 	}
 
-	bool PieData::calculateDictionary(const QJsonObject & document) {
+	void PieData::addToDictionary(const QMap<QString, int>& dict) {
 		
-		QString content = document["content"].toString();
-
-		if (!content.isEmpty()) {
-			QMap<QString, int> dict = createDictionary(content);
-			//QVariantMap vDict;
-			if (!dict.isEmpty()) {
-
-				for (const auto w : dict.keys()) {
-					//vDict.insert(w, dict.value(w));
-					//mWords << w;
-					mDictionary[w] += dict.value(w);
-				}
-				//QJsonObject dictionary = QJsonObject::fromVariantMap(vDict);
-				//document["dictionary"] = dictionary;
-			}
-		}
-		
-		return true;
+		for (auto it = dict.constBegin(); it != dict.constEnd(); ++it)
+			mDictionary[it.key()] += it.value();
 	}
 
 	QString PieData::normalize(const QString & str) const {
@@ -43,6 +43,8 @@
 #include <QDirIterator>
 #include <QJsonDocument>
 #include <QDebug>
+
+#include <functional>
 #pragma warning(pop)
 
 #ifndef DllCoreExport
@@ -66,15 +68,23 @@ namespace rdf {
 		QMap<QString, int> createDictionary(const QString &txt, const int ignoreSize = 3) const;
 		void saveJsonDatabase();
 		void setWord2Vec(bool w=false);
+		void setNumThreads(int numThreads);
+		int numThreads() const;
+		void setJsonLines(bool jsonLines);
+		bool jsonLines() const;
 
 
 	protected:
-		bool collect(QJsonObject &document, const QString& xmlPath);
-		bool calculateFeatures(QSharedPointer<PageElement> page, QJsonObject& document);
-		bool calculateLabels(QSharedPointer<PageElement> page, QJsonObject& document);
-		bool calculateDictionary(const QJsonObject& document);
+		bool collect(QJsonObject &document, const QString& xmlPath) const;
+		bool calculateFeatures(QSharedPointer<PageElement> page, QJsonObject& document) const;
+		bool calculateLabels(QSharedPointer<PageElement> page, QJsonObject& document) const;
+		void addToDictionary(const QMap<QString, int>& dict);
 		QString normalize(const QString& str) const;
 
+		int crawl(const std::function<void(const QJsonObject&)>& pageFnc);
+		bool saveJsonLines();
+		void addDictionary(QJsonObject& database) const;
+
 	private:
 		QString mXmlDir = "C:\\tmp\\read-database";
 		QString mJsonFile = "C:\\tmp\\read-database\\database.json";
@@ -82,6 +92,9 @@ namespace rdf {
 		int mFilterDict = 2;
 		bool mWord2Vec = true;
 		bool mSaveWordVecToFile = false;
+		int mNumThreads = 0;		// # threads for parsing pages & training word2vec (0 = all cores)
+		int mBatchSize = 256;		// # pages that are parsed concurrently (and kept in memory)
+		bool mJsonLines = false;	// if true, pages are streamed to mJsonFile (one JSON object per line)
 
 	};
 
@@ -0,0 +1,509 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#include "RandomTrees.h"
+
+#include "Utils.h"
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QDebug>
+
+#include <opencv2/ml.hpp>
+
+#include <algorithm>
+#include <numeric>
+#pragma warning(pop)
+
+namespace rdf {
+
+// RandomTreesTrainer --------------------------------------------------------------------
+RandomTreesTrainer::RandomTreesTrainer(int numTrees) {
+	mNumTrees = numTrees;
+}
+
+void RandomTreesTrainer::setNumTrees(int numTrees) {
+	mNumTrees = numTrees;
+}
+
+int RandomTreesTrainer::numTrees() const {
+	return mNumTrees;
+}
+
+void RandomTreesTrainer::setMaxDepth(int maxDepth) {
+	mMaxDepth = maxDepth;
+}
+
+int RandomTreesTrainer::maxDepth() const {
+	return mMaxDepth;
+}
+
+void RandomTreesTrainer::setMinSampleCount(int minSampleCount) {
+	mMinSampleCount = minSampleCount;
+}
+
+int RandomTreesTrainer::minSampleCount() const {
+	return mMinSampleCount;
+}
+
+/// <summary>
+/// Sets the number of variables that are randomly
+/// selected at each node to find the best split.
+/// If 0, sqrt(#variables) are tested.
+/// </summary>
+/// <param name="activeVarCount">The number of active variables.</param>
+void RandomTreesTrainer::setActiveVarCount(int activeVarCount) {
+	mActiveVarCount = activeVarCount;
+}
+
+int RandomTreesTrainer::activeVarCount() const {
+	return mActiveVarCount;
+}
+
+/// <summary>
+/// Sets the maximum number of bins per variable [2 256].
+/// Variables with less distinct values are not quantized.
+/// </summary>
+/// <param name="numBins">The number of bins.</param>
+void RandomTreesTrainer::setNumBins(int numBins) {
+	mNumBins = qBound(2, numBins, 256);
+}
+
+int RandomTreesTrainer::numBins() const {
+	return mNumBins;
+}
+
+void RandomTreesTrainer::setMaxThreads(int maxThreads) {
+	mMaxThreads = maxThreads;
+}
+
+int RandomTreesTrainer::maxThreads() const {
+	return mMaxThreads;
+}
+
+/// <summary>
+/// Trains the forest.
+/// </summary>
+/// <param name="features">The features (one sample per row).</param>
+/// <param name="labels">The class labels (CV_32SC1, one label per row).</param>
+/// <returns>true if the forest was trained.</returns>
+bool RandomTreesTrainer::train(const cv::Mat & features, const cv::Mat & labels) {
+
+	if (features.empty() || features.rows != (int)labels.total()) {
+		qCritical() << "cannot train random trees - illegal features" << features.rows << "vs labels" << labels.total();
+		return false;
+	}
+
+	Timer dt;
+
+	cv::Mat cFeatures = features;
+	if (cFeatures.depth() != CV_32F)
+		cFeatures.convertTo(cFeatures, CV_32F);
+
+	cv::Mat cLabels = labels.reshape(1, 1);
+	if (cLabels.depth() != CV_32S)
+		cLabels.convertTo(cLabels, CV_32S);
+
+	int numSamples = cFeatures.rows;
+	mNumVars = cFeatures.cols;
+
+	// map labels to class indexes
+	std::vector<int> labelVec(cLabels.ptr<int>(), cLabels.ptr<int>() + numSamples);
+	std::vector<int> classLabels = labelVec;
+	std::sort(classLabels.begin(), classLabels.end());
+	classLabels.erase(std::unique(classLabels.begin(), classLabels.end()), classLabels.end());
+	mClassLabels = QVector<int>::fromStdVector(classLabels);
+
+	std::vector<int> classIdx(numSamples);
+	for (int idx = 0; idx < numSamples; idx++)
+		classIdx[idx] = (int)(std::lower_bound(classLabels.begin(), classLabels.end(), labelVec[idx]) - classLabels.begin());
+
+	// quantize the features once
+	std::vector<uchar> bins;
+	QVector<QVector<float> > edges;
+	binFeatures(cFeatures, bins, edges);
+	cFeatures.release();
+
+	qInfo() << numSamples << "x" << mNumVars << "features binned in" << dt;
+
+	// grow trees concurrently
+	mTrees = QVector<Tree>(mNumTrees);
+	std::vector<std::vector<double> > importance(mNumTrees, std::vector<double>(mNumVars, 0.0));
+	Tree* trees = mTrees.data();
+
+	Utils::parallelFor(mNumTrees, [&](int tIdx) {
+		trees[tIdx] = growTree(bins, edges, classIdx, (uint64)(42 + tIdx), importance[tIdx]);
+	}, mMaxThreads);
+
+	// normalized gini importance
+	mVarImportance = cv::Mat(1, mNumVars, CV_32FC1, cv::Scalar(0));
+	float* vip = mVarImportance.ptr<float>();
+	for (const std::vector<double>& ti : importance) {
+		for (int vIdx = 0; vIdx < mNumVars; vIdx++)
+			vip[vIdx] += (float)ti[vIdx];
+	}
+
+	double viSum = cv::sum(mVarImportance)[0];
+	if (viSum > 0)
+		mVarImportance /= viSum;
+
+	qInfo().noquote() << toString() << "trained in" << dt;
+
+	return true;
+}
+
+bool RandomTreesTrainer::isTrained() const {
+	return !mTrees.isEmpty();
+}
+
+/// <summary>
+/// Writes the forest in OpenCV's RTrees format.
+/// Hence, cv::ml::RTrees::read() can load the model.
+/// </summary>
+/// <param name="fs">The file storage.</param>
+void RandomTreesTrainer::write(cv::FileStorage & fs) const {
+
+	// parameters (see DTreesImpl::writeParams)
+	std::vector<int> varType(mNumVars + 1, cv::ml::VAR_ORDERED);
+	varType[mNumVars] = cv::ml::VAR_CATEGORICAL;	// response
+
+	int numActive = mActiveVarCount > 0 ? mActiveVarCount : 0;
+
+	fs << "format" << 3;
+	fs << "is_classifier" << 1;
+	fs << "var_all" << (int)varType.size();
+	fs << "var_count" << mNumVars;
+	fs << "ord_var_count" << mNumVars;
+	fs << "cat_var_count" << 1;
+
+	fs << "training_params" << "{";
+	fs << "use_surrogates" << 0;
+	fs << "max_categories" << 10;
+	fs << "regression_accuracy" << 0.0f;
+	fs << "max_depth" << mMaxDepth;
+	fs << "min_sample_count" << mMinSampleCount;
+	fs << "cross_validation_folds" << 0;
+	fs << "nactive_vars" << numActive;
+	fs << "}";
+
+	fs << "var_type" << varType;
+	fs << "class_labels" << mClassLabels.toStdVector();
+
+	// forest (see RTreesImpl::write)
+	fs << "oob_error" << 0.0;
+	fs << "var_importance" << mVarImportance;
+	fs << "ntrees" << mTrees.size();
+	fs << "trees" << "[";
+
+	for (const Tree& tree : mTrees) {
+
+		fs << "{" << "nodes" << "[";
+
+		// nodes are stored in pre-order as OpenCV expects it
+		for (const Node& n : tree) {
+
+			fs << "{";
+			fs << "depth" << n.depth;
+			fs << "value" << (double)mClassLabels[n.classIdx];
+			fs << "norm_class_idx" << n.classIdx;
+
+			if (n.varIdx != -1) {
+				fs << "splits" << "[";
+				fs << "{:" << "var" << n.varIdx << "quality" << n.quality << "le" << n.threshold << "}";
+				fs << "]";
+			}
+
+			fs << "}";
+		}
+
+		fs << "]" << "}";
+	}
+
+	fs << "]";
+}
+
+/// <summary>
+/// Converts the forest to an OpenCV RTrees model.
+/// </summary>
+/// <returns>The model or an empty pointer if the forest is not trained.</returns>
+cv::Ptr<cv::ml::RTrees> RandomTreesTrainer::toRTrees() const {
+
+	if (!isTrained()) {
+		qWarning() << "cannot convert random trees that are NOT trained";
+		return cv::Ptr<cv::ml::RTrees>();
+	}
+
+	cv::FileStorage fs(".xml", cv::FileStorage::WRITE | cv::FileStorage::MEMORY | cv::FileStorage::FORMAT_XML);
+	write(fs);
+	std::string data = fs.releaseAndGetString();
+
+	cv::FileStorage rfs(data, cv::FileStorage::READ | cv::FileStorage::MEMORY | cv::FileStorage::FORMAT_XML);
+	return cv::Algorithm::read<cv::ml::RTrees>(rfs.root());
+}
+
+cv::Mat RandomTreesTrainer::varImportance() const {
+	return mVarImportance;
+}
+
+int RandomTreesTrainer::numNodes() const {
+
+	int nn = 0;
+	for (const Tree& t : mTrees)
+		nn += t.size();
+
+	return nn;
+}
+
+QString RandomTreesTrainer::toString() const {
+
+	QString msg = "random trees: " + QString::number(mTrees.size()) + " trees";
+	msg += " (" + QString::number(numNodes()) + " nodes)";
+	msg += " " + QString::number(mClassLabels.size()) + " classes";
+
+	return msg;
+}
+
+/// <summary>
+/// Quantizes all features.
+/// Each feature column is sorted once and split into (at most)
+/// numBins quantiles. bins holds the bin index of each sample
+/// (column major) where value <= edges[var][b] iff bin <= b.
+/// </summary>
+/// <param name="features">The features (CV_32FC1).</param>
+/// <param name="bins">The bin indexes (#vars x #samples).</param>
+/// <param name="edges">The bin edges per variable.</param>
+void RandomTreesTrainer::binFeatures(const cv::Mat & features, std::vector<uchar>& bins, QVector<QVector<float>>& edges) const {
+
+	int numSamples = features.rows;
+	bins.resize((size_t)numSamples * mNumVars);
+	edges = QVector<QVector<float> >(mNumVars);
+	QVector<float>* ep = edges.data();
+
+	Utils::parallelFor(mNumVars, [&](int vIdx) {
+
+		std::vector<float> col(numSamples);
+		for (int rIdx = 0; rIdx < numSamples; rIdx++)
+			col[rIdx] = features.ptr<float>(rIdx)[vIdx];
+
+		std::vector<float> sorted = col;
+		std::sort(sorted.begin(), sorted.end());
+
+		std::vector<float> distinct = sorted;
+		distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+
+		QVector<float>& e = ep[vIdx];
+
+		if ((int)distinct.size() <= mNumBins) {
+			// exact splits (e.g. byte-valued descriptors)
+			for (size_t dIdx = 0; dIdx + 1 < distinct.size(); dIdx++)
+				e << distinct[dIdx];
+		}
+		else {
+			for (int bIdx = 1; bIdx < mNumBins; bIdx++) {
+				float v = sorted[(size_t)bIdx * numSamples / mNumBins];
+
+				// nothing would go right of the maximum
+				if (v < sorted.back() && (e.isEmpty() || v > e.last()))
+					e << v;
+			}
+		}
+
+		uchar* bp = &bins[(size_t)vIdx * numSamples];
+		for (int rIdx = 0; rIdx < numSamples; rIdx++)
+			bp[rIdx] = (uchar)(std::lower_bound(e.begin(), e.end(), col[rIdx]) - e.begin());
+
+	}, mMaxThreads);
+}
+
+/// <summary>
+/// Grows a single tree on a bootstrap sample.
+/// The best split of a node maximizes the Gini gain.
+/// It is found by scanning the class histograms of
+/// the node's samples for activeVarCount random variables.
+/// </summary>
+/// <param name="bins">The quantized features (see binFeatures).</param>
+/// <param name="edges">The bin edges.</param>
+/// <param name="classIdx">The class index of each sample.</param>
+/// <param name="seed">The random seed of this tree.</param>
+/// <param name="importance">The (unnormalized) Gini importance of each variable.</param>
+/// <returns>The tree's nodes in pre-order.</returns>
+RandomTreesTrainer::Tree RandomTreesTrainer::growTree(
+	const std::vector<uchar>& bins, 
+	const QVector<QVector<float>>& edges, 
+	const std::vector<int>& classIdx, 
+	uint64 seed, 
+	std::vector<double>& importance) const {
+
+	int numSamples = (int)classIdx.size();
+	int numClasses = mClassLabels.size();
+	int numActive = mActiveVarCount > 0 ? qMin(mActiveVarCount, mNumVars) : qMax(1, qRound(std::sqrt((double)mNumVars)));
+
+	cv::RNG rng(seed);
+
+	// bootstrap sample (sorted for cache friendly access)
+	std::vector<int> counts(numSamples, 0);
+	for (int idx = 0; idx < numSamples; idx++)
+		counts[rng.uniform(0, numSamples)]++;
+
+	std::vector<int> samples;
+	samples.reserve(numSamples);
+	for (int idx = 0; idx < numSamples; idx++)
+		samples.insert(samples.end(), counts[idx], idx);
+
+	std::vector<int> vars(mNumVars);
+	std::iota(vars.begin(), vars.end(), 0);
+
+	std::vector<int> classHist(numClasses);
+	std::vector<int> leftHist(numClasses);
+	std::vector<int> hist(256 * numClasses);
+
+	struct Range {
+		int begin;
+		int end;
+		int depth;
+		int rightOf;	// parent index if this is a right child
+	};
+
+	std::vector<Range> stack;
+	stack.push_back({0, (int)samples.size(), 0, -1});
+
+	Tree tree;
+
+	while (!stack.empty()) {
+
+		Range r = stack.back();
+		stack.pop_back();
+
+		int nodeIdx = tree.size();
+		if (r.rightOf != -1)
+			tree[r.rightOf].right = nodeIdx;
+
+		int n = r.end - r.begin;
+
+		std::fill(classHist.begin(), classHist.end(), 0);
+		for (int sIdx = r.begin; sIdx < r.end; sIdx++)
+			classHist[classIdx[samples[sIdx]]]++;
+
+		Node node;
+		node.depth = r.depth;
+		node.classIdx = (int)(std::max_element(classHist.begin(), classHist.end()) - classHist.begin());
+
+		bool isLeaf = r.depth >= mMaxDepth || n < mMinSampleCount || classHist[node.classIdx] == n;
+
+		double parentScore = 0;
+		for (int c : classHist)
+			parentScore += (double)c * c;
+		parentScore /= qMax(n, 1);
+
+		double bestScore = parentScore;
+		int bestVar = -1;
+		int bestBin = -1;
+
+		for (int vIdx = 0; vIdx < numActive && !isLeaf; vIdx++) {
+
+			// draw variables without replacement
+			std::swap(vars[vIdx], vars[rng.uniform(vIdx, mNumVars)]);
+			int var = vars[vIdx];
+			int nb = edges[var].size() + 1;
+
+			if (nb < 2)
+				continue;
+
+			const uchar* vb = &bins[(size_t)var * numSamples];
+			std::fill(hist.begin(), hist.begin() + nb * numClasses, 0);
+
+			for (int sIdx = r.begin; sIdx < r.end; sIdx++) {
+				int s = samples[sIdx];
+				hist[vb[s] * numClasses + classIdx[s]]++;
+			}
+
+			// scan split candidates: bin <= b goes left
+			std::fill(leftHist.begin(), leftHist.end(), 0);
+			int nl = 0;
+
+			for (int b = 0; b < nb - 1; b++) {
+
+				const int* hb = &hist[b * numClasses];
+				int nbc = 0;
+				for (int c = 0; c < numClasses; c++) {
+					leftHist[c] += hb[c];
+					nbc += hb[c];
+				}
+
+				nl += nbc;
+
+				if (nbc == 0 || nl == 0)
+					continue;
+				if (nl == n)
+					break;
+
+				double sl = 0, sr = 0;
+				for (int c = 0; c < numClasses; c++) {
+					int rc = classHist[c] - leftHist[c];
+					sl += (double)leftHist[c] * leftHist[c];
+					sr += (double)rc * rc;
+				}
+
+				double score = sl / nl + sr / (n - nl);
+
+				if (score > bestScore + 1e-9) {
+					bestScore = score;
+					bestVar = var;
+					bestBin = b;
+				}
+			}
+		}
+
+		if (bestVar != -1) {
+
+			const uchar* vb = &bins[(size_t)bestVar * numSamples];
+			int* mid = std::partition(samples.data() + r.begin, samples.data() + r.end, [&](int s) {
+				return vb[s] <= bestBin;
+			});
+			int m = (int)(mid - samples.data());
+
+			node.varIdx = bestVar;
+			node.threshold = edges[bestVar][bestBin];
+			node.quality = (float)bestScore;
+			importance[bestVar] += (bestScore - parentScore) / numSamples;
+
+			// the left child is processed first -> pre-order
+			stack.push_back({m, r.end, r.depth + 1, nodeIdx});
+			stack.push_back({r.begin, m, r.depth + 1, -1});
+		}
+
+		tree << node;
+	}
+
+	return tree;
+}
+
+}
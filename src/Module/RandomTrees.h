@@ -0,0 +1,136 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QVector>
+#include <QString>
+
+#include <opencv2/core.hpp>
+#pragma warning(pop)
+
+#ifndef DllCoreExport
+#ifdef DLL_CORE_EXPORT
+#define DllCoreExport Q_DECL_EXPORT
+#else
+#define DllCoreExport Q_DECL_IMPORT
+#endif
+#endif
+
+// Qt defines
+namespace cv {
+	namespace ml {
+		class RTrees;
+	}
+}
+
+namespace rdf {
+
+/// <summary>
+/// Native random forest (classification) trainer.
+/// Trees are grown concurrently, each on its own bootstrap sample.
+/// Features are binned once (presorted quantiles, at most 256 bins)
+/// so that the split search of a node is a histogram scan.
+/// The trained forest is exported in OpenCV's RTrees format
+/// and can therefore be used (and written) by the SuperPixelModel.
+/// </summary>
+class DllCoreExport RandomTreesTrainer {
+
+public:
+	RandomTreesTrainer(int numTrees = 150);
+
+	void setNumTrees(int numTrees);
+	int numTrees() const;
+
+	void setMaxDepth(int maxDepth);
+	int maxDepth() const;
+
+	void setMinSampleCount(int minSampleCount);
+	int minSampleCount() const;
+
+	void setActiveVarCount(int activeVarCount);
+	int activeVarCount() const;
+
+	void setNumBins(int numBins);
+	int numBins() const;
+
+	void setMaxThreads(int maxThreads);
+	int maxThreads() const;
+
+	bool train(const cv::Mat& features, const cv::Mat& labels);
+	bool isTrained() const;
+
+	void write(cv::FileStorage& fs) const;
+	cv::Ptr<cv::ml::RTrees> toRTrees() const;
+
+	cv::Mat varImportance() const;
+	int numNodes() const;
+
+	QString toString() const;
+
+protected:
+
+	/// <summary>
+	/// A node of a tree (stored in pre-order).
+	/// Leaves have no split variable (varIdx == -1).
+	/// </summary>
+	struct Node {
+		int depth = 0;
+		int classIdx = 0;
+		int varIdx = -1;
+		float threshold = 0.0f;	// go left if value <= threshold
+		float quality = 0.0f;
+		int right = -1;			// the left child is the next node
+	};
+
+	typedef QVector<Node> Tree;
+
+	// parameters
+	int mNumTrees = 150;
+	int mMaxDepth = 5;			// same defaults as cv::ml::RTrees
+	int mMinSampleCount = 10;
+	int mActiveVarCount = 0;	// number of variables tested per node (0 = sqrt(#vars))
+	int mNumBins = 256;
+	int mMaxThreads = 0;		// maximum number of trees grown concurrently (0 = all cores)
+
+	// results
+	QVector<Tree> mTrees;
+	QVector<int> mClassLabels;
+	cv::Mat mVarImportance;
+	int mNumVars = 0;
+
+	void binFeatures(const cv::Mat& features, std::vector<uchar>& bins, QVector<QVector<float> >& edges) const;
+	Tree growTree(const std::vector<uchar>& bins, const QVector<QVector<float> >& edges, const std::vector<int>& classIdx, uint64 seed, std::vector<double>& importance) const;
+};
+
+}
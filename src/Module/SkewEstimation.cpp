@@ -95,16 +95,19 @@ namespace rdf {
 			cv::cvtColor(mSrcImg, skewImg, CV_RGB2GRAY);
 		}
 
+		// resolve the config once - it is used in per-pixel loops
+		QSharedPointer<const BaseSkewEstimationConfig> cfg = configSnapshot<BaseSkewEstimationConfig>();
+
 		int w, h;
 		int delta, epsilon;
-		w = config()->width();
+		w = cfg->width();
 		//w = qRound(mSrcImg.cols / 1430.0*49.0); //check  (nomacs plugin version)
-		h = config()->height();
+		h = cfg->height();
 		//h = qRound(mSrcImg.rows / 700.0*12.0); //check (nomacs plugin version)
 		w = w <= 1 ? 10 : w;
 		h = h <= 1 ? 5 : h;
-		epsilon = config()->epsilon();
-		delta = config()->delta();
+		epsilon = cfg->epsilon();
+		delta = cfg->delta();
 		//delta = qRound(mSrcImg.cols / 1430.0*20.0); //check (nomacs plugin version)
 		//mMinLineLength = qRound(mSrcImg.cols / 1430.0 * 20.0); //check
 		
@@ -130,11 +133,11 @@ namespace rdf {
 
 		double min, max;
 		cv::minMaxLoc(horSep, &min, &max); //* max -> check
-		double thr = mFixedThr ? config()->thr() : config()->thr() * max;
-		cv::Mat edgeHor = edgeMap(horSep, thr, HORIZONTAL, mMask);
+		double thr = mFixedThr ? cfg->thr() : cfg->thr() * max;
+		cv::Mat edgeHor = edgeMap(horSep, thr, *cfg, HORIZONTAL, mMask);
 		cv::minMaxLoc(verSep, &min, &max);
-		thr = mFixedThr ? config()->thr() : config()->thr() * max;
-		cv::Mat edgeVer = edgeMap(verSep, thr, VERTICAL, mMask);
+		thr = mFixedThr ? cfg->thr() : cfg->thr() * max;
+		cv::Mat edgeVer = edgeMap(verSep, thr, *cfg, VERTICAL, mMask);
 
 		//Image::save(edgeHor, "D:\\tmp\\edgeHorF.png");
 		//Image::save(edgeVer, "D:\\tmp\\edgeVerF.png");
@@ -142,8 +145,8 @@ namespace rdf {
 		mSelectedLines.clear();
 		mSelectedLineTypes.clear();
 
-		QVector<QVector3D> weightsHor = computeWeights(edgeHor, delta, epsilon, HORIZONTAL);
-		QVector<QVector3D> weightsVer = computeWeights(edgeVer.t(), delta, epsilon, VERTICAL);
+		QVector<QVector3D> weightsHor = computeWeights(edgeHor, delta, epsilon, *cfg, HORIZONTAL);
+		QVector<QVector3D> weightsVer = computeWeights(edgeVer.t(), delta, epsilon, *cfg, VERTICAL);
 
 		QVector<QVector3D> weightsAll = weightsHor + weightsVer;
 
@@ -163,7 +166,7 @@ namespace rdf {
 		double diagonal = qSqrt(mSrcImg.rows*mSrcImg.rows + mSrcImg.cols*mSrcImg.cols);
 		bool ok = true;
 
-		mSkewAngle = skewEst(weightsAll, diagonal, ok);
+		mSkewAngle = skewEst(weightsAll, diagonal, ok, *cfg);
 
 		//do not save here because it is not thread safe
 		//saveSettings();
@@ -265,12 +268,14 @@ namespace rdf {
 	/// </summary>
 	/// <param name="separability">The separability map.</param>
 	/// <param name="thr">A threshold value for edges (=0.1).</param>
+	/// <param name="cfg">The config snapshot of the current run.</param>
 	/// <param name="direction">The direction (horizontal or vertical).</param>
 	/// <param name="mask">The optional mask.</param>
 	/// <returns>The edge map.</returns>
-	cv::Mat BaseSkewEstimation::edgeMap(const cv::Mat& separability, double thr, EdgeDirection direction, const cv::Mat& mask) const
+	cv::Mat BaseSkewEstimation::edgeMap(const cv::Mat& separability, double thr, const BaseSkewEstimationConfig& cfg, EdgeDirection direction, const cv::Mat& mask) const
 	{
 		cv::Mat edgeM = cv::Mat::zeros(separability.size(), CV_8UC1);
+		const int kMax = cfg.kMax();
 
 		for (int row = 0; row < separability.rows; row++) {
 
@@ -285,7 +290,7 @@ namespace rdf {
 
 				if (ptrSep[col] > thr) {
 					bool edgeT = true;
-					for (int k = -config()->kMax(); k <= config()->kMax(); k++) {
+					for (int k = -kMax; k <= kMax; k++) {
 						if (k == 0) {
 							continue;
 						}
@@ -324,14 +329,16 @@ namespace rdf {
 	/// <param name="edgeMap">The edge map.</param>
 	/// <param name="delta">Delta parameter: max coordinate deviation for refined lines.</param>
 	/// <param name="epsilon">Epsilon parameter: max allowed deviation from line coordinates for the weight calculation (=2).</param>
+	/// <param name="cfg">The config snapshot of the current run.</param>
 	/// <param name="direction">The direction (horizontal or vertical).</param>
 	/// <returns>The line weights</returns>
-	QVector<QVector3D> BaseSkewEstimation::computeWeights(cv::Mat edgeMap, int delta, int epsilon, EdgeDirection direction) {
+	QVector<QVector3D> BaseSkewEstimation::computeWeights(cv::Mat edgeMap, int delta, int epsilon, const BaseSkewEstimationConfig& cfg, EdgeDirection direction) {
 		std::vector<cv::Vec4i> lines;
 		QVector4D maxLine = QVector4D();
-		int minLineProjLength = config()->minLineLength() / 4;
+		int minLineProjLength = cfg.minLineLength() / 4;
+		int nIter = cfg.nIter();
 		//params: rho resolution, theta resolution, threshold, min Line length, max line gap
-		cv::HoughLinesP(edgeMap, lines, 1, CV_PI / 180, 50, config()->minLineLength(), 20);
+		cv::HoughLinesP(edgeMap, lines, 1, CV_PI / 180, 50, cfg.minLineLength(), 20);
 
 		QVector<QVector3D> computedWeights = QVector<QVector3D>();
 
@@ -362,7 +369,7 @@ namespace rdf {
 				//double slope = (l[3] - l[1]) / (l[2] - l[0]); test
 
 				//TODO: instead of x1++ and x2-- check if alternating increment/decrement improves result
-				while (qAbs(x1 - x2) > minLineProjLength && K < config()->nIter()) {
+				while (qAbs(x1 - x2) > minLineProjLength && K < nIter) {
 
 					int y1 = qRound(l[1] + (x1 - l[0]) * slope);
 					int y2 = qRound(l[1] + (x2 - l[0]) * slope);
@@ -444,9 +451,10 @@ namespace rdf {
 	/// <param name="weights">The weights.</param>
 	/// <param name="imgDiagonal">The img diagonal.</param>
 	/// <param name="ok">Ok - is set to false if only one line is detected.</param>
+	/// <param name="cfg">The config snapshot of the current run.</param>
 	/// <param name="eta">Eta -  parameter to reject small lines.</param>
 	/// <returns></returns>
-	double BaseSkewEstimation::skewEst(const QVector<QVector3D>& weights, double imgDiagonal, bool& ok, double eta) {
+	double BaseSkewEstimation::skewEst(const QVector<QVector3D>& weights, double imgDiagonal, bool& ok, const BaseSkewEstimationConfig& cfg, double eta) {
 
 		if (weights.size() < 1) {
 			ok = false;
@@ -473,6 +481,7 @@ namespace rdf {
 
 
 		QVector<QPointF> saliencyVec = QVector<QPointF>();
+		const double sigma = cfg.sigma();
 
 		for (double skewAngle = -30; skewAngle <= 30.001; skewAngle += 0.01) {
 
@@ -481,7 +490,7 @@ namespace rdf {
 			for (int i = 0; i < thrWeights.size(); i++) {
 				//plugin version
 				//saliency += thrWeights.at(i).x() * qExp(-thrWeights.at(i).z()) * qExp(-0.5 * ((skewAngle - thrWeights.at(i).y()) * (skewAngle - thrWeights.at(i).y())) / (mSigma * mSigma));
-				saliency += thrWeights[i].x() * qExp(-thrWeights[i].z()) * (1/qSqrt(2.0*CV_PI*config()->sigma()*config()->sigma())) * qExp(-0.5 * ((skewAngle - thrWeights[i].y()) * (skewAngle - thrWeights[i].y())) / (config()->sigma() * config()->sigma()));
+				saliency += thrWeights[i].x() * qExp(-thrWeights[i].z()) * (1/qSqrt(2.0*CV_PI*sigma*sigma)) * qExp(-0.5 * ((skewAngle - thrWeights[i].y()) * (skewAngle - thrWeights[i].y())) / (sigma * sigma));
 			}
 
 			saliencyVec.append(QPointF(skewAngle, saliency));
@@ -586,7 +595,7 @@ namespace rdf {
 
 	QSharedPointer<BaseSkewEstimationConfig> BaseSkewEstimation::config() const
 	{
-		return qSharedPointerDynamicCast<BaseSkewEstimationConfig>(mConfig);
+		return castConfig<BaseSkewEstimationConfig>();
 	}
 
 	BaseSkewEstimationConfig::BaseSkewEstimationConfig()	{
@@ -829,7 +838,7 @@ namespace rdf {
 	}
 
 	QSharedPointer<TextLineSkewConfig> TextLineSkew::config() const {
-		return mConfig.dynamicCast<TextLineSkewConfig>();
+		return castConfig<TextLineSkewConfig>();
 	}
 
 	cv::Mat TextLineSkew::draw(const cv::Mat & img) const {
@@ -146,10 +146,10 @@ namespace rdf {
 		cv::Mat mMask;										//the mask image [0 255]
 
 		cv::Mat separability(const cv::Mat& srcImg, int w, int h, const cv::Mat& mask = cv::Mat());
-		cv::Mat edgeMap(const cv::Mat& separability, double thr, EdgeDirection direction = HORIZONTAL, const cv::Mat& mask = cv::Mat()) const;
-		QVector<QVector3D> computeWeights(cv::Mat edgeMap, int delta, int epsilon, EdgeDirection direction = HORIZONTAL);
+		cv::Mat edgeMap(const cv::Mat& separability, double thr, const BaseSkewEstimationConfig& cfg, EdgeDirection direction = HORIZONTAL, const cv::Mat& mask = cv::Mat()) const;
+		QVector<QVector3D> computeWeights(cv::Mat edgeMap, int delta, int epsilon, const BaseSkewEstimationConfig& cfg, EdgeDirection direction = HORIZONTAL);
 		//according to paper eta should be 0.5
-		double skewEst(const QVector<QVector3D>& weights, double imgDiagonal, bool& ok, double eta=0.35);
+		double skewEst(const QVector<QVector3D>& weights, double imgDiagonal, bool& ok, const BaseSkewEstimationConfig& cfg, double eta=0.35);
 		bool checkInput() const override;
 
 	private:
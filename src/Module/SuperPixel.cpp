@@ -175,9 +175,8 @@ bool SuperPixel::compute() {
 
 	Timer dt;
 
-	cv::Mat img = mSrcImg.clone();
-	img = IP::grayscale(img);
-	cv::normalize(img, img, 255, 0, cv::NORM_MINMAX);
+	// getBlobs filters the image in-place
+	cv::Mat img = mPageImage->normalized().clone();
 
 	QSharedPointer<MserContainer> rawBlobs(new MserContainer());
 
@@ -223,7 +222,7 @@ QVector<QSharedPointer<MserBlob> > SuperPixel::getMserBlobs() const {
 }
 
 QSharedPointer<SuperPixelConfig> SuperPixel::config() const {
-	return qSharedPointerDynamicCast<SuperPixelConfig>(mConfig);
+	return castConfig<SuperPixelConfig>();
 }
 
 cv::Mat SuperPixel::draw(const cv::Mat & img, const QColor& col) const {
@@ -456,6 +455,12 @@ bool LocalOrientation::isEmpty() const {
 	return mSet.isEmpty();
 }
 
+/// <summary>
+/// Computes the local orientation histograms of all pixels.
+/// Pixels are processed in parallel, each worker has its own scratch memory
+/// and the stats of all pixels are written to one contiguous matrix.
+/// </summary>
+/// <returns>true on success.</returns>
 bool LocalOrientation::compute() {
 	
 	if (!checkInput())
@@ -463,12 +468,48 @@ bool LocalOrientation::compute() {
 	
 	Timer dt;
 
+	// resolve the config once - computeScales is called per pixel
+	QSharedPointer<const LocalOrientationConfig> cfg = configSnapshot<LocalOrientationConfig>();
+
 	QVector<Pixel*> ptrSet;
 	for (const QSharedPointer<Pixel>& p : mSet.pixels())
 		ptrSet << p.data();
 
-	for (Pixel* p : ptrSet)
-		computeScales(p, ptrSet);
+	int nOr = cfg->numOrientations();
+	int numScales = 0;
+	for (double cRadius = cfg->maxScale(); cRadius >= cfg->minScale(); cRadius /= 2.0)
+		numScales++;
+
+	// unit vectors of all orientations (as columns)
+	cv::Mat orVecs(2, nOr, CV_64FC1);
+	for (int k = 0; k < nOr; k++) {
+		Vector2D orVec(1.0, 0);
+		orVec.rotate(k * CV_PI / nOr);
+		orVecs.at<double>(0, k) = orVec.x();
+		orVecs.at<double>(1, k) = orVec.y();
+	}
+
+	// stats of all pixels & scales
+	cv::Mat statsData(ptrSet.size() * numScales * PixelStats::idx_end, nOr, CV_32FC1);
+
+	int numChunks = qMin(ptrSet.size(), cv::getNumThreads() * 4);
+	int chunkSize = (ptrSet.size() + numChunks - 1) / numChunks;
+
+	Utils::parallelFor(numChunks, [&](int cIdx) {
+
+		OrHistBuffer buffer;
+		buffer.offsets.create(ptrSet.size(), 2, CV_64FC1);
+		buffer.projections.create(ptrSet.size(), nOr, CV_64FC1);
+		buffer.orHist.create(nOr, cfg->histSize(), CV_32FC1);
+		buffer.sparsity.create(1, nOr, CV_32FC1);
+
+		for (int pIdx = cIdx * chunkSize; pIdx < qMin((cIdx + 1) * chunkSize, ptrSet.size()); pIdx++) {
+			
+			int sr = pIdx * numScales * PixelStats::idx_end;
+			cv::Mat pxData = statsData.rowRange(sr, sr + numScales * PixelStats::idx_end);
+			computeScales(ptrSet[pIdx], ptrSet, *cfg, orVecs, buffer, pxData);
+		}
+	});
 
 	mInfo << "computed in" << dt;
 
@@ -480,7 +521,7 @@ QString LocalOrientation::toString() const {
 }
 
 QSharedPointer<LocalOrientationConfig> LocalOrientation::config() const {
-	return qSharedPointerDynamicCast<LocalOrientationConfig>(mConfig);
+	return castConfig<LocalOrientationConfig>();
 }
 
 PixelSet LocalOrientation::set() const {
@@ -491,13 +532,17 @@ bool LocalOrientation::checkInput() const {
 	return !mSet.isEmpty();
 }
 
-void LocalOrientation::computeScales(Pixel* pixel, const QVector<Pixel*>& set) const {
+void LocalOrientation::computeScales(Pixel* pixel, const QVector<Pixel*>& set, const LocalOrientationConfig& cfg, 
+	const cv::Mat& orVecs, OrHistBuffer& buffer, cv::Mat& statsData) const {
 	
 	const Vector2D& ec = pixel->center();
 	QVector<Pixel*> cSet = set;
 	
+	const int minScale = cfg.minScale();
+	int sIdx = 0;
+
 	// iterate over all scales
-	for (double cRadius = config()->maxScale(); cRadius >= config()->minScale(); cRadius /= 2.0) {
+	for (double cRadius = cfg.maxScale(); cRadius >= minScale; cRadius /= 2.0, sIdx++) {
 
 		QVector<Pixel*> neighbors;
 
@@ -510,52 +555,99 @@ void LocalOrientation::computeScales(Pixel* pixel, const QVector<Pixel*>& set) c
 		}
 
 		// compute orientation histograms
-		computeAllOrHists(pixel, neighbors, cRadius);
+		cv::Mat data = statsData.rowRange(sIdx * PixelStats::idx_end, (sIdx + 1) * PixelStats::idx_end);
+		computeAllOrHists(pixel, neighbors, cRadius, cfg, orVecs, buffer, data);
 
 		// reduce the set (since we reduce the radius, it must be contained in the current set)
 		cSet = neighbors;
 	}
 }
 
-void LocalOrientation::computeAllOrHists(Pixel* pixel, const QVector<Pixel*>& set, double radius) const {
+/// <summary>
+/// Computes the orientation histograms of all orientations.
+/// All neighbors are projected onto all orientations with one matrix product.
+/// </summary>
+/// <param name="pixel">The pixel.</param>
+/// <param name="neighbors">The pixel's neighbors within radius.</param>
+/// <param name="radius">The radius.</param>
+/// <param name="cfg">The configuration.</param>
+/// <param name="orVecs">The unit vectors of all orientations (2 x numOrientations).</param>
+/// <param name="buffer">The worker's scratch memory.</param>
+/// <param name="statsData">The storage of the resulting PixelStats.</param>
+void LocalOrientation::computeAllOrHists(Pixel* pixel, const QVector<Pixel*>& neighbors, double radius, const LocalOrientationConfig& cfg, 
+	const cv::Mat& orVecs, OrHistBuffer& buffer, const cv::Mat& statsData) const {
 
-	const Vector2D& ec = pixel->center();
+	const Vector2D pc = pixel->center();
+	int nOr = orVecs.cols;
+	int n = neighbors.size();
 
-	QVector<const Pixel*> neighbors;
+	// setting the orientation histogram default to 1 
+	// gives better estimations if the hist is sparse (lots of 0 entries)
+	// due to the dft
+	cv::Mat& orHist = buffer.orHist;
+	orHist.setTo(1);
 
-	// create neighbor set
-	for (const Pixel* p : set) {
+	if (n > 0) {
 
-		if (ec.isNeighbor(p->center(), radius)) {
-			neighbors << p;
+		cv::Mat offsets = buffer.offsets.rowRange(0, n);
+		cv::Mat proj = buffer.projections.rowRange(0, n);
+
+		for (int idx = 0; idx < n; idx++) {
+			Vector2D lc = neighbors[idx]->center() - pc;
+			double* oPtr = offsets.ptr<double>(idx);
+			oPtr[0] = lc.x();
+			oPtr[1] = lc.y();
+		}
+
+		// project all neighbors onto all orientations
+		cv::gemm(offsets, orVecs, 1.0, cv::noArray(), 0.0, proj);
+
+		double scale = 1.0 / (2 * radius) * (orHist.cols - 1);
+
+		for (int idx = 0; idx < n; idx++) {
+
+			const double* pPtr = proj.ptr<double>(idx);
+
+			for (int k = 0; k < nOr; k++) {
+
+				// bin it
+				int hIdx = qRound((pPtr[k] + radius) * scale);
+				assert(hIdx >= 0 && hIdx < orHist.cols);
+
+				orHist.ptr<float>(k)[hIdx] += 1;
+			}
 		}
 	}
 
-	// compute all orientations
-	int nOr = config()->numOrientations();
-	int histSize = config()->histSize();
+	// estimate sparsity
+	float* spPtr = buffer.sparsity.ptr<float>();
+	for (int k = 0; k < nOr; k++)
+		spPtr[k] = (float)std::log((double)cv::countNonZero(orHist.row(k)) / orHist.cols);
 
-	// setting the orientation histogram default to 1 
-	// gives better estimations if the hist is sparse (lots of 0 entries)
-	// due to the dft
-	cv::Mat orHist(nOr, histSize, CV_32FC1, cv::Scalar(1));
-	cv::Mat sparsity(1, nOr, CV_32FC1);
+	// DFT according to Koo16
+	cv::dft(orHist, orHist, cv::DFT_ROWS);
 
 	for (int k = 0; k < nOr; k++) {
 
-		// create orientation vector
-		float sp = 0.0f;
-		double cAngle = k * CV_PI / nOr;
-		Vector2D orVec(radius, 0);
-		orVec.rotate(cAngle);
+		float* orPtr = orHist.ptr<float>(k);
+		float normValSq = orPtr[0] * orPtr[0];	// the normalization term is always at [0] - we need it sqaured
 
-		cv::Mat cRow = orHist.row(k);
-		computeOrHist(pixel, neighbors, orVec, cRow, sp);
+		// remove very low frequencies - they might create larger peaks than the recurring frequency
+		for (int cIdx = 0; cIdx < qMin(3, orHist.cols); cIdx++)
+			orPtr[cIdx] = 0.0f;
 
-		sparsity.at<float>(0, k) = sp;
+		// see computeOrHist
+		for (int cIdx = 3; cIdx < orHist.cols; cIdx++) {
+
+			double v = orPtr[cIdx];
+			v *= v;
+			v /= normValSq;
+			v += 1.0;	// scale log
+			orPtr[cIdx] = (float)-std::log(v);
+		}
 	}
 
-	pixel->addStats(QSharedPointer<PixelStats>(new PixelStats(orHist, sparsity, radius, config()->scaleFactory(), pixel->id())));
+	pixel->addStats(QSharedPointer<PixelStats>(new PixelStats(orHist, buffer.sparsity, radius, cfg.scaleFactory(), pixel->id(), statsData)));
 }
 
 void LocalOrientation::computeOrHist(const Pixel* pixel, 
@@ -715,10 +807,6 @@ bool LineSuperPixel::compute() {
 
 	Timer dt;
 
-	cv::Mat img = mSrcImg.clone();
-	img = IP::grayscale(img);
-	cv::normalize(img, img, 255, 0, cv::NORM_MINMAX);
-
 	LineTraceLSD lt(mSrcImg);
 	lt.config()->setScale(1.0);
 	lt.lineFilter().config()->setMinLength(config()->minLineLength());
@@ -746,7 +834,7 @@ QString LineSuperPixel::toString() const {
 }
 
 QSharedPointer<LinePixelConfig> LineSuperPixel::config() const {
-	return qSharedPointerDynamicCast<LinePixelConfig>(mConfig);
+	return castConfig<LinePixelConfig>();
 }
 
 cv::Mat LineSuperPixel::draw(const cv::Mat & img) const {
@@ -1046,7 +1134,7 @@ QString GridSuperPixel::toString() const {
 }
 
 QSharedPointer<GridPixelConfig> GridSuperPixel::config() const {
-	return qSharedPointerDynamicCast<GridPixelConfig>(mConfig);
+	return castConfig<GridPixelConfig>();
 }
 
 cv::Mat GridSuperPixel::draw(const cv::Mat & img, const QColor& col) const {
@@ -1147,6 +1235,23 @@ void GridPixelConfig::save(QSettings & settings) const {
 // -------------------------------------------------------------------- SuperPixelBase 
 SuperPixelBase::SuperPixelBase(const cv::Mat & img) {
 	mSrcImg = img;
+	mPageImage = QSharedPointer<PageImage>::create(img);
+}
+
+/// <summary>
+/// Sets a shared page context.
+/// Use this if several modules process the same image
+/// so that conversions (e.g. grayscale) are computed once.
+/// </summary>
+/// <param name="page">The page context of the source image.</param>
+void SuperPixelBase::setPageImage(const QSharedPointer<PageImage>& page) {
+
+	assert(page && page->image().data == mSrcImg.data);
+	mPageImage = page;
+}
+
+QSharedPointer<PageImage> SuperPixelBase::pageImage() const {
+	return mPageImage;
 }
 
 bool SuperPixelBase::isEmpty() const {
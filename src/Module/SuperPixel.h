@@ -38,6 +38,7 @@
 #include "Shapes.h"
 #include "Pixel.h"
 #include "PixelSet.h"
+#include "PageImage.h"
 #include "Image.h"	// TODO: remove (with GridPixel)
 
 #pragma warning(push, 0)	// no warnings from includes
@@ -77,8 +78,12 @@ public:
 	void setPyramidLevel(int level);
 	int pyramidLevel();
 
+	void setPageImage(const QSharedPointer<PageImage>& page);
+	QSharedPointer<PageImage> pageImage() const;
+
 protected:
 	cv::Mat mSrcImg;
+	QSharedPointer<PageImage> mPageImage;
 	PixelSet mSet;
 
 	int mPyramidLevel = 0;
@@ -370,8 +375,20 @@ private:
 
 	bool checkInput() const override;
 
-	void computeScales(Pixel* pixel, const QVector<Pixel*>& set) const;
-	void computeAllOrHists(Pixel* pixel, const QVector<Pixel*>& set, double radius) const;
+	/// <summary>
+	/// Scratch memory of a worker thread.
+	/// </summary>
+	struct OrHistBuffer {
+		cv::Mat offsets;		// N x 2 neighbor offsets (CV_64FC1)
+		cv::Mat projections;	// N x numOrientations (CV_64FC1)
+		cv::Mat orHist;			// numOrientations x histSize (CV_32FC1)
+		cv::Mat sparsity;		// 1 x numOrientations (CV_32FC1)
+	};
+
+	void computeScales(Pixel* pixel, const QVector<Pixel*>& set, const LocalOrientationConfig& cfg, 
+		const cv::Mat& orVecs, OrHistBuffer& buffer, cv::Mat& statsData) const;
+	void computeAllOrHists(Pixel* pixel, const QVector<Pixel*>& neighbors, double radius, const LocalOrientationConfig& cfg, 
+		const cv::Mat& orVecs, OrHistBuffer& buffer, const cv::Mat& statsData) const;
 	void computeOrHist(const Pixel* pixel, 
 		const QVector<const Pixel*>& set, 
 		const Vector2D& histVec, 
@@ -49,6 +49,7 @@
 #include <opencv2/features2d.hpp>
 #include <opencv2/ml.hpp>
 
+#include <algorithm>
 
 #include "GCGraph.hpp"
 #include "graphcut/GCoptimization.h"
@@ -87,6 +88,7 @@ void SuperPixelClassifierConfig::save(QSettings & settings) const {
 SuperPixelClassifier::SuperPixelClassifier(const cv::Mat& img, const PixelSet& set) {
 
 	mImg = img;
+	mPageImage = QSharedPointer<PageImage>::create(img);
 	mSet = set;
 	mConfig = QSharedPointer<SuperPixelClassifierConfig>::create();
 	mConfig->loadSettings();
@@ -105,6 +107,7 @@ bool SuperPixelClassifier::compute() {
 
 	// compute features
 	SuperPixelFeature spf(mImg, mSet);
+	spf.setPageImage(mPageImage);
 
 	if (!spf.compute()) {
 		mWarning << "SuperPixel features could not be computed";
@@ -139,7 +142,7 @@ bool SuperPixelClassifier::compute() {
 }
 
 QSharedPointer<SuperPixelClassifierConfig> SuperPixelClassifier::config() const {
-	return qSharedPointerDynamicCast<SuperPixelClassifierConfig>(mConfig);
+	return castConfig<SuperPixelClassifierConfig>();
 }
 
 cv::Mat SuperPixelClassifier::draw(const cv::Mat& img) const {
@@ -172,6 +175,16 @@ PixelSet SuperPixelClassifier::pixelSet() const {
 	return mSet;
 }
 
+/// <summary>
+/// Sets a shared page context (see PageImage).
+/// </summary>
+/// <param name="page">The page context of the source image.</param>
+void SuperPixelClassifier::setPageImage(const QSharedPointer<PageImage>& page) {
+
+	assert(page && page->image().data == mImg.data);
+	mPageImage = page;
+}
+
 bool SuperPixelClassifier::checkInput() const {
 
 	if (mModel && mModel->model() && !mModel->model()->isTrained())
@@ -188,9 +201,31 @@ QString SuperPixelFeatureConfig::toString() const{
 	return ModuleConfig::toString();
 }
 
+void SuperPixelFeatureConfig::setMaxThreads(int maxThreads) {
+	mMaxThreads = maxThreads;
+}
+
+int SuperPixelFeatureConfig::maxThreads() const {
+	return ModuleConfig::checkParam(mMaxThreads, 0, INT_MAX, "maxThreads");
+}
+
+/// <summary>
+/// The page is split into (at most) #keypoints/minKeyPointsPerStripe
+/// stripes whose ORB descriptors are computed concurrently.
+/// </summary>
+/// <param name="minKeyPoints">The minimum number of key points per stripe.</param>
+void SuperPixelFeatureConfig::setMinKeyPointsPerStripe(int minKeyPoints) {
+	mMinKeyPointsPerStripe = minKeyPoints;
+}
+
+int SuperPixelFeatureConfig::minKeyPointsPerStripe() const {
+	return ModuleConfig::checkParam(mMinKeyPointsPerStripe, 1, INT_MAX, "minKeyPointsPerStripe");
+}
+
 // SuperPixelFeature --------------------------------------------------------------------
 SuperPixelFeature::SuperPixelFeature(const cv::Mat & img, const PixelSet & set) {
 	mImg = img;
+	mPageImage = QSharedPointer<PageImage>::create(img);
 	mSet = set;
 	mConfig = QSharedPointer<SuperPixelFeatureConfig>::create();
 	
@@ -209,27 +244,27 @@ bool SuperPixelFeature::compute() {
 		return false;
 
 	Timer dt;
-	cv::Mat cImg;
-	cImg = IP::grayscale(mImg);
+	cv::Mat cImg = mPageImage->grayscale();
 
 	assert(cImg.type() == CV_8UC1);
 
+	// the class id links key points to their pixels
+	QVector<QSharedPointer<Pixel> > pixels = mSet.pixels();
 	std::vector<cv::KeyPoint> keypoints;
-	for (const QSharedPointer<const Pixel>& px : mSet.pixels()) {
-		assert(px);
-		keypoints.push_back(px->toKeyPoint());
+	for (int idx = 0; idx < pixels.size(); idx++) {
+		assert(pixels[idx]);
+		cv::KeyPoint kp = pixels[idx]->toKeyPoint();
+		kp.class_id = idx;
+		keypoints.push_back(kp);
 	}
 
 	mInfo << "# keypoints before ORB" << keypoints.size();
 
-
-	std::vector<cv::KeyPoint> kptsIn(keypoints.begin(), keypoints.end());
-
-	cv::Ptr<cv::ORB> features = cv::ORB::create();
-	features->compute(cImg, keypoints, mDescriptors);
+	QVector<int> removedIdx = computeDescriptors(cImg, keypoints, mDescriptors);
 
 	// remove SuperPixels that were removed during feature creation
-	syncSuperPixels(kptsIn, keypoints);
+	for (int ri : removedIdx)
+		mSet.remove(pixels[ri]);
 
 	mInfo << mDescriptors.rows << "features computed in" << dt;
 
@@ -237,7 +272,7 @@ bool SuperPixelFeature::compute() {
 }
 
 QSharedPointer<SuperPixelFeatureConfig> SuperPixelFeature::config() const {
-	return qSharedPointerDynamicCast<SuperPixelFeatureConfig>(mConfig);
+	return castConfig<SuperPixelFeatureConfig>();
 }
 
 cv::Mat SuperPixelFeature::draw(const cv::Mat & img) const {
@@ -277,39 +312,120 @@ PixelSet SuperPixelFeature::pixelSet() const {
 	return mSet;
 }
 
+/// <summary>
+/// Sets a shared page context (see PageImage).
+/// </summary>
+/// <param name="page">The page context of the source image.</param>
+void SuperPixelFeature::setPageImage(const QSharedPointer<PageImage>& page) {
+
+	assert(page && page->image().data == mImg.data);
+	mPageImage = page;
+}
+
 bool SuperPixelFeature::checkInput() const {
 	return !mImg.empty();
 }
 
 /// <summary>
-/// Synchronizes the super pixels with the features.
-/// This function removes SuperPixels from the PixelSet.
-/// This is needed since OpenCV removes keypoints that could
-/// not be computed. Using this function guarantees that the
-/// ith SuperPixel corresponds with the ith row of the feature
-/// matrix. NOTE: if we use descriptors such as SIFT which
-/// _add_ KeyPoints we're again out-of-sync.
+/// Computes the ORB descriptors of all key points.
+/// The image is split into horizontal stripes with the same number
+/// of key points. Each stripe (plus a margin of edgeThreshold + patchSize rows)
+/// is processed concurrently so the descriptors are the same as if
+/// the whole page was processed at once.
 /// </summary>
-/// <param name="keyPointsOld">The key points before feature computation.</param>
-/// <param name="keyPointsNew">The key points after feature computation (less than keyPointsOld).</param>
-void SuperPixelFeature::syncSuperPixels(const std::vector<cv::KeyPoint>& keyPointsOld, const std::vector<cv::KeyPoint>& keyPointsNew) {
+/// <param name="img">The grayscale image.</param>
+/// <param name="keyPoints">The key points (class_id = pixel index).</param>
+/// <param name="descriptors">The descriptors of all retained key points (in pixel order).</param>
+/// <returns>The pixel indexes of key points that were removed by ORB (e.g. at the image border).</returns>
+QVector<int> SuperPixelFeature::computeDescriptors(const cv::Mat & img, const std::vector<cv::KeyPoint>& keyPoints, cv::Mat & descriptors) const {
+
+	int numKeyPoints = (int)keyPoints.size();
+	int numStripes = qMax(1, numKeyPoints / config()->minKeyPointsPerStripe());
+	numStripes = qMin(numStripes, config()->maxThreads() > 0 ? config()->maxThreads() : cv::getNumThreads());
+
+	// sort key points top to bottom
+	std::vector<int> order(numKeyPoints);
+	for (int idx = 0; idx < numKeyPoints; idx++)
+		order[idx] = idx;
+
+	std::stable_sort(order.begin(), order.end(), [&](int l, int r) {
+		return keyPoints[l].pt.y < keyPoints[r].pt.y;
+	});
+
+	std::vector<std::vector<cv::KeyPoint> > stripeKeyPoints(numStripes);
+	std::vector<cv::Mat> stripeDescriptors(numStripes);
+
+	Utils::parallelFor(numStripes, [&](int sIdx) {
+
+		int bIdx = (int)((int64)sIdx * numKeyPoints / numStripes);
+		int eIdx = (int)((int64)(sIdx + 1) * numKeyPoints / numStripes);
+
+		if (bIdx == eIdx)
+			return;
+
+		cv::Ptr<cv::ORB> orb = cv::ORB::create();
+		
+		// key points within this margin are filtered by ORB
+		int margin = orb->getEdgeThreshold() + orb->getPatchSize();
+		int y0 = qMax(0, (int)std::floor(keyPoints[order[bIdx]].pt.y) - margin);
+		int y1 = qMin(img.rows, (int)std::ceil(keyPoints[order[eIdx - 1]].pt.y) + margin + 1);
 
-	// sync keypoints
-	QVector<cv::KeyPoint> kptsOut = QVector<cv::KeyPoint>::fromStdVector(keyPointsNew);
+		std::vector<cv::KeyPoint>& kpts = stripeKeyPoints[sIdx];
+		for (int idx = bIdx; idx < eIdx; idx++) {
+			cv::KeyPoint kp = keyPoints[order[idx]];
+			kp.pt.y -= y0;
+			kpts.push_back(kp);
+		}
 
-	QList<int> removeIdx;
-	for (size_t idx = 0; idx < keyPointsOld.size(); idx++) {
+		orb->compute(img.rowRange(y0, y1), kpts, stripeDescriptors[sIdx]);
 
+	}, config()->maxThreads());
 
-		int kIdx = kptsOut.indexOf(keyPointsOld[idx]);
-		if (kIdx == -1)
-			removeIdx << (int)idx;
+	// collect descriptors in pixel order
+	std::vector<const uchar*> rows(numKeyPoints, 0);
+	cv::Mat rowDesc;
+
+	for (int sIdx = 0; sIdx < numStripes; sIdx++) {
+
+		const cv::Mat& sd = stripeDescriptors[sIdx];
+		const std::vector<cv::KeyPoint>& kpts = stripeKeyPoints[sIdx];
+		assert(sd.rows == (int)kpts.size() || sd.empty());
+
+		for (int rIdx = 0; rIdx < sd.rows; rIdx++)
+			rows[kpts[rIdx].class_id] = sd.ptr(rIdx);
+
+		if (!sd.empty())
+			rowDesc = sd;
+	}
+
+	int numRetained = 0;
+	for (int idx = 0; idx < numKeyPoints; idx++) {
+		if (rows[idx])
+			numRetained++;
 	}
 
-	qSort(removeIdx.begin(), removeIdx.end(), qGreater<int>());
-	for (int ri : removeIdx) 
-		mSet.remove(mSet.pixels()[ri]);
+	if (numRetained == 0) {
+		descriptors = cv::Mat();
+	}
+	else {
+		descriptors = cv::Mat(numRetained, rowDesc.cols, rowDesc.type());
+		
+		int dIdx = 0;
+		for (int idx = 0; idx < numKeyPoints; idx++) {
+
+			if (rows[idx])
+				memcpy(descriptors.ptr(dIdx++), rows[idx], descriptors.step[0]);
+		}
+	}
+
+	// removed key points in descending order
+	QVector<int> removedIdx;
+	for (int idx = numKeyPoints - 1; idx >= 0; idx--) {
+		if (!rows[idx])
+			removedIdx << idx;
+	}
 
+	return removedIdx;
 }
 
 }
\ No newline at end of file
@@ -34,6 +34,7 @@
 
 #include "BaseModule.h"
 #include "PixelSet.h"
+#include "PageImage.h"
 
 #pragma warning(push, 0)	// no warnings from includes
 
@@ -58,8 +59,17 @@ public:
 
 	virtual QString toString() const override;
 
+	void setMaxThreads(int maxThreads);
+	int maxThreads() const;
+
+	void setMinKeyPointsPerStripe(int minKeyPoints);
+	int minKeyPointsPerStripe() const;
+
 protected:
 
+	int mMaxThreads = 0;				// maximum number of image stripes processed concurrently (0 = all cores)
+	int mMinKeyPointsPerStripe = 500;	// pages with less key points are not split
+
 	//void load(const QSettings& settings) override;
 	//void save(QSettings& settings) const override;
 };
@@ -79,15 +89,18 @@ public:
 	cv::Mat features() const;
 	PixelSet pixelSet() const;
 
+	void setPageImage(const QSharedPointer<PageImage>& page);
+
 private:
 	cv::Mat mImg;
+	QSharedPointer<PageImage> mPageImage;
 	PixelSet mSet;
 
 	// output
 	cv::Mat mDescriptors;
 
 	bool checkInput() const override;
-	void syncSuperPixels(const std::vector<cv::KeyPoint>& keyPointsOld, const std::vector<cv::KeyPoint>& keyPointsNew);
+	QVector<int> computeDescriptors(const cv::Mat& img, const std::vector<cv::KeyPoint>& keyPoints, cv::Mat& descriptors) const;
 };
 
 class DllCoreExport SuperPixelClassifierConfig : public ModuleConfig {
@@ -123,8 +136,11 @@ public:
 	void setModel(const QSharedPointer<SuperPixelModel>& model);
 	PixelSet pixelSet() const;
 
+	void setPageImage(const QSharedPointer<PageImage>& page);
+
 private:
 	cv::Mat mImg;
+	QSharedPointer<PageImage> mPageImage;
 	PixelSet mSet;
 	QSharedPointer<SuperPixelModel> mModel;
 
@@ -38,6 +38,9 @@
 #include "ImageProcessor.h"
 
 #include "SuperPixel.h"
+#include "SuperPixelClassification.h"
+#include "RandomTrees.h"
+#include "PageParser.h"
 #include "Elements.h"
 #include "ElementsHelper.h"
 #include "Algorithms.h"
@@ -48,6 +51,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QDir>
+#include <QLockFile>
 
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -57,6 +61,8 @@
 #include <opencv2/features2d.hpp>
 #include <opencv2/ml.hpp>
 
+#include <algorithm>
+#include <vector>
 #pragma warning(pop)
 
 namespace rdf {
@@ -172,8 +178,7 @@ bool SuperPixelLabeler::compute() {
 		return false;
 	}
 
-	QImage labelImgQt = createLabelImage(mImgRect);
-	cv::Mat labelImg = Image::qImage2Mat(labelImgQt);
+	cv::Mat labelImg = createLabelMat(mImgRect);
 	
 	if (!mBlobs.empty())
 		mSet = labelBlobs(labelImg, mBlobs);
@@ -184,7 +189,7 @@ bool SuperPixelLabeler::compute() {
 }
 
 QSharedPointer<SuperPixelLabelerConfig> SuperPixelLabeler::config() const {
-	return qSharedPointerDynamicCast<SuperPixelLabelerConfig>(mConfig);
+	return castConfig<SuperPixelLabelerConfig>();
 }
 
 cv::Mat SuperPixelLabeler::draw(const cv::Mat& img, bool drawPixels) const {
@@ -256,73 +261,76 @@ QImage SuperPixelLabeler::createLabelImage(const Rect & imgRect, bool visualize)
 	if (mManager.isEmpty())
 		mWarning << "label manager is empty...";
 
-	LabelInfo bgLabel = mManager.find(mGlobalName);
+	QImage img(imgRect.size().toQSize(), QImage::Format_RGB888);
+	img.fill(backgroundLabel().color());
 
-	if (bgLabel.isNull())
-		bgLabel = mManager.backgroundLabel();
+	QPainter p(&img);
+	// this allows for overlaying multiple classes
+	//p.setCompositionMode(QPainter::CompositionMode_Plus);
 
-	QImage img(imgRect.size().toQSize(), QImage::Format_RGB888);
-	img.fill(bgLabel.color());
+	for (auto region : labelRegions()) {
+			
+		LabelInfo ll = mManager.find(*region);
 
-	QVector<QSharedPointer<Region>> allRegions;
-	
-	// if there are no layers specified, the label regions are drawn in the order in which they occur in the xml source
-	if (!mPage || mPage->layers().isEmpty()) {
-		allRegions = Region::allRegions(mGtRegion.data());
-	}
-	// otherwise, regions are drawn in order of their layer zIndex
-	else {
-		// layers should be sorted by zIndex
-		mPage->sortLayers(true);
-		allRegions.append(mPage->defaultLayer()->regions());
-		for (const auto& layer : mPage->layers()) {
-			allRegions.append(layer->regions());
-		}
+		// draw the current region
+		QColor labelC = (!visualize) ? ll.color() : ll.visColor();
+		p.setPen(labelC);
+		p.setBrush(labelC);
+		region->polygon().draw(p);
 	}
 
-	QMap<int, QVector<QSharedPointer<Region> > > mapRegions;
+	if (visualize)
+		mManager.draw(p);
 
-	for (auto region : allRegions) {
+	return img;
+}
 
-		if (!region)
-			continue;
+/// <summary>
+/// Creates a CV_16UC1 label image that holds the label id of each pixel.
+/// The region polygons are rasterized with scanlines (see IP::fillPolygon).
+/// The image is split into bands that are rasterized concurrently.
+/// Each band draws all regions in z-order, so overlapping
+/// regions are resolved as in createLabelImage.
+/// </summary>
+/// <param name="imgRect">The image rectangle.</param>
+/// <returns>The label image.</returns>
+cv::Mat SuperPixelLabeler::createLabelMat(const Rect & imgRect) const {
 
-		LabelInfo ll = mManager.find(*region);
+	if (mManager.isEmpty())
+		mWarning << "label manager is empty...";
 
-		if (ll == LabelInfo())
-			continue;
+	cv::Mat labelImg(imgRect.size().toCvSize(), CV_16UC1, cv::Scalar(backgroundLabel().id()));
 
-		if (ll.isNull()) {
-			qDebug() << "could not find region: " << RegionManager::instance().typeName(region->type());
-			continue;
-		}
-		
-		mapRegions[ll.zIndex()] << region;
+	QVector<QPolygonF> polys;
+	QVector<QRectF> boxes;
+	QVector<int> ids;
+
+	for (auto region : labelRegions()) {
+
+		QPolygonF poly = region->polygon().polygon();
+		polys << poly;
+		boxes << poly.boundingRect();
+		ids << mManager.find(*region).id();
 	}
 
+	const int bandHeight = 64;
+	int numBands = (labelImg.rows + bandHeight - 1) / bandHeight;
 
-	QPainter p(&img);
-	// this allows for overlaying multiple classes
-	//p.setCompositionMode(QPainter::CompositionMode_Plus);
+	Utils::parallelFor(numBands, [&](int bIdx) {
 
-	for (QVector<QSharedPointer<Region> > cRegions : mapRegions) {
+		int y0 = bIdx * bandHeight;
+		int y1 = qMin(y0 + bandHeight, labelImg.rows);
 
-		for (auto region : cRegions) {
-			
-			LabelInfo ll = mManager.find(*region);
+		for (int idx = 0; idx < polys.size(); idx++) {
 
-			// draw the current region
-			QColor labelC = (!visualize) ? ll.color() : ll.visColor();
-			p.setPen(labelC);
-			p.setBrush(labelC);
-			region->polygon().draw(p);
-		}
-	}
+			if (boxes[idx].bottom() < y0 || boxes[idx].top() > y1)
+				continue;
 
-	if (visualize)
-		mManager.draw(p);
+			IP::fillPolygon(polys[idx], labelImg, ids[idx], y0, y1);
+		}
+	});
 
-	return img;
+	return labelImg;
 }
 
 PixelSet SuperPixelLabeler::set() const {
@@ -372,25 +380,136 @@ QString SuperPixelLabeler::parseLabel(const QString & filePath) const {
 	return labelInfo.name();
 }
 
+LabelInfo SuperPixelLabeler::backgroundLabel() const {
+
+	LabelInfo bgLabel = mManager.find(mGlobalName);
+
+	if (bgLabel.isNull())
+		bgLabel = mManager.backgroundLabel();
+
+	return bgLabel;
+}
+
+/// <summary>
+/// Returns all GT regions that have a label in the order they are drawn.
+/// Regions are sorted by their label's zIndex. If there are no layers 
+/// specified, regions with the same zIndex are drawn in the order in 
+/// which they occur in the xml source. Otherwise in order of their layer zIndex.
+/// </summary>
+/// <returns>The labeled regions.</returns>
+QVector<QSharedPointer<Region> > SuperPixelLabeler::labelRegions() const {
+
+	QVector<QSharedPointer<Region>> allRegions;
+	
+	// if there are no layers specified, the label regions are drawn in the order in which they occur in the xml source
+	if (!mPage || mPage->layers().isEmpty()) {
+		allRegions = Region::allRegions(mGtRegion.data());
+	}
+	// otherwise, regions are drawn in order of their layer zIndex
+	else {
+		// layers should be sorted by zIndex
+		mPage->sortLayers(true);
+		allRegions.append(mPage->defaultLayer()->regions());
+		for (const auto& layer : mPage->layers()) {
+			allRegions.append(layer->regions());
+		}
+	}
+
+	QMap<int, QVector<QSharedPointer<Region> > > mapRegions;
+
+	for (auto region : allRegions) {
+
+		if (!region)
+			continue;
+
+		LabelInfo ll = mManager.find(*region);
+
+		if (ll == LabelInfo())
+			continue;
+
+		if (ll.isNull()) {
+			qDebug() << "could not find region: " << RegionManager::instance().typeName(region->type());
+			continue;
+		}
+		
+		mapRegions[ll.zIndex()] << region;
+	}
+
+	QVector<QSharedPointer<Region> > regions;
+	for (const QVector<QSharedPointer<Region> >& cRegions : mapRegions)
+		regions << cRegions;
+
+	return regions;
+}
+
 bool SuperPixelLabeler::checkInput() const {
 
 	return !mBlobs.empty();
 }
 
+/// <summary>
+/// Counts the label ids of a region and
+/// returns the most frequent one.
+/// </summary>
+class LabelCounter {
+
+public:
+	void add(int id) {
+
+		// GT regions are large, hence most super pixels see 1-3 labels
+		for (QPair<int, int>& c : mCounts) {
+			if (c.first == id) {
+				c.second++;
+				mNumValues++;
+				return;
+			}
+		}
+
+		mCounts << QPair<int, int>(id, 1);
+		mNumValues++;
+	}
+
+	/// <summary>
+	/// Returns the majority label.
+	/// </summary>
+	/// <param name="minRatio">The minimum fraction of values the majority label must have.</param>
+	/// <returns>The label id or -1 if no label is consistent enough.</returns>
+	int majority(double minRatio = 0.0) const {
+
+		int bestIdx = -1;
+		for (int idx = 0; idx < mCounts.size(); idx++) {
+			if (bestIdx == -1 || mCounts[idx].second > mCounts[bestIdx].second)
+				bestIdx = idx;
+		}
+
+		if (bestIdx == -1 || mCounts[bestIdx].second < minRatio * mNumValues)
+			return -1;
+
+		return mCounts[bestIdx].first;
+	}
+
+private:
+	QVector<QPair<int, int> > mCounts;
+	int mNumValues = 0;
+};
+
 PixelSet SuperPixelLabeler::labelBlobs(const cv::Mat & labelImg, const QVector<QSharedPointer<MserBlob> >& blobs) const {
 	
+	assert(labelImg.type() == CV_16UC1);
 	PixelSet set;
 
 	for (const QSharedPointer<MserBlob>& cb : blobs) {
 
 		assert(cb);
-		Rect r = cb->bbox().clipped(labelImg.size());
-		cv::Mat labelBBox = labelImg(r.toCvRect());
-		cv::Mat mask = cb->toBinaryMask();
 
 		// find the blob's label
-		QColor col = IP::statMomentColor(labelBBox, mask);
-		int id = LabelInfo::color2Id(col);
+		LabelCounter lc;
+		for (const cv::Point& pt : cb->pts()) {
+			if (pt.x >= 0 && pt.y >= 0 && pt.x < labelImg.cols && pt.y < labelImg.rows)
+				lc.add(labelImg.at<unsigned short>(pt));
+		}
+
+		int id = lc.majority();
 
 		// assign ground truth & convert to pixel
 		QSharedPointer<Pixel> px = cb->toPixel();
@@ -402,43 +521,425 @@ PixelSet SuperPixelLabeler::labelBlobs(const cv::Mat & labelImg, const QVector<Q
 	return set;
 }
 
+/// <summary>
+/// Assigns the majority GT label to each pixel.
+/// The label ids within a pixel's ellipse are counted
+/// for all pixels concurrently. Pixels whose majority label covers
+/// less than 60% of the ellipse have an ambiguous label and are removed.
+/// </summary>
+/// <param name="labelImg">The label image (see createLabelMat).</param>
+/// <param name="set">The pixels.</param>
+/// <returns>The labeled pixels (without ambiguous pixels).</returns>
 PixelSet SuperPixelLabeler::labelPixels(const cv::Mat & labelImg, const PixelSet& set) const {
 
-	PixelSet setL;
-	int rCnt = 0;
+	assert(labelImg.type() == CV_16UC1);
 
-	for (const auto& px : set.pixels()) {
+	QVector<QSharedPointer<Pixel> > pixels = set.pixels();
+	QVector<int> ids(pixels.size(), -1);
+	int* idPtr = ids.data();
 
-		Rect r = px->bbox().clipped(labelImg.size());
-		cv::Mat labelBBox = labelImg(r.toCvRect());
-		cv::Mat mask = px->toBinaryMask(r);
+	Utils::parallelFor(pixels.size(), [&](int pIdx) {
 
-		// clip mask
-		if (r != px->bbox())
-			mask = mask(Rect(Vector2D(), r.size()).toCvRect());
+		const QSharedPointer<Pixel>& px = pixels[pIdx];
+		cv::Rect r = px->bbox().toCvRect() & cv::Rect(0, 0, labelImg.cols, labelImg.rows);
 
-		// find the blob's label
-		QColor col1 = IP::statMomentColor(labelBBox, mask, 0.2);
-		QColor col2 = IP::statMomentColor(labelBBox, mask, 0.8);
+		const Ellipse e = px->ellipse();
+		double ca = std::cos(e.angle());
+		double sa = std::sin(e.angle());
+		double ax = e.axis().x();
+		double ay = e.axis().y();
+		bool degenerated = ax <= 0 || ay <= 0;
+
+		LabelCounter lc;
+
+		for (int y = r.y; y < r.y + r.height; y++) {
+
+			const unsigned short* lPtr = labelImg.ptr<unsigned short>(y);
+			double dy = y + 0.5 - e.center().y();
+
+			for (int x = r.x; x < r.x + r.width; x++) {
+
+				double dx = x + 0.5 - e.center().x();
+				double u = (dx * ca + dy * sa) / ax;
+				double v = (-dx * sa + dy * ca) / ay;
+
+				if (degenerated || u * u + v * v <= 1.0)
+					lc.add(lPtr[x]);
+			}
+		}
 
 		// if less than 60% of the blob's area is consistent, we reject the blob
-		if (col1 != col2) {
+		idPtr[pIdx] = lc.majority(0.6);
+	});
+
+	PixelSet setL;
+	int rCnt = 0;
+
+	for (int pIdx = 0; pIdx < pixels.size(); pIdx++) {
+
+		if (ids[pIdx] == -1) {
 			rCnt++;
 			continue;
 		}
 
-		// col1 == col2
-		int id = LabelInfo::color2Id(col1);
-
 		// assign ground truth
-		QSharedPointer<PixelLabel> l = px->label();
-		l->setTrueLabel(mManager.find(id));
-		setL << px;
+		QSharedPointer<PixelLabel> l = pixels[pIdx]->label();
+		l->setTrueLabel(mManager.find(ids[pIdx]));
+		setL << pixels[pIdx];
 	}
 
 	qDebug() << rCnt << "rejected because they have an ambigous GT class";
 
-	return set;
+	return setL;
+}
+
+// FeatureReservoir --------------------------------------------------------------------
+/// <summary>
+/// Initializes a new instance of the <see cref="FeatureReservoir"/> class.
+/// </summary>
+/// <param name="capacity">The maximum number of features per label (0 = unbounded).</param>
+/// <param name="seed">The random seed.</param>
+FeatureReservoir::FeatureReservoir(int capacity, uint64 seed) : mCapacity(capacity), mRng(seed) {
+}
+
+/// <summary>
+/// Adds all descriptors of the collection to the reservoir of its label.
+/// </summary>
+/// <param name="fc">The feature collection (e.g. of a single page).</param>
+void FeatureReservoir::add(const FeatureCollection& fc) {
+
+	int idx = labelIndex(fc.label());
+	cv::Mat src = fc.descriptors();
+	cv::Mat desc = mSamples[idx].descriptors();
+	int sIdx = 0;
+
+	// fill the reservoir
+	int numFill = mCapacity > 0 ? qMin(mCapacity - desc.rows, src.rows) : src.rows;
+	if (numFill > 0) {
+		desc.push_back(src.rowRange(0, numFill));
+		sIdx = numFill;
+	}
+
+	// replace random samples
+	double numSeen = mNumSeen[idx] + sIdx;
+	for (; sIdx < src.rows; sIdx++) {
+
+		numSeen++;
+		double rIdx = std::floor(mRng.uniform(0.0, numSeen));
+
+		if (rIdx < mCapacity)
+			src.row(sIdx).copyTo(desc.row((int)rIdx));
+	}
+
+	mNumSeen[idx] = numSeen;
+	mSamples[idx].setDescriptors(desc);
+}
+
+/// <summary>
+/// Merges the reservoir of another worker.
+/// The merged reservoir is a uniform sample of
+/// all features seen by both reservoirs.
+/// </summary>
+/// <param name="other">The other reservoir.</param>
+void FeatureReservoir::merge(const FeatureReservoir& other) {
+
+	for (int oIdx = 0; oIdx < other.mSamples.size(); oIdx++) {
+
+		const FeatureCollection& ofc = other.mSamples[oIdx];
+		int idx = labelIndex(ofc.label());
+
+		cv::Mat descA = mSamples[idx].descriptors();
+		cv::Mat descB = ofc.descriptors();
+
+		// both reservoirs hold all their features
+		if (mCapacity <= 0 || descA.rows + descB.rows <= mCapacity) {
+			descA.push_back(descB);
+			mSamples[idx].setDescriptors(descA);
+			mNumSeen[idx] += other.mNumSeen[oIdx];
+			continue;
+		}
+
+		// draw without replacement from the union:
+		// the source is chosen proportional to the number of features it has seen
+		std::vector<int> idxA = shuffledIndices(descA.rows);
+		std::vector<int> idxB = shuffledIndices(descB.rows);
+		double remA = mNumSeen[idx];
+		double remB = other.mNumSeen[oIdx];
+		size_t cA = 0, cB = 0;
+
+		cv::Mat desc(mCapacity, descA.cols, descA.type());
+		for (int rIdx = 0; rIdx < mCapacity; rIdx++) {
+
+			if (mRng.uniform(0.0, remA + remB) < remA) {
+				descA.row(idxA[cA++]).copyTo(desc.row(rIdx));
+				remA--;
+			}
+			else {
+				descB.row(idxB[cB++]).copyTo(desc.row(rIdx));
+				remB--;
+			}
+		}
+
+		mSamples[idx].setDescriptors(desc);
+		mNumSeen[idx] += other.mNumSeen[oIdx];
+	}
+}
+
+/// <summary>
+/// Returns the sampled features of all labels.
+/// </summary>
+FeatureCollectionManager FeatureReservoir::toManager() const {
+
+	FeatureCollectionManager fcm;
+	for (const FeatureCollection& fc : mSamples)
+		fcm.add(fc);
+
+	return fcm;
+}
+
+int FeatureReservoir::labelIndex(const LabelInfo& label) {
+
+	for (int idx = 0; idx < mSamples.size(); idx++) {
+		if (mSamples[idx].label() == label)
+			return idx;
+	}
+
+	mSamples << FeatureCollection(cv::Mat(), label);
+	mNumSeen << 0.0;
+
+	return mSamples.size() - 1;
+}
+
+std::vector<int> FeatureReservoir::shuffledIndices(int size) {
+
+	std::vector<int> indices(size);
+	for (int idx = 0; idx < size; idx++)
+		indices[idx] = idx;
+
+	cv::randShuffle(indices, 1.0, &mRng);
+	return indices;
+}
+
+// FeatureCollectorConfig --------------------------------------------------------------------
+FeatureCollectorConfig::FeatureCollectorConfig() : ModuleConfig("Feature Collector") {
+}
+
+/// <summary>
+/// Sets the maximum number of pages that are processed concurrently (0 = all cores).
+/// </summary>
+/// <param name="maxThreads">The maximum number of threads.</param>
+void FeatureCollectorConfig::setMaxThreads(int maxThreads) {
+	mMaxThreads = maxThreads;
+}
+
+int FeatureCollectorConfig::maxThreads() const {
+	return ModuleConfig::checkParam(mMaxThreads, 0, INT_MAX, "maxThreads");
+}
+
+/// <summary>
+/// Classes with less features are dropped.
+/// </summary>
+/// <param name="numFeatures">The minimum number of features per class.</param>
+void FeatureCollectorConfig::setMinNumFeaturesPerClass(int numFeatures) {
+	mMinNumFeaturesPerClass = numFeatures;
+}
+
+int FeatureCollectorConfig::minNumFeaturesPerClass() const {
+	return ModuleConfig::checkParam(mMinNumFeaturesPerClass, 0, INT_MAX, "minNumFeaturesPerClass");
+}
+
+/// <summary>
+/// Sets the reservoir size i.e. the maximum number of features collected per class.
+/// </summary>
+/// <param name="numFeatures">The maximum number of features per class.</param>
+void FeatureCollectorConfig::setMaxNumFeaturesPerClass(int numFeatures) {
+	mMaxNumFeaturesPerClass = numFeatures;
+}
+
+int FeatureCollectorConfig::maxNumFeaturesPerClass() const {
+	return ModuleConfig::checkParam(mMaxNumFeaturesPerClass, 1, INT_MAX, "maxNumFeaturesPerClass");
+}
+
+QString FeatureCollectorConfig::toString() const {
+	return ModuleConfig::toString();
+}
+
+void FeatureCollectorConfig::load(const QSettings & settings) {
+
+	mMaxThreads = settings.value("maxThreads", maxThreads()).toInt();
+	mMinNumFeaturesPerClass = settings.value("minNumFeaturesPerClass", minNumFeaturesPerClass()).toInt();
+	mMaxNumFeaturesPerClass = settings.value("maxNumFeaturesPerClass", maxNumFeaturesPerClass()).toInt();
+}
+
+void FeatureCollectorConfig::save(QSettings & settings) const {
+
+	settings.setValue("maxThreads", maxThreads());
+	settings.setValue("minNumFeaturesPerClass", minNumFeaturesPerClass());
+	settings.setValue("maxNumFeaturesPerClass", maxNumFeaturesPerClass());
+}
+
+// FeatureCollector --------------------------------------------------------------------
+/// <summary>
+/// Initializes a new instance of the <see cref="FeatureCollector"/> class.
+/// The GT of each image is loaded from the PAGE XML next to it.
+/// </summary>
+/// <param name="imagePaths">The image paths of the GT pages.</param>
+/// <param name="manager">The label manager.</param>
+FeatureCollector::FeatureCollector(const QStringList& imagePaths, const LabelManager& manager) {
+
+	mImagePaths = imagePaths;
+	mManager = manager;
+	mConfig = QSharedPointer<FeatureCollectorConfig>::create();
+	mConfig->loadSettings();
+}
+
+bool FeatureCollector::isEmpty() const {
+	return mImagePaths.isEmpty();
+}
+
+bool FeatureCollector::compute() {
+
+	if (!checkInput())
+		return false;
+
+	Timer dt;
+
+	int numPages = mImagePaths.size();
+	int numWorkers = config()->maxThreads() > 0 ? config()->maxThreads() : cv::getNumThreads();
+	numWorkers = qBound(1, numWorkers, numPages);
+
+	// each worker owns its reservoir -> no locking while collecting
+	std::vector<FeatureReservoir> reservoirs;
+	for (int idx = 0; idx < numWorkers; idx++)
+		reservoirs.push_back(FeatureReservoir(config()->maxNumFeaturesPerClass(), 42 + idx));
+	std::vector<int> numProcessed(numWorkers, 0);
+
+	Utils::parallelFor(numWorkers, [&](int wIdx) {
+
+		for (int idx = wIdx; idx < numPages; idx += numWorkers) {
+
+			FeatureCollectionManager fcm = collectPage(mImagePaths[idx]);
+
+			if (fcm.isEmpty())
+				continue;
+
+			// keep all features of the page (the reservoir only keeps a sample)
+			if (!mCachePath.isEmpty())
+				fcm.appendToCache(mCachePath);
+
+			for (const FeatureCollection& fc : fcm.collection()) {
+
+				// unknown features are never trained
+				if (fc.label() != LabelInfo::unknownLabel())
+					reservoirs[wIdx].add(fc);
+			}
+
+			numProcessed[wIdx]++;
+		}
+	});
+
+	// merge per-worker samples
+	FeatureReservoir& merged = reservoirs[0];
+	for (int idx = 1; idx < numWorkers; idx++)
+		merged.merge(reservoirs[idx]);
+
+	mNumPagesProcessed = 0;
+	for (int np : numProcessed)
+		mNumPagesProcessed += np;
+
+	mFeatureManager = merged.toManager();
+	mFeatureManager.normalize(config()->minNumFeaturesPerClass(), config()->maxNumFeaturesPerClass());
+
+	mInfo << "features of" << mNumPagesProcessed << "/" << numPages << "pages collected with" 
+		<< numWorkers << "threads in" << dt;
+
+	return true;
+}
+
+QSharedPointer<FeatureCollectorConfig> FeatureCollector::config() const {
+	return castConfig<FeatureCollectorConfig>();
+}
+
+QString FeatureCollector::toString() const {
+	return mFeatureManager.toString();
+}
+
+/// <summary>
+/// If set, the features of each page are appended
+/// to this binary feature cache while collecting
+/// (see FeatureCollectionManager::appendToCache).
+/// </summary>
+/// <param name="cachePath">The feature cache path.</param>
+void FeatureCollector::setCachePath(const QString & cachePath) {
+	mCachePath = cachePath;
+}
+
+QString FeatureCollector::cachePath() const {
+	return mCachePath;
+}
+
+FeatureCollectionManager FeatureCollector::featureManager() const {
+	return mFeatureManager;
+}
+
+int FeatureCollector::numPagesProcessed() const {
+	return mNumPagesProcessed;
+}
+
+bool FeatureCollector::checkInput() const {
+	return !isEmpty();
+}
+
+/// <summary>
+/// Computes the labeled features of a single page.
+/// </summary>
+/// <param name="imagePath">The image path.</param>
+/// <returns>The page's features (empty if the page could not be processed).</returns>
+FeatureCollectionManager FeatureCollector::collectPage(const QString & imagePath) const {
+
+	QImage qImg = Image::load(imagePath);
+
+	if (qImg.isNull()) {
+		mWarning << "could not load image from" << imagePath;
+		return FeatureCollectionManager();
+	}
+
+	cv::Mat img = Image::qImage2Mat(qImg);
+
+	PageXmlParser parser;
+	parser.read(PageXmlParser::imagePathToXmlPath(imagePath), false, true);
+
+	if (parser.loadStatus() != PageXmlParser::status_ok || !parser.page()) {
+		mWarning << "could not load GT for" << imagePath;
+		return FeatureCollectionManager();
+	}
+
+	// compute super pixels
+	SuperPixel sp(img);
+
+	if (!sp.compute()) {
+		mWarning << "could not compute super pixels for" << imagePath;
+		return FeatureCollectionManager();
+	}
+
+	// feed the label lookup
+	SuperPixelLabeler spl(sp.pixelSet(), Rect(img));
+	spl.setLabelManager(mManager);
+	spl.setFilePath(imagePath);
+	spl.setRootRegion(parser.page()->rootRegion());
+
+	if (!spl.compute()) {
+		mWarning << "could not compute SuperPixel labeling for" << imagePath;
+		return FeatureCollectionManager();
+	}
+
+	SuperPixelFeature spf(img, spl.set());
+	if (!spf.compute()) {
+		mWarning << "could not compute SuperPixel features for" << imagePath;
+		return FeatureCollectionManager();
+	}
+
+	return FeatureCollectionManager(spf.features(), spf.pixelSet());
 }
 
 // FeatureCollection --------------------------------------------------------------------
@@ -464,10 +965,10 @@ QJsonObject FeatureCollection::toJson(const QString& filePath) const {
 
 		// write data to external file
 		QString fp = Utils::createFilePath(filePath, "-" + Utils::timeStampFileName(mLabel.name(), ""), "rdf");
-		Image::writeMat(mDesc, fp);
+		Image::writeMatBinary(mDesc, fp);
 
 		QFileInfo fi(fp);
-		jo.insert("descriptors", Image::matToJsonExtern(mDesc, fi.fileName()));
+		jo.insert("descriptors", Image::matToJsonBinary(mDesc, fi.fileName()));
 	}
 
 	return jo;
@@ -567,6 +1068,10 @@ void FeatureCollectionManager::write(const QString & filePath) const {
 
 FeatureCollectionManager FeatureCollectionManager::read(const QString & filePath) {
 
+	// binary feature cache (see appendToCache)
+	if (isCache(filePath))
+		return readCache(filePath);
+
 	FeatureCollectionManager manager;
 
 	// parse the feature collections
@@ -585,6 +1090,194 @@ FeatureCollectionManager FeatureCollectionManager::read(const QString & filePath
 	return manager;
 }
 
+static const char featureCacheMagic[4] = { 'R', 'D', 'F', 'C' };
+
+/// <summary>
+/// Appends all feature collections to a binary feature cache.
+/// Each collection is stored as chunk (magic, label, rows, cols, type, raw descriptors).
+/// Hence, features of a training set can be collected without
+/// re-writing the whole cache for every image. Several workers
+/// (threads or processes) may append to the same cache concurrently.
+/// </summary>
+/// <param name="cachePath">The cache file path.</param>
+/// <returns>true if all collections were appended.</returns>
+bool FeatureCollectionManager::appendToCache(const QString & cachePath) const {
+
+	// create the chunks first so that the file is locked shortly
+	QByteArray ba;
+
+	for (const FeatureCollection& fc : mCollection) {
+
+		// nothing to cache (readCache skips empty chunks anyway)
+		if (fc.numDescriptors() == 0)
+			continue;
+
+		QJsonObject jo;
+		fc.label().toJson(jo);
+		QByteArray label = QJsonDocument(jo).toJson(QJsonDocument::Compact);
+
+		cv::Mat desc = fc.descriptors();
+		if (!desc.isContinuous())
+			desc = desc.clone();
+
+		qint32 header[4] = { label.size(), desc.rows, desc.cols, desc.type() };
+
+		ba.append(featureCacheMagic, 4);
+		ba.append((const char*)header, sizeof(qint32));
+		ba.append(label);
+		ba.append((const char*)(header + 1), 3 * sizeof(qint32));
+		ba.append((const char*)desc.data, (int)(desc.total() * desc.elemSize()));
+	}
+
+	if (ba.isEmpty())
+		return true;
+
+	QLockFile lock(cachePath + ".lock");
+
+	if (!lock.lock()) {
+		qCritical() << "cannot lock" << cachePath;
+		return false;
+	}
+
+	QFile file(cachePath);
+	if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+		qCritical() << "cannot open or write to" << cachePath;
+		return false;
+	}
+
+	bool ok = file.write(ba) == ba.size();
+
+	if (!ok)
+		qCritical() << "could not append features to" << cachePath;
+
+	return ok;
+}
+
+/// <summary>
+/// Reads a binary feature cache (see appendToCache).
+/// Chunks with the same label are merged and empty chunks
+/// are skipped. The descriptors are read directly into one
+/// matrix per label.
+/// </summary>
+/// <param name="cachePath">The cache file path.</param>
+/// <returns>The feature collections.</returns>
+FeatureCollectionManager FeatureCollectionManager::readCache(const QString & cachePath) {
+
+	Timer dt;
+	FeatureCollectionManager manager;
+
+	QFile file(cachePath);
+	if (!file.open(QIODevice::ReadOnly)) {
+		qCritical() << "could not read features from" << cachePath;
+		return manager;
+	}
+
+	struct Chunk {
+		int collectionIdx;
+		qint64 offset;
+		int rows;
+	};
+
+	// first pass: index the chunks
+	QVector<Chunk> chunks;
+	QVector<int> numRows;
+	QVector<cv::Mat> descs;
+
+	while (!file.atEnd()) {
+
+		char magic[4];
+		qint32 labelSize = 0;
+
+		if (file.read(magic, 4) != 4 || !std::equal(magic, magic + 4, featureCacheMagic) ||
+			file.read((char*)&labelSize, sizeof(labelSize)) != (qint64)sizeof(labelSize) || labelSize < 0) {
+			qCritical() << "illegal chunk in feature cache" << cachePath;
+			return FeatureCollectionManager();
+		}
+
+		QJsonObject jo = QJsonDocument::fromJson(file.read(labelSize)).object();
+		FeatureCollection fc(cv::Mat(), LabelInfo::fromJson(jo.value(LabelInfo::jsonKey()).toObject()));
+
+		qint32 header[3];	// rows, cols, type
+		if (file.read((char*)header, sizeof(header)) != (qint64)sizeof(header) ||
+			header[0] < 0 || header[1] < 0 || !Image::isValidMatType(header[2])) {
+			qCritical() << "illegal chunk in feature cache" << cachePath;
+			return FeatureCollectionManager();
+		}
+
+		// empty chunks have no descriptors (and possibly no type) - skip them
+		if (header[0] == 0 || header[1] == 0)
+			continue;
+
+		int idx = manager.mCollection.indexOf(fc);
+		if (idx == -1) {
+			idx = manager.mCollection.size();
+			manager.add(fc);
+			numRows << 0;
+			descs << cv::Mat(0, header[1], header[2]);
+		}
+		else if (descs[idx].cols != header[1] || descs[idx].type() != header[2]) {
+			qCritical() << "incompatible descriptors for" << fc.label().name() << "in" << cachePath;
+			return FeatureCollectionManager();
+		}
+
+		Chunk c;
+		c.collectionIdx = idx;
+		c.offset = file.pos();
+		c.rows = header[0];
+		chunks << c;
+		numRows[idx] += c.rows;
+
+		// skip the descriptors
+		qint64 nBytes = (qint64)c.rows * descs[idx].cols * descs[idx].elemSize();
+		if (!file.seek(file.pos() + nBytes) || file.pos() > file.size()) {
+			qCritical() << "truncated feature cache" << cachePath;
+			return FeatureCollectionManager();
+		}
+	}
+
+	// second pass: read the descriptors into their final matrices
+	for (int idx = 0; idx < descs.size(); idx++)
+		descs[idx] = cv::Mat(numRows[idx], descs[idx].cols, descs[idx].type());
+
+	QVector<int> rowIdx(descs.size(), 0);
+
+	for (const Chunk& c : chunks) {
+
+		cv::Mat& desc = descs[c.collectionIdx];
+		int& ri = rowIdx[c.collectionIdx];
+		qint64 nBytes = (qint64)c.rows * desc.cols * desc.elemSize();
+
+		if (nBytes > 0 && (!file.seek(c.offset) || file.read((char*)desc.ptr(ri), nBytes) != nBytes)) {
+			qCritical() << "could not read descriptors from" << cachePath;
+			return FeatureCollectionManager();
+		}
+
+		ri += c.rows;
+	}
+
+	for (int idx = 0; idx < descs.size(); idx++)
+		manager.mCollection[idx].setDescriptors(descs[idx]);
+
+	qInfo() << manager.numFeatures() << "features read from cache in" << dt;
+
+	return manager;
+}
+
+/// <summary>
+/// Returns true if filePath is a binary feature cache.
+/// </summary>
+/// <param name="filePath">The file path.</param>
+/// <returns>true if the file starts with a feature cache chunk.</returns>
+bool FeatureCollectionManager::isCache(const QString & filePath) {
+
+	QFile file(filePath);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	char magic[4];
+	return file.read(magic, 4) == 4 && std::equal(magic, magic + 4, featureCacheMagic);
+}
+
 void FeatureCollectionManager::add(const FeatureCollection & collection) {
 	mCollection << collection;
 }
@@ -786,12 +1479,36 @@ int SuperPixelTrainerConfig::numTrees() const {
 	return mNumTrees;
 }
 
+/// <summary>
+/// If true, the forest is trained by the RandomTreesTrainer
+/// which grows trees concurrently on binned features.
+/// Otherwise cv::ml::RTrees::train is used.
+/// </summary>
+/// <param name="native">if set to <c>true</c> the native trainer is used.</param>
+void SuperPixelTrainerConfig::setNativeTrainer(bool native) {
+	mNativeTrainer = native;
+}
+
+bool SuperPixelTrainerConfig::nativeTrainer() const {
+	return mNativeTrainer;
+}
+
+void SuperPixelTrainerConfig::setMaxThreads(int maxThreads) {
+	mMaxThreads = maxThreads;
+}
+
+int SuperPixelTrainerConfig::maxThreads() const {
+	return ModuleConfig::checkParam(mMaxThreads, 0, INT_MAX, "maxThreads");
+}
+
 void SuperPixelTrainerConfig::load(const QSettings & settings) {
 
 	QString paths = settings.value("featureCachePaths", mFeatureCachePaths.join(",")).toString();
 	mFeatureCachePaths = paths.split(",");
 	mModelPath = settings.value("modelPath", mModelPath).toString();
 	mNumTrees = settings.value("numTrees", mNumTrees).toInt();
+	mNativeTrainer = settings.value("nativeTrainer", mNativeTrainer).toBool();
+	mMaxThreads = settings.value("maxThreads", maxThreads()).toInt();
 }
 
 void SuperPixelTrainerConfig::save(QSettings & settings) const {
@@ -799,6 +1516,8 @@ void SuperPixelTrainerConfig::save(QSettings & settings) const {
 	settings.setValue("featureCachePaths", mFeatureCachePaths.join(","));
 	settings.setValue("modelPath", mModelPath);
 	settings.setValue("numTrees", mNumTrees);
+	settings.setValue("nativeTrainer", mNativeTrainer);
+	settings.setValue("maxThreads", maxThreads());
 }
 
 // SuperPixelTrainer --------------------------------------------------------------------
@@ -819,11 +1538,6 @@ bool SuperPixelTrainer::compute() {
 
 	Timer dt;
 	
-	mModel = cv::ml::RTrees::create();
-	
-	// TODO: validate!
-	cv::TermCriteria tc(cv::TermCriteria::COUNT, config()->numTrees(), 1e-6);
-	mModel->setTermCriteria(tc);
 	qInfo() << "training RF with" << config()->numTrees() << "trees";
 
 	if (mFeatureManager.numFeatures() == 0) {
@@ -833,7 +1547,30 @@ bool SuperPixelTrainer::compute() {
 
 	mInfo << "training model with" << mFeatureManager.numFeatures() << "features, this might take a while...";
 
-	mModel->train(mFeatureManager.toCvTrainData());
+	if (config()->nativeTrainer()) {
+
+		RandomTreesTrainer rtt(config()->numTrees());
+		rtt.setMaxThreads(config()->maxThreads());
+
+		if (!rtt.train(mFeatureManager.allFeatures(), mFeatureManager.allLabels()))
+			return false;
+
+		mModel = rtt.toRTrees();
+
+		if (!mModel) {
+			qCritical() << "could not convert the native random trees";
+			return false;
+		}
+	}
+	else {
+		mModel = cv::ml::RTrees::create();
+
+		// TODO: validate!
+		cv::TermCriteria tc(cv::TermCriteria::COUNT, config()->numTrees(), 1e-6);
+		mModel->setTermCriteria(tc);
+
+		mModel->train(mFeatureManager.toCvTrainData());
+	}
 
 	// Print variable importance
 	cv::Mat vi = mModel->getVarImportance();
@@ -854,7 +1591,7 @@ bool SuperPixelTrainer::compute() {
 }
 
 QSharedPointer<SuperPixelTrainerConfig> SuperPixelTrainer::config() const {
-	return qSharedPointerDynamicCast<SuperPixelTrainerConfig>(Module::config());
+	return castConfig<SuperPixelTrainerConfig>();
 }
 
 cv::Mat SuperPixelTrainer::draw(const cv::Mat & img) const {
@@ -36,7 +36,9 @@
 #include "PixelSet.h"
 
 #pragma warning(push, 0)	// no warnings from includes
+#include <opencv2/core.hpp>
 
+#include <vector>
 #pragma warning(pop)
 
 #ifndef DllCoreExport
@@ -105,6 +107,10 @@ public:
 
 	void write(const QString& filePath) const;
 	static FeatureCollectionManager read(const QString& filePath);
+
+	bool appendToCache(const QString& cachePath) const;
+	static FeatureCollectionManager readCache(const QString& cachePath);
+	static bool isCache(const QString& filePath);
 	
 	void add(const FeatureCollection& collection);
 	void merge(const FeatureCollectionManager& other);
@@ -118,11 +124,11 @@ public:
 	cv::Ptr<cv::ml::TrainData> toCvTrainData(int maxSamples = -1) const;
 	LabelManager toLabelManager() const;
 
-protected:
-	QVector<FeatureCollection> mCollection;
-
 	cv::Mat allFeatures() const;
 	cv::Mat allLabels() const;
+
+protected:
+	QVector<FeatureCollection> mCollection;
 };
 
 /// <summary>
@@ -184,6 +190,7 @@ public:
 	void setLabelManager(const LabelManager& manager);
 	void setPage(const QSharedPointer<PageElement>& page);
 	QImage createLabelImage(const Rect& imgRect, bool visualize = false) const;
+	cv::Mat createLabelMat(const Rect& imgRect) const;
 
 	PixelSet set() const;
 
@@ -203,10 +210,107 @@ private:
 	PixelSet labelBlobs(const cv::Mat& labelImg, const QVector<QSharedPointer<MserBlob> >& blobs) const;
 	PixelSet labelPixels(const cv::Mat& labelImg, const PixelSet& set) const;
 	QString parseLabel(const QString& filePath) const;
+	LabelInfo backgroundLabel() const;
+	QVector<QSharedPointer<Region> > labelRegions() const;
 
 	void setBackgroundLabelName(const QString& name);
 };
 
+/// <summary>
+/// Keeps a uniform random sample of at most capacity
+/// features per label (reservoir sampling). It is used
+/// by the FeatureCollector so that the number of features
+/// is bounded while pages are still being collected.
+/// </summary>
+class DllCoreExport FeatureReservoir {
+
+public:
+	FeatureReservoir(int capacity = 0, uint64 seed = 0xffffffff);
+
+	void add(const FeatureCollection& fc);
+	void merge(const FeatureReservoir& other);
+
+	FeatureCollectionManager toManager() const;
+
+private:
+	int mCapacity = 0;		// max number of features per label (0 = unbounded)
+	cv::RNG mRng;
+
+	QVector<FeatureCollection> mSamples;
+	QVector<double> mNumSeen;
+
+	int labelIndex(const LabelInfo& label);
+	std::vector<int> shuffledIndices(int size);
+};
+
+/// <summary>
+/// This class configures the FeatureCollector.
+/// </summary>
+/// <seealso cref="ModuleConfig" />
+class DllCoreExport FeatureCollectorConfig : public ModuleConfig {
+
+public:
+	FeatureCollectorConfig();
+
+	void setMaxThreads(int maxThreads);
+	int maxThreads() const;
+
+	void setMinNumFeaturesPerClass(int numFeatures);
+	int minNumFeaturesPerClass() const;
+
+	void setMaxNumFeaturesPerClass(int numFeatures);
+	int maxNumFeaturesPerClass() const;
+
+	virtual QString toString() const override;
+
+protected:
+
+	void load(const QSettings& settings) override;
+	void save(QSettings& settings) const override;
+
+	int mMaxThreads = 0;					// maximum number of pages processed concurrently (0 = all cores)
+	int mMinNumFeaturesPerClass = 10000;	// 1e4
+	int mMaxNumFeaturesPerClass = 10000;	// 1e4
+};
+
+/// <summary>
+/// Collects training features from many GT pages concurrently.
+/// Each worker runs the SuperPixel -> SuperPixelLabeler -> SuperPixelFeature
+/// chain on its share of the pages and keeps at most maxNumFeaturesPerClass
+/// features per class (reservoir sampling). The per-worker samples
+/// are merged once all pages are processed.
+/// </summary>
+/// <seealso cref="Module" />
+class DllCoreExport FeatureCollector : public Module {
+
+public:
+	FeatureCollector(const QStringList& imagePaths = QStringList(), const LabelManager& manager = LabelManager());
+
+	bool isEmpty() const override;
+	bool compute() override;
+	QSharedPointer<FeatureCollectorConfig> config() const;
+
+	QString toString() const override;
+
+	void setCachePath(const QString& cachePath);
+	QString cachePath() const;
+
+	FeatureCollectionManager featureManager() const;
+	int numPagesProcessed() const;
+
+private:
+	QStringList mImagePaths;
+	LabelManager mManager;
+	QString mCachePath;		// if not empty, all page features are appended to this cache
+
+	// results
+	FeatureCollectionManager mFeatureManager;
+	int mNumPagesProcessed = 0;
+
+	bool checkInput() const override;
+	FeatureCollectionManager collectPage(const QString& imagePath) const;
+};
+
 class DllCoreExport SuperPixelTrainerConfig : public ModuleConfig {
 
 public:
@@ -220,11 +324,19 @@ public:
 	void setNumTrees(int numTrees);
 	int numTrees() const;
 
+	void setNativeTrainer(bool native);
+	bool nativeTrainer() const;
+
+	void setMaxThreads(int maxThreads);
+	int maxThreads() const;
+
 protected:
 
 	QStringList mFeatureCachePaths;
 	QString mModelPath;
 	int mNumTrees = 150;
+	bool mNativeTrainer = false;	// if true, the RandomTreesTrainer is used instead of cv::ml::RTrees::train
+	int mMaxThreads = 0;			// maximum number of trees grown concurrently by the native trainer (0 = all cores)
 
 	void load(const QSettings& settings) override;
 	void save(QSettings& settings) const override;
@@ -84,7 +84,7 @@ bool TabStopAnalysis::compute() {
 }
 
 QSharedPointer<TabStopConfig> TabStopAnalysis::config() const {
-	return qSharedPointerDynamicCast<TabStopConfig>(mConfig);
+	return castConfig<TabStopConfig>();
 }
 
 cv::Mat TabStopAnalysis::draw(const cv::Mat& img) const {
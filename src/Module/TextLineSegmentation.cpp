@@ -165,13 +165,16 @@ bool TextLineSegmentation::compute(const cv::Mat& img) {
 }
 
 QSharedPointer<TextLineConfig> TextLineSegmentation::config() const {
-	return qSharedPointerDynamicCast<TextLineConfig>(mConfig);
+	return castConfig<TextLineConfig>();
 }
 
 QVector<QSharedPointer<TextLineSet> > TextLineSegmentation::clusterTextLines(const PixelGraph & graph, QVector<QSharedPointer<PixelEdge> >* removedEdges) const {
 	
 	QVector<QSharedPointer<TextLineSet> > textLines;
 	
+	// resolve the config once - it is needed for every edge
+	QSharedPointer<const TextLineConfig> cfg = configSnapshot<TextLineConfig>();
+
 	int idx = 0;
 
 	for (auto e : graph.edges()) {
@@ -199,7 +202,7 @@ QVector<QSharedPointer<TextLineSet> > TextLineSegmentation::clusterTextLines(con
 		// merge one pixel
 		else if (psIdx2 == -1) {
 
-			if (addPixel(textLines[psIdx1], e->second(), heat)) {
+			if (addPixel(textLines[psIdx1], e->second(), heat, *cfg)) {
 				textLines[psIdx1]->add(e->second());
 			}
 			// else drop
@@ -208,7 +211,7 @@ QVector<QSharedPointer<TextLineSet> > TextLineSegmentation::clusterTextLines(con
 		}
 		// merge one pixel
 		else if (psIdx1 == -1) {
-			if (addPixel(textLines[psIdx2], e->first(), heat)) {
+			if (addPixel(textLines[psIdx2], e->first(), heat, *cfg)) {
 				textLines[psIdx2]->add(e->first());
 			}
 			// else drop
@@ -216,7 +219,7 @@ QVector<QSharedPointer<TextLineSet> > TextLineSegmentation::clusterTextLines(con
 				drop = true;
 		}
 		// merge to same text line
-		else if (mergeTextLines(textLines[psIdx1], textLines[psIdx2], heat)) {
+		else if (mergeTextLines(textLines[psIdx1], textLines[psIdx2], heat, *cfg)) {
 
 			textLines[psIdx2]->append(textLines[psIdx1]->pixels());
 			textLines.remove(psIdx1);
@@ -249,6 +252,8 @@ QVector<QSharedPointer<TextLineSet> > TextLineSegmentation::clusterTextLinesDebu
 	p.setPen(pen);
 	// debug ------------------------------------
 
+	QSharedPointer<const TextLineConfig> cfg = configSnapshot<TextLineConfig>();
+
 	int idx = 0;
 
 	for (auto e : graph.edges()) {
@@ -282,7 +287,7 @@ QVector<QSharedPointer<TextLineSet> > TextLineSegmentation::clusterTextLinesDebu
 		// merge one pixel
 		else if (psIdx2 == -1) {
 
-			if (addPixel(textLines[psIdx1], e->second(), heat)) {
+			if (addPixel(textLines[psIdx1], e->second(), heat, *cfg)) {
 				textLines[psIdx1]->add(e->second());
 				p.setPen(ColorManager::blue(1.0));
 			}
@@ -291,7 +296,7 @@ QVector<QSharedPointer<TextLineSet> > TextLineSegmentation::clusterTextLinesDebu
 		}
 		// merge one pixel
 		else if (psIdx1 == -1) {
-			if (addPixel(textLines[psIdx2], e->first(), heat)) {
+			if (addPixel(textLines[psIdx2], e->first(), heat, *cfg)) {
 				textLines[psIdx2]->add(e->first());
 				p.setPen(ColorManager::blue(1.0));
 			}
@@ -299,7 +304,7 @@ QVector<QSharedPointer<TextLineSet> > TextLineSegmentation::clusterTextLinesDebu
 				p.setPen(ColorManager::red(0.4));
 		}
 		// merge same text line
-		else if (mergeTextLines(textLines[psIdx1], textLines[psIdx2], heat)) {
+		else if (mergeTextLines(textLines[psIdx1], textLines[psIdx2], heat, *cfg)) {
 
 			textLines[psIdx2]->append(textLines[psIdx1]->pixels());
 			textLines.remove(psIdx1);
@@ -316,7 +321,7 @@ QVector<QSharedPointer<TextLineSet> > TextLineSegmentation::clusterTextLinesDebu
 		if (idx % 200 == 0) {
 			cv::Mat imgCv = Image::qImage2Mat(imgR);
 			QString fName("img" + QString::number(idx) + ".tif");
-			QString iPath = QFileInfo(QDir(config()->debugPath()), fName).absoluteFilePath();
+			QString iPath = QFileInfo(QDir(cfg->debugPath()), fName).absoluteFilePath();
 			Image::save(imgCv, iPath);
 			qDebug() << iPath << "written...";
 		}
@@ -353,31 +358,31 @@ int TextLineSegmentation::locate(const QSharedPointer<Pixel>& pixel, const QVect
 	return -1;
 }
 
-bool TextLineSegmentation::addPixel(QSharedPointer<TextLineSet>& set, const QSharedPointer<Pixel>& pixel, double heat) const {
+bool TextLineSegmentation::addPixel(QSharedPointer<TextLineSet>& set, const QSharedPointer<Pixel>& pixel, double heat, const TextLineConfig& cfg) const {
 
 	// do not create vertical lines
 	if (set->line().length() < 10)
 		return true;
 
-	double mErr = qMax(set->error() * config()->errorMultiplier(), config()->minPointDistance() * heat);
+	double mErr = qMax(set->error() * cfg.errorMultiplier(), cfg.minPointDistance() * heat);
 	double newErr = set->line().distance(pixel->center());
 
 	return newErr < mErr;
 }
 
-bool TextLineSegmentation::mergeTextLines(const QSharedPointer<TextLineSet>& tln1, const QSharedPointer<TextLineSet>& tln2, double heat) const {
+bool TextLineSegmentation::mergeTextLines(const QSharedPointer<TextLineSet>& tln1, const QSharedPointer<TextLineSet>& tln2, double heat, const TextLineConfig& cfg) const {
 
 	// do not merge one and the same textline
 	if (tln1 == tln2)
 		return false;
 
 	// do not create vertical lines
-	if (tln1->line().length() < config()->minLineLength() || 
-		tln2->line().length() < config()->minLineLength())
+	if (tln1->line().length() < cfg.minLineLength() || 
+		tln2->line().length() < cfg.minLineLength())
 		return true;
 
-	double maxErr1 = qMax(tln1->error() * config()->errorMultiplier(), config()->minPointDistance() * heat);
-	double maxErr2 = qMax(tln2->error() * config()->errorMultiplier(), config()->minPointDistance() * heat);
+	double maxErr1 = qMax(tln1->error() * cfg.errorMultiplier(), cfg.minPointDistance() * heat);
+	double maxErr2 = qMax(tln2->error() * cfg.errorMultiplier(), cfg.minPointDistance() * heat);
 
 	double nErr1 = tln1->computeError(tln2->centers());
 	double nErr2 = tln2->computeError(tln1->centers());
@@ -418,7 +423,7 @@ void TextLineSegmentation::filterDuplicates(PixelSet & set) const {
 			if (remPixels.contains(pxi))
 				continue;
 
-			if (PixelDistance::euclidean(px.data(), pxi.data()) < config()->minLineLength()) {
+			if (PixelDistance::euclidean(px.data(), pxi.data()) < md) {
 
 				// remove the smaller one
 				remPixels << (px->ellipse().radius() < pxi->ellipse().radius() ? px : pxi);
@@ -626,11 +631,12 @@ bool SimpleTextLineSegmentation::compute() {
 
 	QVector<QSharedPointer<PixelEdge> > edges = pg.edges();
 	QVector<QSharedPointer<PixelEdge> > ef;
+	const double maxEdgeThresh = config()->maxEdgeTrhesh();
 
 	for (auto e : edges) {
 		
 		double d = PixelDistance::angleWeighted(e->first().data(), e->second().data());
-		if (d > config()->maxEdgeTrhesh())
+		if (d > maxEdgeThresh)
 			break;
 		
 		ef << e;
@@ -688,7 +694,7 @@ QVector<PixelSet> SimpleTextLineSegmentation::sets() const {
 }
 
 QSharedPointer<SimpleTextLineConfig> SimpleTextLineSegmentation::config() const {
-	return qSharedPointerDynamicCast<SimpleTextLineConfig>(mConfig);
+	return castConfig<SimpleTextLineConfig>();
 }
 
 QVector<QSharedPointer<TextLineSet>> SimpleTextLineSegmentation::textLineSets() const {
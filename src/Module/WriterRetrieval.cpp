@@ -321,7 +321,7 @@ namespace rdf {
 	/// </summary>
 	/// <returns></returns>
 	QSharedPointer<WriterRetrievalConfig> WriterRetrieval::config() const {
-		return qSharedPointerDynamicCast<WriterRetrievalConfig>(mConfig);
+		return castConfig<WriterRetrievalConfig>();
 	}
 	/// <summary>
 	/// Returns the feature (does not calculate the feature!)
@@ -0,0 +1,771 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#include "CoreTest.h"
+
+#include "PageParser.h"		// tested
+#include "RunLengthImage.h"		// tested
+#include "ImageProcessor.h"		// tested
+#include "Image.h"				// tested
+#include "Blobs.h"
+#include "Elements.h"
+#include "Shapes.h"
+#include "PixelSet.h"			// tested
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QColor>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QImage>
+#include <QJsonObject>
+#include <QPainter>
+#include <QPair>
+
+#include <algorithm>
+#include <opencv2/imgproc.hpp>
+#pragma warning(pop)
+
+namespace rdf {
+
+CoreTest::CoreTest(const TestConfig & config) : mConfig(config) {
+}
+
+/// <summary>
+/// Tests the PAGE parser's type filter and lazy polygons.
+/// A synthetic page is written and read back with different settings.
+/// </summary>
+/// <returns>true if all checks pass.</returns>
+bool CoreTest::pageParser() const {
+
+	QSharedPointer<PageElement> page = createPage();
+	QString xmlPath = tempPath("rdf-core-test-page.xml");
+
+	PageXmlParser writer;
+	if (!writer.write(xmlPath, page)) {
+		qWarning() << "could not write" << xmlPath;
+		return false;
+	}
+
+	// -------------------------------------------------------------------- full read
+	PageXmlParser parser;
+	if (!parser.read(xmlPath)) {
+		qWarning() << "could not read" << xmlPath;
+		return false;
+	}
+
+	auto allFull = Region::allRegions(parser.page()->rootRegion().data());
+	auto allSrc = Region::allRegions(page->rootRegion().data());
+
+	if (allFull.size() != allSrc.size()) {
+		qWarning() << "parser: expected" << allSrc.size() << "regions but got" << allFull.size();
+		return false;
+	}
+
+	// -------------------------------------------------------------------- type filter (FormAnalysis)
+	PageXmlParser tableParser;
+	tableParser.setTypeFilter({ Region::type_table_region, Region::type_table_cell, Region::type_text_region, Region::type_text_line });
+	if (!tableParser.read(xmlPath))
+		return false;
+
+	auto cells = Region::filter(tableParser.page()->rootRegion().data(), Region::type_table_cell);
+
+	if (cells.size() != 1 || cells[0]->children().size() != 1 || cells[0]->children()[0]->type() != Region::type_text_region) {
+		qWarning() << "type filter: text regions of table cells are not kept";
+		return false;
+	}
+
+	// -------------------------------------------------------------------- type filter (skipped parents)
+	PageXmlParser lineParser;
+	lineParser.setTypeFilter({ Region::type_text_line });
+	if (!lineParser.read(xmlPath))
+		return false;
+
+	auto lineRoot = lineParser.page()->rootRegion();
+	auto lines = Region::allRegions(lineRoot.data());
+	auto srcLines = Region::filter(page->rootRegion().data(), Region::type_text_line);
+
+	if (lines.size() != srcLines.size() || lineRoot->children().size() != srcLines.size()) {
+		qWarning() << "type filter: text lines should be direct children of the root but I found" 
+			<< lineRoot->children().size() << "/" << srcLines.size();
+		return false;
+	}
+
+	for (auto l : lines) {
+		if (l->type() != Region::type_text_line) {
+			qWarning() << "type filter: unexpected region" << l->toString();
+			return false;
+		}
+	}
+
+	// -------------------------------------------------------------------- lazy polygons
+	PageXmlParser lazyParser;
+	lazyParser.setLazyPolygons(true);
+	if (!lazyParser.read(xmlPath))
+		return false;
+
+	auto allLazy = Region::allRegions(lazyParser.page()->rootRegion().data());
+
+	if (allLazy.size() != allFull.size()) {
+		qWarning() << "lazy polygons: expected" << allFull.size() << "regions but got" << allLazy.size();
+		return false;
+	}
+
+	for (int idx = 0; idx < allLazy.size(); idx++) {
+
+		// access twice - the second call returns the region's materialized polygon
+		QPolygonF p = allLazy[idx]->polygon().polygon();
+
+		if (p != allFull[idx]->polygon().polygon() || p != allLazy[idx]->polygon().polygon()) {
+			qWarning() << "lazy polygons: polygon of" << allLazy[idx]->id() << "differs";
+			return false;
+		}
+	}
+
+	// writing lazy regions must not change the coordinates
+	QString lazyXmlPath = tempPath("rdf-core-test-page-lazy.xml");
+	if (!lazyParser.write(lazyXmlPath, lazyParser.page()))
+		return false;
+
+	PageXmlParser reParser;
+	if (!reParser.read(lazyXmlPath))
+		return false;
+
+	auto allRe = Region::allRegions(reParser.page()->rootRegion().data());
+	for (int idx = 0; idx < allRe.size() && idx < allFull.size(); idx++) {
+		if (allRe[idx]->polygon().polygon() != allFull[idx]->polygon().polygon()) {
+			qWarning() << "lazy polygons: re-written polygon of" << allRe[idx]->id() << "differs";
+			return false;
+		}
+	}
+
+	QFile::remove(xmlPath);
+	QFile::remove(lazyXmlPath);
+
+	qInfo() << "page parser test passed";
+
+	return true;
+}
+
+/// <summary>
+/// Tests the RunLengthImage against OpenCV on random binary images.
+/// </summary>
+/// <returns>true if all checks pass.</returns>
+bool CoreTest::runLengthImage() const {
+
+	cv::RNG rng(42);
+
+	auto randomImage = [&rng](double density) {
+		cv::Mat noise(97, 131, CV_32FC1);
+		rng.fill(noise, cv::RNG::UNIFORM, 0.0f, 1.0f);
+		return cv::Mat(noise < density);	// 0 or 255
+	};
+
+	auto isEqual = [](const cv::Mat& img1, const cv::Mat& img2) {
+		return img1.size() == img2.size() && cv::countNonZero(img1 != img2) == 0;
+	};
+
+	cv::Mat img = randomImage(0.4);
+	cv::Mat img2 = randomImage(0.4);
+
+	// -------------------------------------------------------------------- I/O
+	RunLengthImage rle = RunLengthImage::fromMat(img);
+	RunLengthImage rle2 = RunLengthImage::fromMat(img2);
+
+	if (!isEqual(rle.toMat(), img) || rle.area() != cv::countNonZero(img)) {
+		qWarning() << "RunLengthImage: fromMat/toMat is not lossless";
+		return false;
+	}
+
+	// -------------------------------------------------------------------- logical operations
+	if (!isEqual((rle & rle2).toMat(), img & img2) || !isEqual((rle | rle2).toMat(), img | img2)) {
+		qWarning() << "RunLengthImage: wrong result of & or |";
+		return false;
+	}
+
+	// -------------------------------------------------------------------- labels
+	cv::Mat ccLabels, stats, centroids;
+	int numCc = cv::connectedComponentsWithStats(img, ccLabels, stats, centroids, 8, CV_32S) - 1;	// w/o background
+
+	int numComponents = 0;
+	QVector<int> labels = rle.labels(&numComponents);
+	QVector<RunLengthImage::Run> runs = rle.runs();
+
+	if (numComponents != numCc || labels.size() != runs.size()) {
+		qWarning() << "RunLengthImage:" << numComponents << "components found but OpenCV finds" << numCc;
+		return false;
+	}
+
+	// the labels must map 1:1 to OpenCV's labels
+	QHash<int, int> rleToCc;
+	QHash<int, int> ccToRle;
+
+	for (int idx = 0; idx < runs.size(); idx++) {
+
+		const RunLengthImage::Run& r = runs[idx];
+		const int* lPtr = ccLabels.ptr<int>(r.row);
+
+		for (int cIdx = r.start; cIdx < r.end; cIdx++) {
+
+			int ccl = lPtr[cIdx];
+			if (rleToCc.value(labels[idx], ccl) != ccl || ccToRle.value(ccl, labels[idx]) != labels[idx]) {
+				qWarning() << "RunLengthImage: components differ from OpenCV's in row" << r.row;
+				return false;
+			}
+
+			rleToCc.insert(labels[idx], ccl);
+			ccToRle.insert(ccl, labels[idx]);
+		}
+	}
+
+	// -------------------------------------------------------------------- area filter
+	int minArea = 3;
+	int maxArea = 40;
+
+	cv::Mat expected(img.size(), CV_8UC1, cv::Scalar(0));
+	for (int rIdx = 0; rIdx < img.rows; rIdx++) {
+
+		const int* lPtr = ccLabels.ptr<int>(rIdx);
+		unsigned char* ePtr = expected.ptr<unsigned char>(rIdx);
+
+		for (int cIdx = 0; cIdx < img.cols; cIdx++) {
+
+			if (lPtr[cIdx] == 0)
+				continue;
+
+			int a = stats.at<int>(lPtr[cIdx], cv::CC_STAT_AREA);
+			if (a > minArea && a < maxArea)
+				ePtr[cIdx] = 255;
+		}
+	}
+
+	RunLengthImage removed;
+	RunLengthImage filtered = rle.filterArea(minArea, maxArea, &removed);
+
+	if (!isEqual(filtered.toMat(), expected) || !isEqual(removed.toMat(), img & ~expected)) {
+		qWarning() << "RunLengthImage: filterArea differs from OpenCV's component areas";
+		return false;
+	}
+
+	// -------------------------------------------------------------------- patches & component filter
+	cv::Mat patch = randomImage(0.4)(cv::Rect(0, 0, 30, 20));
+	cv::Point offset(-5, 85);	// partly outside the image
+	cv::Rect patchRect = cv::Rect(offset, patch.size()) & cv::Rect(cv::Point(), img.size());
+
+	cv::Mat patchImg(img.size(), CV_8UC1, cv::Scalar(0));
+	patch(cv::Rect(patchRect.tl() - offset, patchRect.size())).copyTo(patchImg(patchRect));
+
+	if (!isEqual(RunLengthImage::fromMat(patch, img.size(), offset).toMat(), patchImg)) {
+		qWarning() << "RunLengthImage: patch is not placed correctly";
+		return false;
+	}
+
+	QVector<bool> keep(numComponents);
+	for (int idx = 0; idx < numComponents; idx++)
+		keep[idx] = rng.uniform(0, 2) == 1;
+
+	cv::Mat keepImg(img.size(), CV_8UC1, cv::Scalar(0));
+	for (int rIdx = 0; rIdx < img.rows; rIdx++) {
+
+		const int* lPtr = ccLabels.ptr<int>(rIdx);
+		unsigned char* kPtr = keepImg.ptr<unsigned char>(rIdx);
+
+		for (int cIdx = 0; cIdx < img.cols; cIdx++) {
+			if (lPtr[cIdx] != 0 && keep[ccToRle[lPtr[cIdx]]])
+				kPtr[cIdx] = 255;
+		}
+	}
+
+	if (!isEqual(rle.filterComponents(labels, keep).toMat(), keepImg)) {
+		qWarning() << "RunLengthImage: filterComponents keeps the wrong components";
+		return false;
+	}
+
+	// -------------------------------------------------------------------- MAR filter (as in LineTrace)
+	// line segments (some touching) - the run end points must give the same result as the blob contours
+	cv::Mat lineImg(img.size(), CV_8UC1, cv::Scalar(0));
+	for (int idx = 0; idx < 30; idx++) {
+
+		cv::Point p(rng.uniform(2, img.cols - 2), rng.uniform(2, img.rows - 2));
+		int len = rng.uniform(1, 40);
+		cv::Point q = rng.uniform(0, 2) ? cv::Point(qMin(p.x + len, img.cols - 3), p.y) : cv::Point(p.x, qMin(p.y + len, img.rows - 3));
+		cv::line(lineImg, p, q, cv::Scalar(255), rng.uniform(1, 3));
+	}
+
+	int minWidth = 15;
+	Blobs blobs;
+	blobs.setImage(lineImg.clone());
+	blobs.compute();
+	blobs.setBlobs(BlobManager::instance().filterMar(1.0f, minWidth, blobs));
+	cv::Mat marExpected = BlobManager::instance().drawBlobs(blobs, cv::Scalar(255));
+
+	RunLengthImage lineRle = RunLengthImage::fromMat(lineImg);
+	int numLineComponents = 0;
+	QVector<int> lineLabels = lineRle.labels(&numLineComponents);
+	QVector<RunLengthImage::Run> lineRuns = lineRle.runs();
+
+	QVector<std::vector<cv::Point> > pts(numLineComponents);
+	for (int idx = 0; idx < lineRuns.size(); idx++) {
+		pts[lineLabels[idx]].push_back(cv::Point(lineRuns[idx].start, lineRuns[idx].row));
+		pts[lineLabels[idx]].push_back(cv::Point(lineRuns[idx].end - 1, lineRuns[idx].row));
+	}
+
+	QVector<bool> keepMar(numLineComponents);
+	for (int idx = 0; idx < numLineComponents; idx++)
+		keepMar[idx] = BlobManager::instance().checkMar(pts[idx], 1.0f, minWidth);
+
+	if (!isEqual(lineRle.filterComponents(lineLabels, keepMar).toMat(), marExpected)) {
+		qWarning() << "RunLengthImage: the MAR filter on runs differs from BlobManager::filterMar";
+		return false;
+	}
+
+	qInfo() << "run-length image test passed";
+
+	return true;
+}
+
+/// <summary>
+/// Compares IP::statMomentMat and IP::statMomentColor
+/// with the quantiles of sorted pixels.
+/// </summary>
+/// <returns>true if all checks pass.</returns>
+bool CoreTest::statMoment() const {
+
+	cv::RNG rng(42);
+
+	// negative values and many ties (rounded values in the upper rows)
+	cv::Mat img(120, 150, CV_32FC1);
+	rng.fill(img, cv::RNG::UNIFORM, -1.0f, 1.0f);
+
+	for (int rIdx = 0; rIdx < 40; rIdx++) {
+		float* iPtr = img.ptr<float>(rIdx);
+		for (int cIdx = 0; cIdx < img.cols; cIdx++)
+			iPtr[cIdx] = (float)cvRound(iPtr[cIdx] * 10.0f);
+	}
+
+	cv::Mat mask(img.size(), CV_8UC1);
+	rng.fill(mask, cv::RNG::UNIFORM, 0, 2);
+
+	cv::Mat imgColor(img.size(), CV_8UC3);
+	rng.fill(imgColor, cv::RNG::UNIFORM, 0, 256);
+
+	std::vector<float> values;
+	std::vector<float> channels[3];
+	for (int rIdx = 0; rIdx < img.rows; rIdx++) {
+		for (int cIdx = 0; cIdx < img.cols; cIdx++) {
+			if (mask.at<unsigned char>(rIdx, cIdx)) {
+				values.push_back(img.at<float>(rIdx, cIdx));
+
+				for (int c = 0; c < 3; c++)
+					channels[c].push_back(imgColor.at<cv::Vec3b>(rIdx, cIdx)[c]);
+			}
+		}
+	}
+
+	// rank = ceil(n*moment) - the mean with the next value is used if n is even
+	auto quantile = [](std::vector<float> vals, double mv) {
+		std::sort(vals.begin(), vals.end());
+		int n = (int)vals.size();
+		int rank = qBound(1, cvCeil(n * mv), n);
+		double v = vals[rank - 1];
+		return (n % 2 == 0 && rank < n) ? (v + vals[rank]) * 0.5 : v;
+	};
+
+	// a single pixel is its own quantile
+	double single = IP::statMomentMat(img(cv::Rect(0, 0, 1, 1)));
+	if (single != img.at<float>(0, 0)) {
+		qWarning() << "statMomentMat:" << single << "!=" << img.at<float>(0, 0) << "for a single pixel";
+		return false;
+	}
+
+	for (double mv : { 0.1, 0.25, 0.5, 0.75, 1.0 }) {
+
+		double expected = quantile(values, mv);
+		double moment = IP::statMomentMat(img, mask, mv);
+
+		if (moment != expected) {
+			qWarning() << "statMomentMat:" << moment << "!=" << expected << "for moment" << mv;
+			return false;
+		}
+
+		QColor col = IP::statMomentColor(imgColor, mask, mv);
+		int cols[3] = { col.red(), col.green(), col.blue() };
+
+		for (int c = 0; c < 3; c++) {
+
+			int cExpected = qRound(quantile(channels[c], mv));
+			if (cols[c] != cExpected) {
+				qWarning() << "statMomentColor: channel" << c << cols[c] << "!=" << cExpected << "for moment" << mv;
+				return false;
+			}
+		}
+	}
+
+	qInfo() << "stat moment test passed";
+
+	return true;
+}
+
+/// <summary>
+/// Creates a page with a table (region > cell > text region > text line)
+/// and a text region with a text line.
+/// </summary>
+/// <returns>The synthetic page.</returns>
+/// <summary>
+/// Tests the binary cv::Mat I/O.
+/// Corrupt or truncated files must be rejected without allocating their (illegal) size.
+/// </summary>
+/// <returns>true if all checks pass.</returns>
+bool CoreTest::matBinary() const {
+
+	// a non-continuous float matrix
+	cv::Mat big(64, 80, CV_32FC3);
+	cv::RNG rng(42);
+	rng.fill(big, cv::RNG::UNIFORM, -100.0, 100.0);
+	cv::Mat img = big(cv::Rect(5, 7, 53, 37));
+
+	auto isEqual = [](const cv::Mat& a, const cv::Mat& b) {
+		return a.size() == b.size() && a.type() == b.type() && cv::norm(a, b, cv::NORM_INF) == 0;
+	};
+
+	QString fileName = "rdf-core-test-mat.bin";
+	QString binPath = tempPath(fileName);
+
+	if (!Image::writeMatBinary(img, binPath)) {
+		qWarning() << "could not write" << binPath;
+		return false;
+	}
+
+	if (!isEqual(img, Image::readMatBinary(binPath))) {
+		qWarning() << "binary mat: the matrix changes when it is written";
+		return false;
+	}
+
+	// json referencing the binary file
+	QJsonObject jo = Image::matToJsonBinary(img, fileName);
+	if (!isEqual(img, Image::jsonToMat(jo, QDir::tempPath()))) {
+		qWarning() << "binary mat: jsonToMat does not read the binary file";
+		return false;
+	}
+
+	QFile file(binPath);
+	if (!file.open(QIODevice::ReadOnly)) {
+		qWarning() << "could not read" << binPath;
+		return false;
+	}
+	QByteArray data = file.readAll();
+	file.close();
+
+	// writes a modified copy & returns true if it is rejected
+	auto isRejected = [&](const QByteArray& ba) {
+
+		QString p = tempPath("rdf-core-test-mat-corrupt.bin");
+		QFile f(p);
+		if (!f.open(QIODevice::WriteOnly))
+			return false;
+		f.write(ba);
+		f.close();
+
+		return Image::readMatBinary(p).empty();
+	};
+
+	// the header is: magic, version, rows, cols, type (32 bit each)
+	auto withHeaderValue = [&data](int offset, qint32 val) {
+		QByteArray ba = data;
+		memcpy(ba.data() + offset, &val, sizeof(val));
+		return ba;
+	};
+
+	if (!isRejected(data.left(data.size() - 10))) {
+		qWarning() << "binary mat: a truncated file is not rejected";
+		return false;
+	}
+
+	if (!isRejected(withHeaderValue(8, 0x7fffffff)) || !isRejected(withHeaderValue(12, 0x7fffffff))) {
+		qWarning() << "binary mat: an illegal size is not rejected";
+		return false;
+	}
+
+	if (!isRejected(withHeaderValue(16, 0x7fffffff)) || !isRejected(withHeaderValue(16, -1))) {
+		qWarning() << "binary mat: an illegal type is not rejected";
+		return false;
+	}
+
+	qInfo() << "binary mat test passed";
+
+	return true;
+}
+
+/// <summary>
+/// Tests IP::preFilterArea against a filter based on cv::connectedComponentsWithStats.
+/// Border pixels are neither filtered nor connect blobs (as the previous flood-fill).
+/// </summary>
+/// <returns>true if all checks pass.</returns>
+bool CoreTest::preFilterArea() const {
+
+	cv::RNG rng(7);
+
+	cv::Mat noise(113, 157, CV_32FC1);
+	rng.fill(noise, cv::RNG::UNIFORM, 0.0f, 1.0f);
+	cv::Mat img = noise < 0.45;	// 0 or 255
+
+	cv::Rect interior(1, 1, img.cols - 2, img.rows - 2);
+
+	cv::Mat ccLabels, stats, centroids;
+	cv::connectedComponentsWithStats(img(interior), ccLabels, stats, centroids, 8, CV_32S);
+
+	// (min, max) - the bounds are exclusive
+	QVector<QPair<int, int> > bounds;
+	bounds << qMakePair(10, -1) << qMakePair(3, 40) << qMakePair(0, 5) << qMakePair(1, 2);
+
+	for (const QPair<int, int>& b : bounds) {
+
+		cv::Mat expected = img.clone();
+		cv::Mat ei = expected(interior);
+
+		for (int rIdx = 0; rIdx < ccLabels.rows; rIdx++) {
+
+			const int* lPtr = ccLabels.ptr<int>(rIdx);
+			unsigned char* ePtr = ei.ptr<unsigned char>(rIdx);
+
+			for (int cIdx = 0; cIdx < ccLabels.cols; cIdx++) {
+
+				if (lPtr[cIdx] == 0)
+					continue;
+
+				int a = stats.at<int>(lPtr[cIdx], cv::CC_STAT_AREA);
+				if (a <= b.first || (b.second != -1 && a >= b.second))
+					ePtr[cIdx] = 0;
+			}
+		}
+
+		cv::Mat filtered = IP::preFilterArea(img, b.first, b.second);
+
+		if (filtered.size() != img.size() || cv::countNonZero(filtered != expected) != 0) {
+			qWarning() << "preFilterArea: result differs from the connected components filter for area bounds" << b.first << b.second;
+			return false;
+		}
+	}
+
+	qInfo() << "area filter test passed";
+
+	return true;
+}
+
+/// <summary>
+/// Compares the grid based TextBlockSet::setPixels with
+/// TextBlock::addPixels (which tests each block's polygon).
+/// The blocks overlap, one is concave, one touches the origin
+/// and one is empty.
+/// </summary>
+/// <returns>true if all blocks get the same pixels.</returns>
+bool CoreTest::textBlockPixels() const {
+
+	QVector<Polygon> regions;
+	regions << Polygon(QPolygonF(QRectF(10, 10, 80, 60)));
+	regions << Polygon(QPolygonF(QRectF(50, 40, 90, 70)));
+	regions << Polygon();
+
+	// concave (U shaped) region
+	QPolygonF u;
+	u << QPointF(100, 120) << QPointF(190, 120) << QPointF(190, 190) << QPointF(160, 190)
+		<< QPointF(160, 150) << QPointF(130, 150) << QPointF(130, 190) << QPointF(100, 190);
+	regions << Polygon(u);
+
+	// triangle with a vertex in the origin
+	QPolygonF t;
+	t << QPointF(0, 0) << QPointF(40, 5) << QPointF(5, 40);
+	regions << Polygon(t);
+
+	cv::RNG rng(42);
+	QVector<QSharedPointer<Pixel> > pixels;
+
+	for (int idx = 0; idx < 3000; idx++) {
+		Vector2D c(rng.uniform(-10.0, 210.0), rng.uniform(-10.0, 210.0));
+		pixels << QSharedPointer<Pixel>::create(Ellipse(c, Vector2D(3, 3)));
+	}
+
+	// pixels on polygon vertices and edges
+	pixels << QSharedPointer<Pixel>::create(Ellipse(Vector2D(10, 10), Vector2D(3, 3)));
+	pixels << QSharedPointer<Pixel>::create(Ellipse(Vector2D(145, 150), Vector2D(3, 3)));
+	pixels << QSharedPointer<Pixel>::create(Ellipse(Vector2D(0, 0), Vector2D(3, 3)));
+
+	PixelSet ps(pixels);
+
+	TextBlockSet tbs(regions);
+	tbs.setPixels(ps);
+
+	QVector<QSharedPointer<TextBlock> > blocks = tbs.textBlocks();
+
+	if (blocks.size() != regions.size()) {
+		qWarning() << "TextBlockSet has" << blocks.size() << "blocks instead of" << regions.size();
+		return false;
+	}
+
+	for (int idx = 0; idx < regions.size(); idx++) {
+
+		TextBlock ref(regions[idx]);
+		ref.addPixels(ps);
+
+		QVector<QSharedPointer<Pixel> > expected = ref.pixelSet().pixels();
+		QVector<QSharedPointer<Pixel> > assigned = blocks[idx]->pixelSet().pixels();
+
+		if (expected != assigned) {
+			qWarning() << "text block" << idx << "has" << assigned.size() << "pixels, expected" << expected.size();
+			return false;
+		}
+	}
+
+	if (!tbs.sharesPixels()) {
+		qWarning() << "the overlapping text blocks do not share pixels";
+		return false;
+	}
+
+	qInfo() << "text block pixels test passed";
+
+	return true;
+}
+
+/// <summary>
+/// Compares IP::fillPolygon with QPainter (Qt::WindingFill).
+/// A self-intersecting star and a polygon that winds twice
+/// around its center are filled with the nonzero winding rule.
+/// </summary>
+/// <returns>true if all checks pass.</returns>
+bool CoreTest::fillPolygon() const {
+
+	QVector<QPolygonF> polys;
+
+	// pentagram - the inner pentagon has a winding number of 2
+	QPolygonF star;
+	for (int idx = 0; idx < 5; idx++) {
+		double a = idx * 4.0 * CV_PI / 5.0 - CV_PI * 0.5;
+		star << QPointF(100.3 + 80 * std::cos(a), 100.3 + 80 * std::sin(a));
+	}
+	polys << star;
+
+	// a concave polygon that winds twice around its center
+	QPolygonF twice;
+	for (int idx = 0; idx < 14; idx++) {
+		double a = idx * 4.0 * CV_PI / 14.0;
+		double r = (idx % 2) ? 40.2 : 70.7;
+		twice << QPointF(100.1 + r * std::cos(a), 100.4 + r * std::sin(a));
+	}
+	polys << twice;
+
+	for (const QPolygonF& poly : polys) {
+
+		cv::Mat img(200, 200, CV_8UC1, cv::Scalar(0));
+		IP::fillPolygon(poly, img, 255);
+
+		QImage qImg(img.cols, img.rows, QImage::Format_RGB32);
+		qImg.fill(Qt::black);
+
+		QPainter p(&qImg);
+		p.setPen(Qt::NoPen);
+		p.setBrush(Qt::white);
+		p.drawPolygon(poly, Qt::WindingFill);
+		p.end();
+
+		int numFilled = 0;
+		int numDiff = 0;
+
+		for (int rIdx = 0; rIdx < img.rows; rIdx++) {
+			for (int cIdx = 0; cIdx < img.cols; cIdx++) {
+
+				bool filled = img.at<unsigned char>(rIdx, cIdx) != 0;
+				bool painted = qGray(qImg.pixel(cIdx, rIdx)) > 128;
+
+				if (filled)
+					numFilled++;
+				if (filled != painted)
+					numDiff++;
+			}
+		}
+
+		// the center has a winding number of 2 (it is empty with the odd-even rule)
+		if (img.at<unsigned char>(100, 100) == 0) {
+			qWarning() << "fillPolygon: the polygon's center is not filled";
+			return false;
+		}
+
+		// rounding may differ for pixel centers on the polygon's edges
+		if (numFilled == 0 || numDiff > numFilled * 0.01) {
+			qWarning() << "fillPolygon:" << numDiff << "of" << numFilled << "pixels differ from QPainter";
+			return false;
+		}
+	}
+
+	qInfo() << "fill polygon test passed";
+
+	return true;
+}
+
+QSharedPointer<PageElement> CoreTest::createPage() const {
+
+	auto rect = [](int x, int y, int w, int h) {
+		return Polygon(QPolygonF(QRectF(x, y, w, h)));
+	};
+
+	auto addRegion = [&](QSharedPointer<Region> parent, QSharedPointer<Region> r, const Region::Type& type, const QString& id, const Polygon& poly) {
+		r->setType(type);
+		r->setId(id);
+		r->setPolygon(poly);
+		parent->addChild(r);
+		return r;
+	};
+
+	QSharedPointer<RootRegion> root(new RootRegion());
+
+	auto table = addRegion(root, QSharedPointer<TableRegion>::create(), Region::type_table_region, "t1", rect(100, 100, 800, 400));
+	auto cell = addRegion(table, QSharedPointer<TableCell>::create(), Region::type_table_cell, "c1", rect(100, 100, 400, 200));
+	auto cellText = addRegion(cell, QSharedPointer<TextRegion>::create(), Region::type_text_region, "r1", rect(110, 110, 300, 50));
+	addRegion(cellText, QSharedPointer<TextLine>::create(), Region::type_text_line, "l1", rect(110, 120, 280, 30));
+
+	auto text = addRegion(root, QSharedPointer<TextRegion>::create(), Region::type_text_region, "r2", rect(100, 600, 800, 100));
+	addRegion(text, QSharedPointer<TextLine>::create(), Region::type_text_line, "l2", rect(110, 620, 700, 40));
+
+	QSharedPointer<PageElement> page(new PageElement());
+	page->setImageFileName("rdf-core-test.png");
+	page->setImageSize(QSize(1000, 800));
+	page->setRootRegion(root);
+
+	return page;
+}
+
+QString CoreTest::tempPath(const QString & fileName) const {
+	return QFileInfo(QDir::temp(), fileName).absoluteFilePath();
+}
+
+}
@@ -0,0 +1,72 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QSharedPointer>
+#pragma warning(pop)
+
+#include "TestUtils.h"
+
+ // Qt defines
+
+namespace rdf {
+
+// read defines
+class PageElement;
+
+/// <summary>
+/// Tests of the core library which run on
+/// synthetic data (no test resources needed).
+/// </summary>
+class CoreTest {
+
+public:
+	CoreTest(const TestConfig& config = TestConfig());
+
+	bool pageParser() const;
+	bool runLengthImage() const;
+	bool statMoment() const;
+	bool matBinary() const;
+	bool preFilterArea() const;
+	bool textBlockPixels() const;
+	bool fillPolygon() const;
+
+protected:
+	TestConfig mConfig;
+
+	QSharedPointer<PageElement> createPage() const;
+	QString tempPath(const QString& fileName) const;
+};
+
+}
@@ -0,0 +1,927 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#include "ModuleTest.h"
+
+#include "SuperPixelTrainer.h"		// tested
+#include "RandomTrees.h"			// tested
+#include "LineTrace.h"				// tested
+#include "LayoutAnalysis.h"			// tested
+#include "GraphCut.h"				// tested
+
+#include "PixelLabel.h"
+#include "PixelSet.h"
+#include "Pixel.h"
+#include "Elements.h"
+#include "Shapes.h"
+#include "Utils.h"
+
+#pragma warning(push, 0)	// no warnings from includes
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <qmath.h>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QPair>
+#include <QSet>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/ml.hpp>
+
+#include <algorithm>
+#pragma warning(pop)
+
+namespace rdf {
+
+ModuleTest::ModuleTest(const TestConfig & config) : mConfig(config) {
+}
+
+/// <summary>
+/// Round-trips features through the binary feature cache.
+/// Two managers are appended to the same cache, followed by
+/// an empty chunk. Reading the cache must merge the labels
+/// and keep the descriptors unchanged.
+/// </summary>
+/// <returns>true if all checks pass.</returns>
+bool ModuleTest::featureCache() const {
+
+	LabelInfo text(1, "text");
+	LabelInfo image(2, "image");
+	LabelInfo empty(3, "empty");
+
+	cv::RNG rng(42);
+	auto randomDesc = [&rng](int rows) {
+		cv::Mat desc(rows, 32, CV_8UC1);
+		rng.fill(desc, cv::RNG::UNIFORM, 0, 256);
+		return desc;
+	};
+
+	cv::Mat textA = randomDesc(5);
+	cv::Mat textB = randomDesc(4);
+	cv::Mat imageA = randomDesc(3);
+
+	FeatureCollectionManager fcmA;
+	fcmA.add(FeatureCollection(textA, text));
+	fcmA.add(FeatureCollection(imageA, image));
+	fcmA.add(FeatureCollection(cv::Mat(), empty));
+
+	FeatureCollectionManager fcmB;
+	fcmB.add(FeatureCollection(textB, text));
+
+	QString cachePath = tempPath("rdf-module-test-features.cache");
+	QFile::remove(cachePath);
+
+	if (!fcmA.appendToCache(cachePath) || !fcmB.appendToCache(cachePath)) {
+		qWarning() << "could not append features to" << cachePath;
+		return false;
+	}
+
+	// append an empty chunk (0 rows, 0 cols, type 0) as written by older caches
+	{
+		QJsonObject jo;
+		empty.toJson(jo);
+		QByteArray label = QJsonDocument(jo).toJson(QJsonDocument::Compact);
+		qint32 labelSize = label.size();
+		qint32 header[3] = { 0, 0, 0 };
+
+		QFile file(cachePath);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+			return false;
+
+		file.write("RDFC", 4);
+		file.write((const char*)&labelSize, sizeof(labelSize));
+		file.write(label);
+		file.write((const char*)header, sizeof(header));
+	}
+
+	if (!FeatureCollectionManager::isCache(cachePath)) {
+		qWarning() << cachePath << "is not recognized as feature cache";
+		return false;
+	}
+
+	FeatureCollectionManager fcm = FeatureCollectionManager::read(cachePath);
+
+	if (fcm.collection().size() != 2) {
+		qWarning() << "feature cache: expected 2 labels but got" << fcm.collection().size();
+		return false;
+	}
+
+	cv::Mat textAll;
+	cv::vconcat(textA, textB, textAll);
+
+	for (const FeatureCollection& fc : fcm.collection()) {
+
+		cv::Mat expected = fc.label() == text ? textAll : imageA;
+		cv::Mat desc = fc.descriptors();
+
+		if (desc.size() != expected.size() || desc.type() != expected.type() || cv::norm(desc, expected, cv::NORM_INF) != 0) {
+			qWarning() << "feature cache: wrong descriptors for" << fc.label().name();
+			return false;
+		}
+	}
+
+	// an illegal type must not be read
+	{
+		QFile file(cachePath);
+		if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+			return false;
+
+		QJsonObject jo;
+		text.toJson(jo);
+		QByteArray label = QJsonDocument(jo).toJson(QJsonDocument::Compact);
+		qint32 labelSize = label.size();
+		qint32 header[3] = { 1, 32, 0x7fffffff };
+
+		file.write("RDFC", 4);
+		file.write((const char*)&labelSize, sizeof(labelSize));
+		file.write(label);
+		file.write((const char*)header, sizeof(header));
+		file.write(QByteArray(32, 0));
+	}
+
+	if (!FeatureCollectionManager::readCache(cachePath).isEmpty()) {
+		qWarning() << "feature cache: a chunk with an illegal type was accepted";
+		return false;
+	}
+
+	QFile::remove(cachePath);
+
+	qInfo() << "feature cache test passed";
+
+	return true;
+}
+
+/// <summary>
+/// Compares LSD lines detected in strips with lines
+/// detected in the whole image. In addition, lines of
+/// several octaves must not be duplicated.
+/// </summary>
+/// <returns>true if all checks pass.</returns>
+bool ModuleTest::featureReservoir() const {
+
+	LabelInfo text(1, "text");
+	LabelInfo image(2, "image");
+	int capacity = 50;
+
+	// each row holds its source (0 = first, 1 = second reservoir) and a unique id
+	auto features = [](int rows, int source, int offset) {
+
+		cv::Mat desc(rows, 2, CV_32FC1);
+		for (int rIdx = 0; rIdx < rows; rIdx++) {
+			desc.at<float>(rIdx, 0) = (float)source;
+			desc.at<float>(rIdx, 1) = (float)(offset + rIdx);
+		}
+
+		return desc;
+	};
+
+	FeatureReservoir ra(capacity, 1);
+	FeatureReservoir rb(capacity, 2);
+
+	// the first page of each worker fills the reservoir, the others are sampled
+	ra.add(FeatureCollection(features(100, 0, 0), text));
+	ra.add(FeatureCollection(features(10, 0, 0), image));
+	rb.add(FeatureCollection(features(40, 1, 0), text));
+	rb.add(FeatureCollection(features(200, 1, 40), text));
+	rb.add(FeatureCollection(features(10, 1, 10), image));
+
+	if (rb.toManager().numFeatures() != capacity + 10) {
+		qWarning() << "feature reservoir: a single reservoir exceeds its capacity";
+		return false;
+	}
+
+	ra.merge(rb);
+	FeatureCollectionManager fcm = ra.toManager();
+
+	QMap<int, cv::Mat> descs;
+	for (const FeatureCollection& fc : fcm.collection())
+		descs.insert(fc.label().id(), fc.descriptors());
+
+	if (descs.size() != 2 || descs[text.id()].rows != capacity || descs[image.id()].rows != 20) {
+		qWarning() << "feature reservoir: wrong number of merged features" << fcm.toString();
+		return false;
+	}
+
+	// samples must be unique and drawn from both workers
+	for (const cv::Mat& desc : descs) {
+
+		QSet<QPair<int, int> > ids;
+		int numB = 0;
+
+		for (int rIdx = 0; rIdx < desc.rows; rIdx++) {
+			ids.insert(qMakePair(qRound(desc.at<float>(rIdx, 0)), qRound(desc.at<float>(rIdx, 1))));
+			numB += qRound(desc.at<float>(rIdx, 0));
+		}
+
+		if (ids.size() != desc.rows || numB == 0 || numB == desc.rows) {
+			qWarning() << "feature reservoir: merged samples are not drawn from both reservoirs";
+			return false;
+		}
+	}
+
+	qInfo() << "feature reservoir test passed";
+
+	return true;
+}
+
+bool ModuleTest::randomTrees() const {
+
+	// three well separated classes
+	QVector<LabelInfo> labels;
+	labels << LabelInfo(2, "text") << LabelInfo(3, "image") << LabelInfo(4, "separator");
+
+	cv::RNG rng(7);
+	FeatureCollectionManager fcm;
+
+	for (int lIdx = 0; lIdx < labels.size(); lIdx++) {
+
+		cv::Mat desc(200, 6, CV_32FC1);
+		rng.fill(desc, cv::RNG::NORMAL, 0.0, 0.1);
+
+		cv::Mat c = desc.col(lIdx);
+		c += 1.0;
+
+		fcm.add(FeatureCollection(desc, labels[lIdx]));
+	}
+
+	cv::Mat features = fcm.allFeatures();
+	cv::Mat gt = fcm.allLabels();
+
+	RandomTreesTrainer rtt(20);
+
+	if (!rtt.train(features, gt) || !rtt.isTrained()) {
+		qWarning() << "random trees: could not train the native forest";
+		return false;
+	}
+
+	cv::Ptr<cv::ml::RTrees> rt = rtt.toRTrees();
+
+	if (!rt || !rt->isTrained()) {
+		qWarning() << "random trees: could not convert the forest to cv::ml::RTrees";
+		return false;
+	}
+
+	// the converted forest must predict the training data
+	int numCorrect = 0;
+	for (int rIdx = 0; rIdx < features.rows; rIdx++) {
+		if (qRound(rt->predict(features.row(rIdx))) == gt.at<int>(rIdx))
+			numCorrect++;
+	}
+
+	if (numCorrect < 0.95 * features.rows) {
+		qWarning() << "random trees: only" << numCorrect << "/" << features.rows << "training samples predicted correctly";
+		return false;
+	}
+
+	// write & read the model
+	SuperPixelModel model(fcm.toLabelManager(), rt);
+	QString modelPath = tempPath("rdf-module-test-model.json");
+	QFile::remove(modelPath);
+
+	if (!model.write(modelPath)) {
+		qWarning() << "random trees: could not write the model to" << modelPath;
+		return false;
+	}
+
+	QSharedPointer<SuperPixelModel> loaded = SuperPixelModel::read(modelPath);
+
+	if (!loaded || loaded->isEmpty()) {
+		qWarning() << "random trees: could not read the model from" << modelPath;
+		return false;
+	}
+
+	QVector<PixelLabel> pl = model.classify(features);
+	QVector<PixelLabel> plLoaded = loaded->classify(features);
+
+	if (pl.size() != features.rows || plLoaded.size() != features.rows) {
+		qWarning() << "random trees: wrong number of predictions";
+		return false;
+	}
+
+	numCorrect = 0;
+	for (int rIdx = 0; rIdx < features.rows; rIdx++) {
+
+		if (pl[rIdx].predicted() != plLoaded[rIdx].predicted()) {
+			qWarning() << "random trees: the model changes when it is written";
+			return false;
+		}
+
+		if (plLoaded[rIdx].predicted().id() == gt.at<int>(rIdx))
+			numCorrect++;
+	}
+
+	if (numCorrect < 0.95 * features.rows) {
+		qWarning() << "random trees: only" << numCorrect << "/" << features.rows << "samples classified correctly after reading the model";
+		return false;
+	}
+
+	qInfo() << "random trees test passed";
+
+	return true;
+}
+
+bool ModuleTest::lineTraceLSD() const {
+
+	// synthetic separators - the vertical ones cross all strip seams
+	cv::Mat img(1024, 800, CV_8UC1, cv::Scalar(255));
+	for (int y : { 100, 300, 512, 700 })
+		cv::line(img, cv::Point(50, y), cv::Point(750, y), cv::Scalar(0), 3);
+	for (int x : { 200, 600 })
+		cv::line(img, cv::Point(x, 50), cv::Point(x, 980), cv::Scalar(0), 3);
+
+	auto detect = [&img](int stripHeight, int numOctaves, bool merge) {
+
+		LineTraceLSD lsd(img);
+		lsd.config()->setStripHeight(stripHeight);
+		lsd.config()->setNumOctaves(numOctaves);
+		lsd.config()->setMergeLines(merge);
+
+		if (!lsd.compute())
+			return QVector<Line>();
+
+		return lsd.lines();
+	};
+
+	// true if each line in src has a line with close end points in dst
+	auto matches = [](const QVector<Line>& src, const QVector<Line>& dst, double tol) {
+
+		for (const Line& l : src) {
+
+			bool found = false;
+			for (const Line& dl : dst) {
+
+				if (((l.p1() - dl.p1()).length() <= tol && (l.p2() - dl.p2()).length() <= tol) ||
+					((l.p1() - dl.p2()).length() <= tol && (l.p2() - dl.p1()).length() <= tol)) {
+					found = true;
+					break;
+				}
+			}
+
+			if (!found)
+				return false;
+		}
+
+		return true;
+	};
+
+	// -------------------------------------------------------------------- strips vs. whole image
+	QVector<Line> wholeLines = detect(0, 1, true);
+	QVector<Line> stripLines = detect(128, 1, true);
+
+	if (wholeLines.isEmpty()) {
+		qWarning() << "LSD: no lines detected";
+		return false;
+	}
+
+	if (!matches(wholeLines, stripLines, 8.0) || !matches(stripLines, wholeLines, 8.0)) {
+		qWarning() << "LSD:" << stripLines.size() << "lines detected in strips but" 
+			<< wholeLines.size() << "in the whole image";
+		return false;
+	}
+
+	// -------------------------------------------------------------------- octaves
+	QVector<Line> octaveLines = detect(0, 1, false);
+	QVector<Line> multiOctaveLines = detect(0, 2, false);
+
+	if (multiOctaveLines.size() > octaveLines.size() + octaveLines.size() / 4) {
+		qWarning() << "LSD:" << multiOctaveLines.size() << "lines detected with 2 octaves but"
+			<< octaveLines.size() << "with 1 octave - are duplicates removed?";
+		return false;
+	}
+
+	qInfo() << "LSD test passed";
+
+	return true;
+}
+
+/// <summary>
+/// Runs the layout analysis with two overlapping text blocks.
+/// Pixels in the overlap belong to both blocks, hence the
+/// blocks must not be processed concurrently.
+/// </summary>
+/// <returns>true if all checks pass.</returns>
+bool ModuleTest::overlappingTextBlocks() const {
+
+	// -------------------------------------------------------------------- shared pixels
+	auto rect = [](double x, double y, double w, double h) {
+		return Polygon::fromRect(Rect(x, y, w, h));
+	};
+
+	PixelSet ps;
+	for (double x : { 25.0, 75.0, 125.0 })
+		ps.add(QSharedPointer<Pixel>::create(Ellipse(Vector2D(x, 50))));
+
+	TextBlockSet overlapping(QVector<Polygon>() << rect(0, 0, 100, 100) << rect(50, 0, 100, 100));
+	overlapping.setPixels(ps);
+
+	TextBlockSet disjoint(QVector<Polygon>() << rect(0, 0, 100, 100) << rect(100, 0, 100, 100));
+	disjoint.setPixels(ps);
+
+	if (!overlapping.sharesPixels() || disjoint.sharesPixels()) {
+		qWarning() << "text blocks: shared pixels are not detected";
+		return false;
+	}
+
+	for (auto tb : overlapping.textBlocks()) {
+		if (tb->pixelSet().size() != 2) {
+			qWarning() << "text blocks:" << tb->pixelSet().size() << "pixels assigned to" << tb->toString() << "expected 2";
+			return false;
+		}
+	}
+
+	// -------------------------------------------------------------------- layout analysis
+	cv::Mat img(1600, 1200, CV_8UC3, cv::Scalar(255, 255, 255));
+	for (int y = 200; y < 1400; y += 60)
+		cv::putText(img, "The quick brown fox jumps over the lazy dog", cv::Point(100, y), 
+			cv::FONT_HERSHEY_SIMPLEX, 1.2, cv::Scalar(0, 0, 0), 2);
+
+	QSharedPointer<RootRegion> root(new RootRegion());
+	for (const Rect& r : { Rect(50, 100, 1100, 900), Rect(50, 700, 1100, 800) }) {
+		QSharedPointer<TextRegion> tr(new TextRegion());
+		tr->setType(Region::type_text_region);
+		tr->setPolygon(Polygon::fromRect(r));
+		root->addChild(tr);
+	}
+
+	LayoutAnalysis la(img);
+	la.setRootRegion(root);
+	la.config()->setLocalBlockOrientation(true);	// local stats write the (shared) pixels
+	la.config()->setMaxThreads(0);
+
+	if (!la.compute()) {
+		qWarning() << "could not compute the layout of overlapping text blocks";
+		return false;
+	}
+
+	auto tbs = la.textBlockSet();
+	if (tbs.textBlocks().size() != 2 || !tbs.sharesPixels()) {
+		qWarning() << "layout analysis: expected two overlapping text blocks";
+		return false;
+	}
+
+	qInfo() << "overlapping text blocks test passed";
+
+	return true;
+}
+
+/// <summary>
+/// Compares the sparse (candidate) text line graph-cut
+/// with the dense graph-cut on synthetic text lines.
+/// </summary>
+/// <returns>true if all checks pass.</returns>
+bool ModuleTest::graphCutTextLine() const {
+
+	cv::RNG rng(42);
+
+	// six horizontal text lines
+	QVector<PixelSet> lines;
+	for (int lIdx = 0; lIdx < 6; lIdx++) {
+
+		PixelSet ps;
+		for (int pIdx = 0; pIdx < 30; pIdx++) {
+			Vector2D c(20 + 15 * pIdx, 80 * (lIdx + 1) + rng.uniform(-3.0, 3.0));
+			ps.add(QSharedPointer<Pixel>::create(Ellipse(c, Vector2D(5, 5))));
+		}
+
+		lines << ps;
+	}
+
+	// maps each pixel to its text line after the graph-cut
+	auto cut = [&lines](int numCandidates, QHash<QString, int>& assignment) {
+
+		GraphCutTextLine gc(lines);
+		gc.config()->setNumCandidates(numCandidates);
+
+		if (!gc.compute())
+			return false;
+
+		QVector<PixelSet> tls = gc.textLines();
+		for (int tIdx = 0; tIdx < tls.size(); tIdx++) {
+			for (auto px : tls[tIdx].pixels())
+				assignment.insert(px->id(), tIdx);
+		}
+
+		return true;
+	};
+
+	QHash<QString, int> dense, sparse;
+
+	if (GraphCutTextLineConfig().numCandidates() != 0) {
+		qWarning() << "graph-cut: the dense graph-cut should be the default";
+		return false;
+	}
+
+	if (!cut(0, dense) || !cut(3, sparse)) {
+		qWarning() << "could not compute the text line graph-cut";
+		return false;
+	}
+
+	// both must recover the text lines
+	for (const PixelSet& tl : lines) {
+
+		auto px = tl.pixels();
+		for (auto p : px) {
+
+			if (!dense.contains(p->id()) || !sparse.contains(p->id()) ||
+				dense[p->id()] != dense[px[0]->id()] || sparse[p->id()] != sparse[px[0]->id()]) {
+				qWarning() << "graph-cut: a text line is split (dense vs. sparse)";
+				return false;
+			}
+		}
+	}
+
+	qInfo() << "text line graph-cut test passed";
+
+	return true;
+}
+
+bool ModuleTest::deepCut() const {
+
+	// a page larger than one tile with noisy probability maps of 3 labels
+	cv::Size size(1300, 1100);
+	int numLabels = 3;
+
+	cv::Mat gt(size, CV_8UC1);
+	for (int rIdx = 0; rIdx < gt.rows; rIdx++) {
+
+		unsigned char* gPtr = gt.ptr<unsigned char>(rIdx);
+
+		for (int cIdx = 0; cIdx < gt.cols; cIdx++)
+			gPtr[cIdx] = (unsigned char)((cIdx / 300 + rIdx / 400) % numLabels);
+	}
+
+	cv::RNG rng(42);
+	QVector<cv::Mat> probs;
+
+	for (int lIdx = 0; lIdx < numLabels; lIdx++) {
+
+		cv::Mat p(size, CV_32FC1, cv::Scalar(0.2f));
+		p.setTo(cv::Scalar(0.6f), gt == lIdx);
+
+		cv::Mat noise(size, CV_32FC1);
+		rng.fill(noise, cv::RNG::UNIFORM, -0.2f, 0.2f);
+		probs << p + noise;
+	}
+
+	auto cut = [&probs](int tileSize) -> cv::Mat {
+
+		DeepCut dc(probs);
+		dc.config()->setTileSize(tileSize);
+
+		if (!dc.compute())
+			return cv::Mat();
+
+		return dc.image();
+	};
+
+	cv::Mat full = cut(0);
+	cv::Mat tiled = cut(512);
+
+	if (full.empty() || tiled.empty()) {
+		qWarning() << "could not compute the deep cut (tiled or untiled)";
+		return false;
+	}
+
+	if (tiled.size() != size) {
+		qWarning() << "deep cut: tiled label image has a wrong size";
+		return false;
+	}
+
+	double numPx = size.area();
+	double fullErr = cv::countNonZero(full != gt) / numPx;
+	double tiledErr = cv::countNonZero(tiled != gt) / numPx;
+	double diff = cv::countNonZero(full != tiled) / numPx;
+
+	if (fullErr > 0.01 || tiledErr > 0.01 || diff > 0.01) {
+		qWarning() << "deep cut: tiled and untiled results differ - errors:" << fullErr << tiledErr << "diff:" << diff;
+		return false;
+	}
+
+	qInfo() << "deep cut test passed";
+
+	return true;
+}
+
+/// <summary>
+/// Tests the grid based LineFilter::mergeLines against
+/// a brute-force implementation on random line sets.
+/// </summary>
+/// <returns>true if all checks pass.</returns>
+bool ModuleTest::lineFilter() const {
+
+	cv::RNG rng(42);
+	double maxGap = 25;
+	double maxAngleDiff = 5.0 * DK_DEG2RAD;
+
+	for (int iter = 0; iter < 20; iter++) {
+
+		// broken (slightly tilted) separators and some clutter
+		QVector<Line> lines;
+		for (int sIdx = 0; sIdx < 15; sIdx++) {
+
+			double y = rng.uniform(0.0, 1000.0);
+			double slope = rng.uniform(-0.03, 0.03);
+
+			for (double x = rng.uniform(0.0, 50.0); x < 1000; ) {
+
+				double len = rng.uniform(5.0, 120.0);
+				double dy = rng.uniform(-1.5, 1.5);
+				lines << Line(x, y + slope * x + dy, x + len, y + slope * (x + len) + dy);
+				x += len + rng.uniform(-10.0, 40.0);	// gap (or overlap)
+			}
+		}
+
+		for (int idx = 0; idx < 50; idx++) {
+			double x = rng.uniform(0.0, 1000.0);
+			double y = rng.uniform(0.0, 1000.0);
+			lines << Line(x, y, x + rng.uniform(-30.0, 30.0), y + rng.uniform(-30.0, 30.0));
+		}
+
+		for (int idx = lines.size() - 1; idx > 0; idx--)
+			std::swap(lines[idx], lines[rng.uniform(0, idx + 1)]);
+
+		LineFilter lf;
+		QVector<Line> gaps, gapsRef;
+		QVector<Line> merged = lf.mergeLines(lines, &gaps, maxGap, maxAngleDiff);
+		QVector<Line> mergedRef = mergeLinesBruteForce(lines, &gapsRef, maxGap, maxAngleDiff);
+
+		auto isEqual = [](const QVector<Line>& l1, const QVector<Line>& l2) {
+
+			if (l1.size() != l2.size())
+				return false;
+
+			for (int idx = 0; idx < l1.size(); idx++) {
+				if (l1[idx].qLine() != l2[idx].qLine())
+					return false;
+			}
+
+			return true;
+		};
+
+		if (!isEqual(merged, mergedRef) || !isEqual(gaps, gapsRef)) {
+			qWarning() << "line filter: merged lines differ from the brute-force merge -" << 
+				merged.size() << "vs" << mergedRef.size() << "lines";
+			return false;
+		}
+	}
+
+	qInfo() << "line filter test passed";
+
+	return true;
+}
+
+/// <summary>
+/// The previous O(n^2) LineFilter::mergeLines (reference).
+/// Unlike the original, it does not skip the line after
+/// a line that was merged into the last line.
+/// </summary>
+QVector<Line> ModuleTest::mergeLinesBruteForce(const QVector<Line>& lines, QVector<Line>* gaps, double maxGap, double maxAngleDiff) const {
+
+	QVector<Line> cLines = lines;
+
+	for (int lineIdx = 0; lineIdx < cLines.size(); ) {
+
+		Line cLine = cLines[lineIdx];
+		bool merged = false;
+
+		for (int lineCmpIdx = lineIdx + 1; lineCmpIdx < cLines.size(); lineCmpIdx++) {
+
+			Line cmpLine = cLines[lineCmpIdx];
+			double dist = cLine.minDistance(cmpLine);
+
+			if (dist > maxGap)
+				continue;
+
+			if (cLine.diffAngle(cmpLine) > maxAngleDiff)
+				continue;
+
+			Line newLine = cLine.merge(cmpLine);
+			double angle = qMax(newLine.diffAngle(cLine), newLine.diffAngle(cmpLine));
+
+			double weight = 1.0f - (dist / maxGap);
+			if (angle > (weight * maxAngleDiff))
+				continue;
+
+			Line gapLine = cLine.gapLine(cmpLine);
+			angle = qMax(gapLine.diffAngle(cLine), gapLine.diffAngle(cmpLine));
+
+			weight = 1.0f - (dist / maxGap)*(dist / maxGap);
+			if (dist > 5 && angle > weight * qDegreesToRadians(20.0))
+				continue;
+
+			if (gaps)
+				gaps->append(gapLine);
+
+			cLines[lineCmpIdx] = newLine;
+			cLines.remove(lineIdx);
+			merged = true;
+			break;
+		}
+
+		if (!merged)
+			lineIdx++;
+	}
+
+	// remove small lines 'within' large lines
+	QVector<bool> erase(cLines.size(), false);
+
+	for (int lineIdx = 0; lineIdx < cLines.size(); lineIdx++) {
+
+		const Line& cLine = cLines[lineIdx];
+
+		for (int lineCmpIdx = lineIdx + 1; lineCmpIdx < cLines.size(); lineCmpIdx++) {
+
+			const Line& cmpLine = cLines[lineCmpIdx];
+
+			if (cmpLine.distance(cLine.qLine().p1()) > 5 || cmpLine.distance(cLine.qLine().p2()) > 5)
+				continue;
+
+			if (cmpLine.within(cLine.qLine().p1()) && cmpLine.within(cLine.qLine().p2()))
+				erase[lineIdx] = true;
+			else if (cLine.within(cmpLine.qLine().p1()) && cLine.within(cmpLine.qLine().p2()))
+				erase[lineCmpIdx] = true;
+		}
+	}
+
+	QVector<Line> rLines;
+	for (int idx = 0; idx < cLines.size(); idx++) {
+		if (!erase[idx])
+			rLines << cLines[idx];
+	}
+
+	return rLines;
+}
+
+/// <summary>
+/// Runs two graph-cuts in sequence on one GraphCutContext.
+/// The second graph-cut must not allocate nodes or arcs and
+/// both must label the image as graph-cuts with their own context.
+/// </summary>
+/// <returns>true if all checks pass.</returns>
+bool ModuleTest::graphCutContext() const {
+
+	cv::Size size(240, 180);
+	int numLabels = 3;
+	cv::RNG rng(42);
+
+	// two noisy probability maps of the same size
+	auto probMaps = [&](int offset) {
+
+		QVector<cv::Mat> probs;
+		for (int lIdx = 0; lIdx < numLabels; lIdx++) {
+
+			cv::Mat p(size, CV_32FC1, cv::Scalar(0.2f));
+			p(cv::Rect(((lIdx + offset) % numLabels) * size.width / numLabels, 0, size.width / numLabels, size.height)).setTo(cv::Scalar(0.6f));
+
+			cv::Mat noise(size, CV_32FC1);
+			rng.fill(noise, cv::RNG::UNIFORM, -0.3f, 0.3f);
+			probs << p + noise;
+		}
+
+		return probs;
+	};
+
+	QVector<QVector<cv::Mat> > pages;
+	pages << probMaps(0) << probMaps(1);
+
+	auto cut = [](const QVector<cv::Mat>& probs, const QSharedPointer<GraphCutContext>& context) -> cv::Mat {
+
+		DeepCut dc(probs);
+		dc.config()->setTileSize(0);
+
+		if (context)
+			dc.setContext(context);
+
+		if (!dc.compute())
+			return cv::Mat();
+
+		return dc.image();
+	};
+
+	QSharedPointer<GraphCutContext> context = QSharedPointer<GraphCutContext>::create();
+	int numAllocs = 0;
+
+	for (int pIdx = 0; pIdx < pages.size(); pIdx++) {
+
+		cv::Mat shared = cut(pages[pIdx], context);
+		cv::Mat own = cut(pages[pIdx], QSharedPointer<GraphCutContext>());
+
+		if (shared.empty() || own.empty()) {
+			qWarning() << "could not compute the graph-cut of page" << pIdx;
+			return false;
+		}
+
+		if (cv::countNonZero(shared != own) > 0) {
+			qWarning() << "graph-cut: the shared context changes the labels of page" << pIdx;
+			return false;
+		}
+
+		if (pIdx > 0 && context->numAllocations() > numAllocs) {
+			qWarning() << "graph-cut: the arena grew from" << numAllocs << "to" << context->numAllocations() << "allocations";
+			return false;
+		}
+
+		numAllocs = context->numAllocations();
+	}
+
+	if (context->numGraphCuts() != pages.size()) {
+		qWarning() << "graph-cut: the context was used by" << context->numGraphCuts() << "graph-cuts instead of" << pages.size();
+		return false;
+	}
+
+	qInfo() << "graph-cut context test passed";
+
+	return true;
+}
+
+/// <summary>
+/// Compares the parallel swap (disjoint label pairs) with the
+/// sequential swap. Both schedules must converge to a similar energy.
+/// </summary>
+/// <returns>true if all checks pass.</returns>
+bool ModuleTest::parallelSwap() const {
+
+	cv::RNG rng(42);
+
+	// eight close and noisy text lines
+	QVector<PixelSet> lines;
+	for (int lIdx = 0; lIdx < 8; lIdx++) {
+
+		PixelSet ps;
+		for (int pIdx = 0; pIdx < 40; pIdx++) {
+			Vector2D c(20 + 12 * pIdx, 35 * (lIdx + 1) + rng.uniform(-8.0, 8.0));
+			ps.add(QSharedPointer<Pixel>::create(Ellipse(c, Vector2D(5, 5))));
+		}
+
+		lines << ps;
+	}
+
+	auto energy = [&lines](bool parallel) {
+
+		GraphCutTextLine gc(lines);
+		gc.config()->setNumCandidates(0);
+		gc.config()->setParallelSwap(parallel);
+
+		if (!gc.compute())
+			return -1.0;
+
+		return gc.energy();
+	};
+
+	double sequential = energy(false);
+	double parallel = energy(true);
+
+	if (sequential < 0 || parallel < 0) {
+		qWarning() << "could not compute the text line graph-cut (parallel or sequential swap)";
+		return false;
+	}
+
+	if (parallel > sequential * 1.05) {
+		qWarning() << "graph-cut: parallel swap energy" << parallel << "exceeds the sequential energy" << sequential;
+		return false;
+	}
+
+	qInfo() << "parallel swap test passed";
+
+	return true;
+}
+
+QString ModuleTest::tempPath(const QString & fileName) const {
+	return QFileInfo(QDir::temp(), fileName).absoluteFilePath();
+}
+
+}
@@ -0,0 +1,76 @@
+/*******************************************************************************************************
+ ReadFramework is the basis for modules developed at CVL/TU Wien for the EU project READ. 
+  
+ Copyright (C) 2016 Markus Diem <diem@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Stefan Fiel <fiel@cvl.tuwien.ac.at>
+ Copyright (C) 2016 Florian Kleber <kleber@cvl.tuwien.ac.at>
+
+ This file is part of ReadFramework.
+
+ ReadFramework is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ ReadFramework is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+ The READ project  has  received  funding  from  the European  Union’s  Horizon  2020  
+ research  and innovation programme under grant agreement No 674943
+ 
+ related links:
+ [1] https://cvl.tuwien.ac.at/
+ [2] https://transkribus.eu/Transkribus/
+ [3] https://github.com/TUWien/
+ [4] https://nomacs.org
+ *******************************************************************************************************/
+
+#pragma once
+
+#pragma warning(push, 0)	// no warnings from includes
+// Qt Includes
+#include <QVector>
+#pragma warning(pop)
+
+#include "TestUtils.h"
+
+// Qt defines
+
+namespace rdf {
+
+// read defines
+class Line;
+
+/// <summary>
+/// Tests of the module library which run on
+/// synthetic data (no test resources needed).
+/// </summary>
+class ModuleTest {
+
+public:
+	ModuleTest(const TestConfig& config = TestConfig());
+
+	bool featureCache() const;
+	bool featureReservoir() const;
+	bool randomTrees() const;
+	bool lineTraceLSD() const;
+	bool overlappingTextBlocks() const;
+	bool graphCutTextLine() const;
+	bool deepCut() const;
+	bool lineFilter() const;
+	bool graphCutContext() const;
+	bool parallelSwap() const;
+
+protected:
+	TestConfig mConfig;
+
+	QString tempPath(const QString& fileName) const;
+	QVector<Line> mergeLinesBruteForce(const QVector<Line>& lines, QVector<Line>* gaps, double maxGap, double maxAngleDiff) const;
+};
+
+}
@@ -216,11 +216,24 @@ bool PreProcessingTest::nativeSkew(const cv::Mat & img, double & angle) const {
 	cf->setThr(0.1);
 	bse.setFixedThr(false);
 
+	int numCasts = rdf::Module::numConfigCasts();
+
 	if (!bse.compute()) {
 		qDebug() << "could not compute skew";
 		return false;
 	}
 
+	// the config must be resolved exactly once per run (configSnapshot) - not per pixel or line
+	// casts are only counted in debug builds
+	if (numCasts != -1) {
+
+		numCasts = rdf::Module::numConfigCasts() - numCasts;
+		if (numCasts != 1) {
+			qWarning() << "skew estimation resolved its config" << numCasts << "times instead of once - check for casts in hot loops";
+			return false;
+		}
+	}
+
 	angle = bse.getAngle();
 	angle = -angle / 180.0 * CV_PI;
 
@@ -44,6 +44,8 @@
 #include "LayoutTest.h"
 #include "PreProcessingTest.h"
 #include "TableTest.h"
+#include "CoreTest.h"
+#include "ModuleTest.h"
 
 #if defined(_MSC_BUILD) && !defined(QT_NO_DEBUG_OUTPUT) // fixes cmake bug - really release uses subsystem windows, debug and release subsystem console
 #pragma comment (linker, "/SUBSYSTEM:CONSOLE")
@@ -86,6 +88,14 @@ int main(int argc, char** argv) {
 	QCommandLineOption preProcessingOpt(QStringList() << "pre-processing", QObject::tr("Test Pre-Processing."));
 	parser.addOption(preProcessingOpt);
 
+	// core test
+	QCommandLineOption coreOpt(QStringList() << "core", QObject::tr("Test Core (synthetic data)."));
+	parser.addOption(coreOpt);
+
+	// module test
+	QCommandLineOption moduleOpt(QStringList() << "module", QObject::tr("Test Modules (synthetic data)."));
+	parser.addOption(moduleOpt);
+
 	parser.process(*QCoreApplication::instance());
 	// CMD parser --------------------------------------------------------------------
 
@@ -133,6 +143,65 @@ int main(int argc, char** argv) {
 			return 1;	// fail the test
 
 
+	} else if (parser.isSet(coreOpt)) {
+
+		rdf::CoreTest ct;
+
+		if (!ct.pageParser())
+			return 1;	// fail the test
+
+		if (!ct.runLengthImage())
+			return 1;	// fail the test
+
+		if (!ct.statMoment())
+			return 1;	// fail the test
+
+		if (!ct.matBinary())
+			return 1;	// fail the test
+
+		if (!ct.preFilterArea())
+			return 1;	// fail the test
+
+		if (!ct.textBlockPixels())
+			return 1;	// fail the test
+
+		if (!ct.fillPolygon())
+			return 1;	// fail the test
+
+	} else if (parser.isSet(moduleOpt)) {
+
+		rdf::ModuleTest mt;
+
+		if (!mt.featureCache())
+			return 1;	// fail the test
+
+		if (!mt.featureReservoir())
+			return 1;	// fail the test
+
+		if (!mt.randomTrees())
+			return 1;	// fail the test
+
+		if (!mt.lineTraceLSD())
+			return 1;	// fail the test
+
+		if (!mt.overlappingTextBlocks())
+			return 1;	// fail the test
+
+		if (!mt.graphCutTextLine())
+			return 1;	// fail the test
+
+		if (!mt.deepCut())
+			return 1;	// fail the test
+
+		if (!mt.lineFilter())
+			return 1;	// fail the test
+
+		if (!mt.graphCutContext())
+			return 1;	// fail the test
+
+		if (!mt.parallelSwap())
+			return 1;	// fail the test
+
 	} else if (parser.isSet(tableOpt)) {
 		//parser.showHelp();
 
@@ -112,9 +112,13 @@ int main(int argc, char** argv) {
 	parser.addOption(xmlTableOpt);
 
 	// pie db path
-	QCommandLineOption jsonOpt(QStringList() << "json", QObject::tr("Path to JSON file for PIE crawler"), "filepath");
+	QCommandLineOption jsonOpt(QStringList() << "json", QObject::tr("Path to JSON file for PIE crawler (*.jsonl streams JSON Lines)"), "filepath");
 	parser.addOption(jsonOpt);
 
+	// pie # threads
+	QCommandLineOption threadsOpt(QStringList() << "threads", QObject::tr("Number of threads for the PIE crawler (0 = all cores)"), "number");
+	parser.addOption(threadsOpt);
+
 	parser.process(*QCoreApplication::instance());
 	// CMD parser --------------------------------------------------------------------
 
@@ -207,6 +211,14 @@ int main(int argc, char** argv) {
 				jsonPath = parser.value(jsonOpt);
 			
 			rdf::PieData testDB(dc.imagePath(), jsonPath);
+
+			if (parser.isSet(threadsOpt))
+				testDB.setNumThreads(parser.value(threadsOpt).toInt());
+
+			// stream large databases as JSON Lines
+			if (jsonPath.endsWith(".jsonl", Qt::CaseInsensitive))
+				testDB.setJsonLines(true);
+
 			testDB.saveJsonDatabase();
 		}
 		else if (parser.isSet(modeOpt) && parser.value(modeOpt) == "separators") {
@@ -229,6 +241,13 @@ int main(int argc, char** argv) {
 			rdf::LayoutTest lt(dc);
 			lt.layoutToXml();
 		}
+		// collects GT features and trains the super pixel classifier
+		else if (parser.isSet(modeOpt) && parser.value(modeOpt) == "train") {
+			qDebug() << "Starting training ...";
+
+			rdf::LayoutTest lt(dc);
+			lt.train();
+		}
 		// thomas
 		else if (parser.isSet(modeOpt) && parser.value(modeOpt) == "apa") {
 			qDebug() << "Starting newspaper analysis ...";